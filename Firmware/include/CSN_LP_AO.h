@@ -17,16 +17,67 @@
 
 #include "ics/CS.h"
 #include <stdbool.h>
+#include <stimer.h>
 
 #include "RTE_app_config.h"
 
-// Number of samples per second for enabled sensors
+// Initial number of samples per second for enabled sensors
 #define CSN_LP_AO_SAMPLE_RATE          RTE_APP_ICS_AO_REPORT_RATE
 
+// Maximum sample rate of single virtual sensor in Hz
+#define CSN_LP_AO_MAX_SAMPLE_RATE      200
+
+// Maximum sum of sample rates of all virtual sensors in Hz
+#define CSN_LP_AO_MAX_TOTAL_RATE       RTE_APP_ICS_AO_MAX_TOTAL_RATE
+
+// Time in ms BHI160 can batch samples before interrupting RSL10
+#define CSN_LP_AO_REPORT_LATENCY       RTE_APP_ICS_AO_REPORT_LATENCY
+
+// BHI160 FIFO fill level in bytes that interrupts RSL10 (0 = disabled)
+#define CSN_LP_AO_FIFO_WATERMARK       RTE_APP_ICS_AO_FIFO_WATERMARK
+
+// Number of samples kept for each virtual sensor
+#define CSN_LP_AO_HISTORY_SIZE         RTE_APP_ICS_AO_HISTORY_SIZE
+
+// Maximum number of history samples sent for single request
+#define CSN_LP_AO_HISTORY_MAX_READ     16
+
+// Time in s after which unread virtual sensor is disabled (0 = disabled)
+#define CSN_LP_AO_IDLE_TIMEOUT         RTE_APP_ICS_AO_IDLE_TIMEOUT
+
+// Initial source of orientation (0 = BHI160 fusion, 1 = software fusion)
+#define CSN_LP_AO_FUSION               RTE_APP_ICS_AO_FUSION
+
+// Sample rate of accelerometer used for event capture in Hz
+#define CSN_LP_AO_CAPTURE_RATE         RTE_APP_ICS_AO_CAPTURE_RATE
+
+// Time in ms BHI160 can batch event capture samples
+#define CSN_LP_AO_CAPTURE_LATENCY      RTE_APP_ICS_AO_CAPTURE_LATENCY
+
+// Number of samples of event capture window
+#define CSN_LP_AO_CAPTURE_SIZE         RTE_APP_ICS_AO_CAPTURE_SIZE
+
+// Number of window samples recorded before the event
+#define CSN_LP_AO_CAPTURE_PRE_TRIGGER  RTE_APP_ICS_AO_CAPTURE_PRE_TRIGGER
+
+// Acceleration magnitude in mg that triggers impact event
+#define CSN_LP_AO_IMPACT_THRESHOLD     RTE_APP_ICS_AO_IMPACT_THRESHOLD
+
+// Acceleration magnitude in mg below which the device is in free fall
+#define CSN_LP_AO_FREE_FALL_THRESHOLD  RTE_APP_ICS_AO_FREE_FALL_THRESHOLD
+
+// Duration of free fall in ms that triggers free fall event
+#define CSN_LP_AO_FREE_FALL_TIME       RTE_APP_ICS_AO_FREE_FALL_TIME
+
 //-----------------------------------------------------------------------------
 // EXPORTED FUNCTION DECLARATIONS
 //-----------------------------------------------------------------------------
 
-extern struct CS_Node_Struct* CSN_LP_AO_Create(void);
+/**
+ *
+ * \param ctx
+ * Timer context required for idle sensor timer.
+ */
+extern struct CS_Node_Struct* CSN_LP_AO_Create(struct stimer_ctx* ctx);
 
 #endif /* ICS_NODE_LP_AO_H_ */
@@ -0,0 +1,51 @@
+// ----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+// ----------------------------------------------------------------------------
+
+#ifndef ICS_NODE_LP_VB_H_
+#define ICS_NODE_LP_VB_H_
+
+#include "ics/CS.h"
+#include <stdbool.h>
+
+#include "RTE_app_config.h"
+
+// Sample rate of linear acceleration in Hz
+#define CSN_LP_VB_SAMPLE_RATE          RTE_APP_ICS_VB_SAMPLE_RATE
+
+// Time in ms BHI160 can batch samples before interrupting RSL10
+#define CSN_LP_VB_REPORT_LATENCY       RTE_APP_ICS_VB_REPORT_LATENCY
+
+// Number of samples analyzed by single FFT
+#define CSN_LP_VB_FFT_SIZE             RTE_APP_ICS_VB_FFT_SIZE
+
+// Number of frequency bands with reported RMS
+#define CSN_LP_VB_BAND_CNT             RTE_APP_ICS_VB_BAND_CNT
+
+// Number of reported spectrum peaks
+#define CSN_LP_VB_PEAK_CNT             3
+
+//-----------------------------------------------------------------------------
+// EXPORTED FUNCTION DECLARATIONS
+//-----------------------------------------------------------------------------
+
+/** \brief Creates vibration analysis node.
+ *
+ * Initializes BHI160 if it was not initialized yet.
+ *
+ * \returns
+ * Node structure to be registered with CS_RegisterNode or NULL on error.
+ */
+extern struct CS_Node_Struct* CSN_LP_VB_Create(void);
+
+#endif /* ICS_NODE_LP_VB_H_ */
@@ -36,6 +36,9 @@ extern "C"
 #define HAL_RTC_US_TO_TICKS(us)        (us * HAL_RTC_XTAL_FREQ / 1000000U)
 #define HAL_RTC_NS_TO_TICKS(ns)        (ns / (1000000000U / HAL_RTC_XTAL_FREQ))
 
+#define HAL_RTC_TICKS_TO_MS(ticks)     ((uint64_t)(ticks) * 1000U / HAL_RTC_XTAL_FREQ)
+#define HAL_RTC_TICKS_TO_US(ticks)     ((uint64_t)(ticks) * 1000000U / HAL_RTC_XTAL_FREQ)
+
 /**
  *
  * 32K XTAL has to be running before initializing RTC.
@@ -51,6 +54,18 @@ extern void HAL_RTC_Initialize(void);
  */
 extern void HAL_RTC_Wakeup(void);
 
+/** \brief Returns number of RTC ticks elapsed since RTC initialization.
+ *
+ * The 64-bit value does not overflow during device lifetime. It is read
+ * without masking interrupts and can be called from any context except
+ * before \ref HAL_RTC_Wakeup after deep sleep.
+ */
+extern uint64_t HAL_RTC_GetTime64(void);
+
+/** \brief Returns lower 32 bits of \ref HAL_RTC_GetTime64.
+ *
+ * Overflows approx. every 36 hours. Suitable as stimer time source.
+ */
 extern uint32_t HAL_RTC_GetTime(void * hint);
 
 extern void HAL_RTC_SetAlarmS(uint32_t sec);
@@ -47,6 +47,14 @@
 #define RTE_APP_BTN_CHECK_TIMEOUT  1500
 #endif
 
+// <q> Motion Wake-up
+// <i> Restart advertising when BHI160 detects significant motion after advertising was stopped.
+// <i> BHI160 interrupt (PIN_INT_BHI160) has to be connected to one of DIO0 to DIO3 to wake up RSL10 from deep sleep.
+// <i> Default: Disabled
+#ifndef RTE_APP_MOTION_WAKE_ENABLED
+#define RTE_APP_MOTION_WAKE_ENABLED  0
+#endif
+
 // <o> I2C Bus Speed
 // <i> Default: Fast+
 // <0=> Standard
@@ -116,6 +124,22 @@
 #define RTE_APP_ICS_EV_IAQ_ENABLED  0
 #endif
 
+// <o> ADS7142 ALERT Interrupt Source <0-3>
+// <i> DIO interrupt configuration used for ALERT pin of ADS7142.
+// <i> Rising edge timestamps the alert and wakes up RSL10 from deep sleep.
+// <i> Default: 2
+#ifndef RTE_APP_ICS_EV_ALERT_INT_SRC
+#define RTE_APP_ICS_EV_ALERT_INT_SRC  2
+#endif
+
+// <o> ADS7142 READY Interrupt Source <0-3>
+// <i> DIO interrupt configuration used for BUSY/RDY pin of ADS7142.
+// <i> Falling edge wakes up RSL10 waiting for ADS7142 to finish an operation.
+// <i> Default: 1
+#ifndef RTE_APP_ICS_EV_READY_INT_SRC
+#define RTE_APP_ICS_EV_READY_INT_SRC  1
+#endif
+
 // </e>
 
 
@@ -128,10 +152,169 @@
 #endif
 
 // <o> Virtual Sensor Report Rate [Hz]
+// <i> Initial sample rate of each virtual sensor. Rates can be changed at
+// <i> runtime using FO, FG, FA, FM and FAR properties.
 #ifndef RTE_APP_ICS_AO_REPORT_RATE
 #define RTE_APP_ICS_AO_REPORT_RATE  5
 #endif
 
+// <o> Maximum Total Report Rate [Hz] <25-1000>
+// <i> Upper limit of the sum of sample rates of all virtual sensors.
+// <i> Rate changes above this limit are rejected so that BHI160 FIFO
+// <i> processing and I2C transfers keep up with produced samples.
+// <i> Default: 250
+#ifndef RTE_APP_ICS_AO_MAX_TOTAL_RATE
+#define RTE_APP_ICS_AO_MAX_TOTAL_RATE  250
+#endif
+
+// <o> Maximum Report Latency [ms] <0-65535>
+// <i> Time BHI160 can collect samples in its FIFO before it interrupts RSL10.
+// <i> Samples are then processed in batches with less RSL10 wake-ups.
+// <i> Default: 0 (interrupt on every sample)
+#ifndef RTE_APP_ICS_AO_REPORT_LATENCY
+#define RTE_APP_ICS_AO_REPORT_LATENCY  0
+#endif
+
+// <o> FIFO Watermark [bytes] <0-65535>
+// <i> BHI160 interrupts RSL10 when its FIFO reaches this fill level even if
+// <i> report latency did not elapse yet.
+// <i> Default: 0 (disabled)
+#ifndef RTE_APP_ICS_AO_FIFO_WATERMARK
+#define RTE_APP_ICS_AO_FIFO_WATERMARK  0
+#endif
+
+// <o> Sample History Size [samples] <2-256>
+// <i> Number of latest samples kept for each virtual sensor so that host can
+// <i> read all samples without polling at sample rate. Must be a power of two.
+// <i> Default: 32
+#ifndef RTE_APP_ICS_AO_HISTORY_SIZE
+#define RTE_APP_ICS_AO_HISTORY_SIZE  32
+#endif
+
+// <o> Idle Sensor Timeout [s] <0-3600>
+// <i> Virtual sensor is disabled when none of its properties was read for
+// <i> this time. BHI160 enters standby when all virtual sensors are disabled.
+// <i> Sensors are enabled again by the next property read.
+// <i> Default: 30 (0 = sensors stay enabled until disconnect)
+#ifndef RTE_APP_ICS_AO_IDLE_TIMEOUT
+#define RTE_APP_ICS_AO_IDLE_TIMEOUT  30
+#endif
+
+// <o> Orientation Fusion
+// <i> Source of orientation at startup. Can be changed at runtime using
+// <i> FU property.
+// <i> Software fusion computes orientation on RSL10 from accelerometer,
+// <i> gyroscope and magnetometer samples so that BHI160 fusion core does not
+// <i> have to run.
+// <0=> BHI160 fusion
+// <1=> RSL10 software fusion
+// <i> Default: 0
+#ifndef RTE_APP_ICS_AO_FUSION
+#define RTE_APP_ICS_AO_FUSION  0
+#endif
+
+// <h> Event Capture
+// <i> Accelerometer samples are kept in a ring buffer while capture is armed
+// <i> by EV property. Impact or free fall freezes the window around the event
+// <i> and notifies the host, which then downloads it using S/EV requests.
+
+// <o> Sample Rate [Hz] <1-200>
+// <i> Default: 100
+#ifndef RTE_APP_ICS_AO_CAPTURE_RATE
+#define RTE_APP_ICS_AO_CAPTURE_RATE  100
+#endif
+
+// <o> Maximum Report Latency [ms] <0-65535>
+// <i> Time BHI160 can collect samples in its FIFO before it interrupts RSL10.
+// <i> Default: 500
+#ifndef RTE_APP_ICS_AO_CAPTURE_LATENCY
+#define RTE_APP_ICS_AO_CAPTURE_LATENCY  500
+#endif
+
+// <o> Window Size [samples] <4-256>
+// <i> Number of samples of captured window. Must be a power of two.
+// <i> Default: 128
+#ifndef RTE_APP_ICS_AO_CAPTURE_SIZE
+#define RTE_APP_ICS_AO_CAPTURE_SIZE  128
+#endif
+
+// <o> Pre-trigger Samples [samples] <0-255>
+// <i> Number of window samples recorded before the event.
+// <i> Default: 32
+#ifndef RTE_APP_ICS_AO_CAPTURE_PRE_TRIGGER
+#define RTE_APP_ICS_AO_CAPTURE_PRE_TRIGGER  32
+#endif
+
+// <o> Impact Threshold [mg] <100-16000>
+// <i> Magnitude of acceleration that triggers impact event.
+// <i> Default: 3000
+#ifndef RTE_APP_ICS_AO_IMPACT_THRESHOLD
+#define RTE_APP_ICS_AO_IMPACT_THRESHOLD  3000
+#endif
+
+// <o> Free Fall Threshold [mg] <0-1000>
+// <i> Magnitude of acceleration below which the device is in free fall.
+// <i> Default: 300
+#ifndef RTE_APP_ICS_AO_FREE_FALL_THRESHOLD
+#define RTE_APP_ICS_AO_FREE_FALL_THRESHOLD  300
+#endif
+
+// <o> Free Fall Time [ms] <1-1000>
+// <i> Duration of free fall that triggers free fall event.
+// <i> Default: 100
+#ifndef RTE_APP_ICS_AO_FREE_FALL_TIME
+#define RTE_APP_ICS_AO_FREE_FALL_TIME  100
+#endif
+
+// </h>
+
+// </e>
+
+
+// <e> Vibration Analysis Node (VB)
+// <i> Provide vibration spectrum of linear acceleration measured by BHI160.
+// <i> Outputs: Dominant frequencies and amplitudes, RMS per frequency band, Crest factor
+// <i> Default: Disabled
+#ifndef RTE_APP_ICS_VB_ENABLED
+#define RTE_APP_ICS_VB_ENABLED  0
+#endif
+
+// <o> Sample Rate [Hz]
+// <i> Highest analyzed frequency is half of the sample rate.
+// <i> Default: 200 Hz
+// <25=> 25
+// <50=> 50
+// <100=> 100
+// <200=> 200
+#ifndef RTE_APP_ICS_VB_SAMPLE_RATE
+#define RTE_APP_ICS_VB_SAMPLE_RATE  200
+#endif
+
+// <o> Maximum Report Latency [ms] <0-65535>
+// <i> Time BHI160 can collect samples in its FIFO before it interrupts RSL10.
+// <i> Default: 500
+#ifndef RTE_APP_ICS_VB_REPORT_LATENCY
+#define RTE_APP_ICS_VB_REPORT_LATENCY  500
+#endif
+
+// <o> FFT Size [samples]
+// <i> Number of samples analyzed at once. Larger size gives finer frequency
+// <i> resolution at the cost of 12 bytes of RAM per sample.
+// <i> Default: 256
+// <256=> 256
+// <512=> 512
+#ifndef RTE_APP_ICS_VB_FFT_SIZE
+#define RTE_APP_ICS_VB_FFT_SIZE  256
+#endif
+
+// <o> Number of Frequency Bands <1-4>
+// <i> Spectrum up to half of the sample rate is split into bands of equal
+// <i> width and RMS acceleration is reported for each band.
+// <i> Default: 3
+#ifndef RTE_APP_ICS_VB_BAND_CNT
+#define RTE_APP_ICS_VB_BAND_CNT  3
+#endif
+
 // </e>
 
 // </h>
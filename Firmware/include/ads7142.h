@@ -7,7 +7,13 @@
 #define ADS7142_OK 				  0
 #define ADS7142_COMM_ERROR		  1
 
-#define PIN_READY				  3
+/* Number of ALERT timestamps that can wait for ads7142_alert_pop().
+ * Has to be power of two. */
+#define ADS7142_ALERT_QUEUE_SIZE  8
+
+/* Number of samples read from data buffer in Pre Alert Data Mode.
+ * Channels 0 and 1 alternate starting with channel 0. */
+#define ADS7142_PRE_ALERT_SAMPLES 24
 
 /* Default I2C address (when ADDR is connected to ground) */
 #define ADS7142_I2C_ADDR          0x18
@@ -82,6 +88,9 @@
 
 typedef int32_t ret_t;
 
+/* Called from main loop after ALERT pin signaled new alert. */
+typedef void (*ads7142_alert_cb_t)(void);
+
 ret_t ads7142_init();
 
 ret_t ads7142_read(uint32_t channels[]);
@@ -94,6 +103,26 @@ ret_t ads7142_autonomous_mode_configure();
 
 ret_t ads7142_autonomous_mode_start();
 
+/* Reads alert flags and pre-alert data buffer after an alert.
+ * Bit 0 of flags is channel 0, bit 1 is channel 1. */
+ret_t ads7142_read_flags(uint8_t *low_flags, uint8_t *high_flags,
+		uint16_t samples[ADS7142_PRE_ALERT_SAMPLES]);
+
+// ALERT and READY interrupts
+
+void ads7142_set_alert_callback(ads7142_alert_cb_t cb);
+
+/* Takes the oldest queued ALERT timestamp in RTC ticks.
+ * Returns false if no alert is waiting. */
+bool ads7142_alert_pop(uint64_t *time);
+
+/* Number of alerts lost because the queue was full. */
+uint32_t ads7142_alert_get_dropped();
+
+/* Restores ALERT and READY pads and interrupts after deep sleep.
+ * Has to be called before pad retention is disabled. */
+void ads7142_pad_restore();
+
 ret_t ads7142_check();
 
 int32_t ads7142_get_hal_error();
@@ -34,6 +34,8 @@ extern "C"
 #include "app_timer.h"
 #include "app_ble_hooks.h"
 #include "app_sleep.h"
+#include "app_led.h"
+#include "app_motion.h"
 
 /* Configure RF 48 MHz XTAL divided clock frequency in Hz
  * Options: 8, 12, 16, 24, 48 */
@@ -79,6 +81,16 @@ extern "C"
 
 #define APP_STATE_IND_LED_INTERVAL_MS  (50)
 
+/** Allowed delay of the application state timer so that it can share wake-ups
+ * with other timers. */
+#define APP_STATE_TIMER_SLACK_MS       (500)
+
+/** Application state machine has to process a state change. */
+#define APP_EVENT_STATE                (1U << 0)
+
+/** Motion was detected while advertising is stopped. */
+#define APP_EVENT_MOTION               (1U << 1)
+
 enum App_StateStruct
 {
     APP_STATE_INIT,
@@ -89,6 +101,25 @@ enum App_StateStruct
     APP_STATE_CONNECTED
 };
 
+/** \brief Cycle counts of main loop iterations.
+ *
+ * Only time spent processing is counted, sleep is excluded.
+ */
+struct App_LoopStats
+{
+    /** Number of main loop iterations. */
+    uint32_t loop_cnt;
+
+    /** CPU cycles spent in the last iteration. */
+    uint32_t last_cycles;
+
+    /** Highest number of CPU cycles spent in a single iteration. */
+    uint32_t max_cycles;
+
+    /** Total number of CPU cycles spent in all iterations. */
+    uint64_t total_cycles;
+};
+
 extern enum App_StateStruct app_state;
 
 extern struct sleep_mode_env_tag sleep_mode_env;
@@ -102,9 +133,16 @@ extern void BLE_Initialize(void);
 
 extern void App_Env_Initialize(void);
 
-void ledNotif(uint8_t cnt);
+/** \brief Requests processing of application events by the main loop.
+ *
+ * Can be called from interrupt context.
+ *
+ * \param event
+ * Bitmask of APP_EVENT_* values.
+ */
+extern void App_SetEvent(uint32_t event);
 
-void ledNotif2(uint8_t cnt, uint8_t period);
+extern const struct App_LoopStats * App_GetLoopStats(void);
 
 #ifdef __cplusplus
 }
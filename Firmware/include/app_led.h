@@ -0,0 +1,65 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+//-----------------------------------------------------------------------------
+//
+//-----------------------------------------------------------------------------
+#ifndef APP_LED_H_
+#define APP_LED_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stimer.h>
+
+/** Maximum number of blink patterns waiting to be played.
+ * Patterns queued while the queue is full are dropped.
+ */
+#define APP_LED_QUEUE_SIZE             (8)
+
+/** \brief Prepares LED notification player.
+ *
+ * Has to be called after the timer context is initialized.
+ * Patterns queued before this call are played once the player is polled.
+ */
+extern void LedNotif_Initialize(struct stimer_ctx *ctx);
+
+/** \brief Advances the pattern currently being played.
+ *
+ * Called from main loop. LED state changes are scheduled using the timer
+ * context so the device can sleep between them.
+ */
+extern void LedNotif_Poll(void);
+
+/** \brief Checks if any blink pattern is being played or waits in queue. */
+extern bool LedNotif_IsBusy(void);
+
+/** \brief Queues \p cnt blinks of LED_RED with 250 ms period. */
+extern void ledNotif(uint8_t cnt);
+
+/** \brief Queues \p cnt blinks of LED_RED.
+ *
+ * Each blink consists of \p period ms of LED off followed by \p period ms
+ * of LED on. Returns immediately, the first phase is started at once when
+ * no other pattern is being played.
+ */
+extern void ledNotif2(uint8_t cnt, uint8_t period);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_LED_H_ */
@@ -0,0 +1,57 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+//-----------------------------------------------------------------------------
+#ifndef APP_MOTION_H_
+#define APP_MOTION_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** \brief Starts watching for motion of the device.
+ *
+ * Initializes BHI160 if needed and enables its significant motion virtual
+ * sensor as wake-up sensor, so that BHI160 interrupt wakes up RSL10 from deep
+ * sleep when the device is moved. APP_EVENT_MOTION is set once motion is
+ * detected.
+ *
+ * \returns
+ * 0 on success, BHY library error code on failure.
+ */
+extern int32_t App_MotionWakeArm(void);
+
+/** \brief Stops watching for motion and returns BHI160 into standby unless
+ * other user needs it.
+ */
+extern void App_MotionWakeDisarm(void);
+
+/** \brief Checks if motion detection is active. */
+extern bool App_MotionWakeIsArmed(void);
+
+/** \brief Returns DIO wake-up configuration bits for BHI160 interrupt pad.
+ *
+ * \returns
+ * WAKEUP_DIOx_ENABLE and rising edge bits for PIN_INT_BHI160, 0 if the pad
+ * cannot wake up the device (only DIO0 to DIO3 can).
+ */
+extern uint32_t App_MotionWakeGetWakeupCfg(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* APP_MOTION_H_ */
@@ -39,6 +39,22 @@ extern "C"
  */
 #define APP_TIMER_KEEP_AWAKE_THRESH    (HAL_RTC_MS_TO_TICKS(1))
 
+/** \brief Deep sleep statistics collected by the application timer. */
+struct Timer_Stats
+{
+    /** Number of attempts to enter deep sleep. */
+    uint32_t sleep_cnt;
+
+    /** Number of deep sleeps with RTC alarm set to the next timer event. */
+    uint32_t alarm_cnt;
+
+    /** Number of wake-ups from deep sleep. */
+    uint32_t wakeup_cnt;
+
+    /** Total number of RTC ticks spent in deep sleep. */
+    uint64_t sleep_ticks;
+};
+
 extern struct stimer_ctx app_timer_ctx;
 
 
@@ -46,6 +62,14 @@ extern void Timer_Initialize(void);
 
 extern void Timer_Wakeup(void);
 
+/** \brief Updates sleep statistics after wake-up from deep sleep.
+ *
+ * Must be called after \ref Timer_Wakeup once interrupts are unmasked.
+ */
+extern void Timer_UpdateSleepStats(void);
+
+extern const struct Timer_Stats * Timer_GetStats(void);
+
 static inline struct stimer_ctx * Timer_GetContext(void)
 {
     return &app_timer_ctx;
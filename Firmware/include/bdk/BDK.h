@@ -79,6 +79,7 @@ __STATIC_INLINE void BDK_Initialize(void)
  * Equivalent to calling following functions:
  * \code
  *     BDK_TaskStart();
+ *     BDK_TaskRunQueued();
  *     Kernel_Schedule();
  *     Sys_Watchdog_Refresh();
  * \endcode
@@ -94,6 +95,7 @@ extern void BDK_Schedule(void);
  * Equivalent to calling following functions:
  * \code
  *     BDK_TaskStart();
+ *     BDK_TaskRunQueued();
  *     Kernel_Schedule();
  * \endcode
  */
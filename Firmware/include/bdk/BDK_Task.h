@@ -62,6 +62,23 @@ extern "C"
 
 typedef void (*BDK_TaskCallback) (void *arg);
 
+/** \brief Usage statistics of the deferred callback queue.
+ *
+ * \see BDK_TaskGetQueueStats
+ */
+struct BDK_TaskQueueStats
+{
+    /** Number of callbacks that were added to the queue. */
+    uint32_t queued_cnt;
+
+    /** Number of callbacks that did not fit into the queue and were sent as
+     * Event Kernel message instead. */
+    uint32_t overflow_cnt;
+
+    /** Highest number of callbacks waiting in the queue at the same time. */
+    uint32_t high_water;
+};
+
 enum BDK_MSG_IDX
 {
     BDK_DUMMY_MSG = TASK_FIRST_MSG(TASK_ID_APP),
@@ -119,7 +136,14 @@ extern void BDK_TaskStart(void);
  */
 extern ke_msg_id_t BDK_TaskAllocateMsgId(void);
 
-/** \brief Allows for an callback to be executed by Event Kernel.
+/** \brief Allows for an callback to be executed from main loop.
+ *
+ * Callbacks are stored in a statically allocated queue without masking
+ * interrupts or allocating memory, so this function is safe to call from any
+ * interrupt priority.
+ * Queued callbacks are executed in order by \ref BDK_TaskRunQueued.
+ * If the queue is full the callback is sent as Event Kernel message and is
+ * executed by Kernel_Schedule instead.
  *
  * <b>Example:</b><br>
  * This example waits for an interrupt to be generated by pressing BDK button.
@@ -135,6 +159,30 @@ extern ke_msg_id_t BDK_TaskAllocateMsgId(void);
  */
 extern void BDK_TaskSchedule(BDK_TaskCallback cb, void *arg);
 
+/** \brief Executes callbacks queued by \ref BDK_TaskSchedule.
+ *
+ * Has to be called from main loop only.
+ * Callbacks scheduled while this function runs are executed too, up to
+ * RTE_APP_TASK_QUEUE_SIZE callbacks per call.
+ */
+extern void BDK_TaskRunQueued(void);
+
+/** \brief Checks if any scheduled callbacks are waiting for execution.
+ *
+ * Application should not enter sleep mode while this returns false.
+ *
+ * \returns
+ * true if callback queue is empty.
+ */
+extern bool BDK_TaskIsQueueEmpty(void);
+
+/** \brief Returns usage statistics of the callback queue.
+ *
+ * \returns
+ * Pointer to statistics structure.
+ */
+extern const struct BDK_TaskQueueStats * BDK_TaskGetQueueStats(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -127,7 +127,8 @@ enum BHI160_NDOF_Sensor
     BHI160_NDOF_S_GRAVITY              = VS_TYPE_GRAVITY,
     BHI160_NDOF_S_LINEAR_ACCELERATION  = VS_TYPE_LINEAR_ACCELERATION,
     BHI160_NDOF_S_RATE_OF_ROTATION     = VS_TYPE_GYROSCOPE,
-    BHI160_NDOF_S_MAGNETIC_FIELD       = VS_TYPE_GEOMAGNETIC_FIELD
+    BHI160_NDOF_S_MAGNETIC_FIELD       = VS_TYPE_GEOMAGNETIC_FIELD,
+    BHI160_NDOF_S_ACCELEROMETER        = VS_TYPE_ACCELEROMETER
 };
 
 /** \brief Callback function called by BHy library when new data are available
@@ -149,18 +150,42 @@ enum BHI160_NDOF_Sensor
 typedef void (*BHI160_NDOF_SensorCallback)(bhy_data_generic_t *data,
         bhy_virtual_sensor_t sensor);
 
+/** \brief Counters of FIFO processing.
+ *
+ * \see BHI160_NDOF_GetFifoStats
+ */
+struct BHI160_NDOF_FifoStats
+{
+    /** Number of BHI160 interrupts. */
+    uint32_t irq_cnt;
+
+    /** Number of times the BHI160 FIFO was drained. */
+    uint32_t drain_cnt;
+
+    /** Number of bytes read from BHI160 FIFO. */
+    uint32_t byte_cnt;
+};
+
 /** \brief Initializes the sensor hub.
  *
  * The following initialization steps are performed:
  * 1. Software reset of BHI160.
  * 2. RAM patch for BMM150 magnetometer support is uploaded into BHI160.
  * 3. Sensor axes are remapped to correspond to HB-GEVB sensor placement.
- * 4. Timestamp callback is installed to update local timestamp on each change.
+ * 4. Timestamp callbacks are installed to update local timestamps of
+ *    non-wakeup and wakeup FIFO on each change.
  * 5. Sensor Dynamic range callback is installed to update locally stored sensor
  *    ranges.
+ *    EventCallback handlers registered for RTE_HB_BHI160_NDOF_RANGE_EVENT_ID
+ *    are executed after the ranges are updated.
  * 6. Interrupt is enabled for BHI160 IRQ signal.
  *    FIFO processing routine will be scheduled on every rising edge of BHI160
  *    IRQ signal.
+ *    The routine reads and parses FIFO data until the BHI160 FIFO is empty
+ *    and then executes EventCallback handlers registered for
+ *    RTE_HB_BHI160_NDOF_FIFO_EVENT_ID.
+ * 7. BHI160 is put into BHI160_NDOF_PM_STANDBY power mode until a user calls
+ *    \ref BHI160_NDOF_AcquireNormalMode.
  *
  * \note
  * The speed of I2C transactions is not managed in this library.
@@ -168,6 +193,9 @@ typedef void (*BHI160_NDOF_SensorCallback)(bhy_data_generic_t *data,
  * Slow I2C speeds may result in limited throughput of sensor data and longer
  * initialization time since RAM patch needs to be loaded into BHI160.
  *
+ * Calls after successful initialization return BHY_SUCCESS without any
+ * action so that multiple users of BHI160 can initialize it.
+ *
  * \returns
  * \b BHY_SUCCESS - When sensor was successfully initialized.<br>
  * BHY library error code on failure.
@@ -177,6 +205,8 @@ extern int32_t BHI160_NDOF_Initialize(void);
 /** \brief Restores DIO pad configuration after waking up from deep sleep mode.
  *
  * Needs to be called before PAD retention is disabled.
+ * Schedules FIFO read-out if BHI160 interrupt is already active, as is the
+ * case when it was the wake-up source.
  */
 extern void BHI160_NDOF_PadRestore(void);
 
@@ -186,11 +216,23 @@ extern void BHI160_NDOF_PadRestore(void);
  * When called from sensor callback it will report timestamp of the measurement
  * that is being processed.
  *
+ * Only timestamps of non-wakeup FIFO are reported.
+ *
  * \returns
  * 32-bit BHI160 timestamp.
+ *
+ * \see BHI160_NDOF_GetWakeupTimestamp
  */
 extern uint32_t BHI160_NDOF_GetTimestamp(void);
 
+/** \brief Same as \ref BHI160_NDOF_GetTimestamp for virtual sensors enabled
+ * as VS_WAKEUP.
+ *
+ * \returns
+ * 32-bit BHI160 timestamp of wakeup FIFO.
+ */
+extern uint32_t BHI160_NDOF_GetWakeupTimestamp(void);
+
 /** \brief Returns latest reported timestamp converted to seconds.
  *
  * \returns
@@ -214,6 +256,30 @@ static inline float BHI160_NDOF_GetTimestampSeconds(void)
  */
 extern int32_t BHI160_NDOF_SetPowerMode(enum BHI160_NDOF_PowerMode power_mode);
 
+/** \brief Requests BHI160_NDOF_PM_NORMAL power mode on behalf of one user.
+ *
+ * Allows multiple users of BHI160 to control its power mode independently.
+ * BHI160 is switched to normal mode by the first request.
+ * Each successful call has to be matched by
+ * \ref BHI160_NDOF_ReleaseNormalMode.
+ *
+ * \returns
+ * \b BHY_SUCCESS - On success.<br>
+ * BHY library error code on failure.
+ */
+extern int32_t BHI160_NDOF_AcquireNormalMode(void);
+
+/** \brief Releases request made by \ref BHI160_NDOF_AcquireNormalMode.
+ *
+ * BHI160 is switched to BHI160_NDOF_PM_STANDBY power mode when the last
+ * request is released.
+ *
+ * \returns
+ * \b BHY_SUCCESS - On success.<br>
+ * BHY library error code on failure.
+ */
+extern int32_t BHI160_NDOF_ReleaseNormalMode(void);
+
 /** \brief Enables the output of desired virtual sensor.
  *
  * For more detailed configuration it is possible to use the
@@ -318,6 +384,28 @@ extern uint16_t BHI160_NDOF_GetGyroDynamicRange(void);
  */
 extern uint16_t BHI160_NDOF_GetMagDynamicRange(void);
 
+/** \brief Sets number of bytes in BHI160 wake-up FIFO that trigger host
+ * interrupt.
+ *
+ * Together with max_report_latency of enabled virtual sensors it allows BHI160
+ * to collect multiple samples before interrupting the host.
+ *
+ * \param watermark
+ * FIFO fill level in bytes. Zero disables the watermark interrupt.
+ *
+ * \returns
+ * \b BHY_SUCCESS - On success.<br>
+ * BHY library error code on failure.
+ */
+extern int32_t BHI160_NDOF_SetFifoWatermark(uint16_t watermark);
+
+/** \brief Returns FIFO processing counters.
+ *
+ * \returns
+ * Pointer to statistics structure.
+ */
+extern const struct BHI160_NDOF_FifoStats * BHI160_NDOF_GetFifoStats(void);
+
 
 #ifdef __cplusplus
 }
@@ -23,12 +23,20 @@
 //! This simple library allows to attach multiple callback functions to single
 //! or multiple event sources.
 //!
-//! The event callbacks are stored in a linked list in the same order they were
-//! registered.
+//! The event callbacks are grouped by event ID in a hash table and each group
+//! is stored in a linked list in the same order they were registered.
+//! Registering, removing and looking up callbacks of an event ID does not
+//! depend on number of callbacks registered for other event IDs.
 //! Each event callback contains information about event ID it belongs to, the
 //! callback itself and an optional parameter to pass to the callback.
 //!
 //! Event ID can be arbitrary 16-bit unsigned number.
+//! Up to RTE_APP_EVENT_CALLBACK_ID_COUNT distinct event IDs can be used.
+//!
+//! Number of calls and CPU cycles spent in callbacks of each event ID can be
+//! obtained by \ref EventCallback_GetStats.
+//! Cycles are measured by DWT cycle counter which has to be enabled by
+//! application, otherwise only number of calls is counted.
 //!
 //! Example how to set up event callback (listener):
 //! \code
@@ -54,6 +62,17 @@
 
 #include <HAL.h>
 
+/* Load RTE configuration before anything else.
+ * This header file has to be found in the global search path.
+ */
+#ifdef _RTE_
+#include "RTE_BDK.h"
+#endif
+
+#ifndef RTE_APP_EVENT_CALLBACK_ID_COUNT
+#define RTE_APP_EVENT_CALLBACK_ID_COUNT  16
+#endif
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -74,9 +93,14 @@ struct _EventCallback_Struct
      */
     EventCallback_Prototype callback;
 
-    /** \brief Pointer to next registered event callback handler. */
+    /** \brief Pointer to next registered event callback handler with the
+     * same event id. */
     struct _EventCallback_Struct *next;
 
+    /** \brief Pointer to previous registered event callback handler with the
+     * same event id. */
+    struct _EventCallback_Struct *prev;
+
     /** \brief Optional application specific argument that will be passed to
      * event callback function.
      */
@@ -93,6 +117,26 @@ struct _EventCallback_Struct
 
 typedef struct _EventCallback_Struct EventCallback_Type;
 
+/** \brief Profiling information of single event id.
+ *
+ * \see EventCallback_GetStats
+ */
+struct EventCallback_Stats
+{
+    /** \brief Number of calls of \ref EventCallback_Call with this event id.
+     */
+    uint32_t call_cnt;
+
+    /** \brief Number of currently registered callbacks. */
+    uint32_t handler_cnt;
+
+    /** \brief Highest number of CPU cycles spent in single call. */
+    uint32_t max_cycles;
+
+    /** \brief Total number of CPU cycles spent in all calls. */
+    uint64_t total_cycles;
+};
+
 /** \brief Initializes callback structure for use.
  *
  * \param handle
@@ -112,11 +156,14 @@ typedef struct _EventCallback_Struct EventCallback_Type;
 extern void EventCallback_Init(EventCallback_Type *handle, uint16_t event_id,
         EventCallback_Prototype callback, void *arg);
 
-/** \brief Inserts given event handle to the end of linked list composed of all
- * registered event handles.
+/** \brief Inserts given event handle to the end of linked list composed of
+ * registered event handles with the same event id.
  *
  * Caller is responsible for memory management of given event handle and
  * ensures that it wont be deallocated while handle is registered.
+ *
+ * Handle is not registered if RTE_APP_EVENT_CALLBACK_ID_COUNT event ids are
+ * already in use.
  */
 extern void EventCallback_Register(EventCallback_Type *handle);
 
@@ -135,6 +182,18 @@ extern void EventCallback_Remove(EventCallback_Type *handle);
  */
 extern void EventCallback_Call(uint16_t event_id);
 
+/** \brief Returns profiling information of given event id.
+ *
+ * \param event_id
+ * ID of event.
+ *
+ * \returns
+ * Pointer to statistics of this event id or NULL if no callback was ever
+ * registered for it.
+ */
+extern const struct EventCallback_Stats * EventCallback_GetStats(
+        uint16_t event_id);
+
 #ifdef __cplusplus
 }
 #endif
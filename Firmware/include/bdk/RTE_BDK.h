@@ -47,6 +47,23 @@
 #define RTE_APP_TASK_HANDLER_COUNT       24
 #endif
 
+// <o> APP Task deferred callback queue size. <2-256>
+// <i> Number of callbacks scheduled by BDK_TaskSchedule that can wait for
+// <i> execution in main loop. Must be a power of two.
+// <i> Callbacks that do not fit are sent as Event Kernel messages instead.
+// <i> Default: 16
+#ifndef RTE_APP_TASK_QUEUE_SIZE
+#define RTE_APP_TASK_QUEUE_SIZE          16
+#endif
+
+// <o> Event Callback event ID count. <2-256>
+// <i> Maximum number of distinct event IDs that can have registered event
+// <i> callbacks at the same time. Must be a power of two.
+// <i> Default: 16
+#ifndef RTE_APP_EVENT_CALLBACK_ID_COUNT
+#define RTE_APP_EVENT_CALLBACK_ID_COUNT  16
+#endif
+
 
 #endif /* RTE_BDK_H_ */
 
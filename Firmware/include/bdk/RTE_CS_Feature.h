@@ -21,6 +21,7 @@
 //-----------------------------------------------------------------------------
 
 // Maximum number of active nodes including SYS node.
+// At most 32 nodes are supported by the poll pending bitmap.
 #define CS_MAX_NODE_COUNT ((int)16)
 
 // Maximum length of text page of TEXT datatype property
@@ -30,6 +31,30 @@
 // -2b -> Response datatype t/
 #define CS_TEXT_PAGE_LEN ((int)16)
 
+// Maximum number of simultaneously active property subscriptions.
+#define CS_MAX_SUBSCRIPTION_COUNT ((int)8)
+
+// Maximum length of property name or comma separated list of property names
+// that can be subscribed to.
+#define CS_SUB_PROPERTY_LEN ((int)15)
+
+// Shortest and longest allowed subscription interval in milliseconds.
+#define CS_SUB_MIN_INTERVAL_MS ((uint32_t)50)
+#define CS_SUB_MAX_INTERVAL_MS ((uint32_t)3600000)
+
+// Subscription notifications may be delayed by interval / 2^N to share
+// wake-ups with other timers.
+#define CS_SUB_SLACK_SHIFT ((uint32_t)4)
+
+// Maximum number of asynchronous requests in flight across all nodes.
+#define CS_MAX_PENDING_COUNT ((int)4)
+
+// Maximum number of request tokens waiting for one asynchronous request.
+#define CS_PENDING_MAX_TOKENS ((int)8)
+
+// Maximum length of property name of asynchronous request.
+#define CS_PENDING_PROPERTY_LEN ((int)7)
+
 // Enable Logging levels
 #ifndef APP_TRACE_DISABLED
 #define CS_LOG_ERROR_ENABLE 1
@@ -35,6 +35,19 @@
 //   <3=> 3
 #define RTE_HB_BHI160_NDOF_INT_SRC  3
 
+// <o> FIFO EventCallback ID <0-65535>
+// <i> This number identifies events generated after BHI160 FIFO was drained.
+// <i> It has to be unique among all used EventCallback event sources.
+// <i> Default: 16
+#define RTE_HB_BHI160_NDOF_FIFO_EVENT_ID  16
+
+// <o> Dynamic Range EventCallback ID <0-65535>
+// <i> This number identifies events generated when BHI160 reports change of
+// <i> dynamic range of a physical sensor.
+// <i> It has to be unique among all used EventCallback event sources.
+// <i> Default: 17
+#define RTE_HB_BHI160_NDOF_RANGE_EVENT_ID  17
+
 // <<< end of configuration section >>>
 
 #endif /* RTE_HB_BHI160_NDOF_H_ */
@@ -49,7 +49,7 @@
 
 // <e> Button 1 Interrupt Enable
 // <i> Enables Interrupt support for button 1 of HB-GEVB.
-#define RTE_BUTTON_HB_BTN1_INT_ENABLE  1
+#define RTE_BUTTON_HB_BTN1_INT_ENABLE  0
 
 // <o> BTN0 Interrupt Source
 // <i> Determines which of the four DIO Interrupt Configuration registers to use for button 1.
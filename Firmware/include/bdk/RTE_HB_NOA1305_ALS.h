@@ -23,7 +23,7 @@
 
 // <e> Enable Interrupt generation for NOA1305
 #ifndef RTE_NOA1305_ALS_INT_ENABLED
-#define RTE_NOA1305_ALS_INT_ENABLED          1
+#define RTE_NOA1305_ALS_INT_ENABLED          0
 #endif
 
 // <o> Interrupt signal DIO Pad <0-15>
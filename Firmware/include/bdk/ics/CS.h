@@ -22,9 +22,12 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "RTE_CS_Feature.h"
 
+#include <stimer.h>
+
 #include <ics/CS_Log.h>
 
 #ifdef __cplusplus
@@ -39,6 +42,28 @@ extern "C"
 /** Maximum number of data bytes that can be fit inside of a response packet. */
 #define CS_MAX_RESPONSE_LENGTH         (18)
 
+/** Number of slots in a \ref CS_NameIndex_Struct hash table.
+ *
+ * Has to be a power of two and should be at least twice the number of names
+ * stored in a single index to keep the probe sequences short.
+ * Largest index is used by AO node with 29 properties.
+ */
+#define CS_NAME_INDEX_SIZE             (64)
+
+/** Initial value of the FNV-1a hash used for node and property names. */
+#define CS_NAME_HASH_INIT              ((uint32_t)2166136261U)
+
+/** \brief Composes type tag of binary encoded response item.
+ *
+ * Tag has the most significant bit set to distinguish it from ASCII
+ * responses, followed by 3 bit \ref CS_BinaryType and 4 bit value count - 1.
+ * Values follow the tag in little-endian byte order.
+ */
+#define CS_BIN_TAG(type, count)        ((char)(0x80 | ((type) << 4) | ((count) - 1)))
+
+/** Checks if response item starts with binary type tag. */
+#define CS_IS_BIN_TAG(c)               (((uint8_t)(c) & 0x80) != 0)
+
 //-----------------------------------------------------------------------------
 // EXPORTED DATA TYPES DEFINITION
 //-----------------------------------------------------------------------------
@@ -85,6 +110,25 @@ struct CS_Request_Struct
 	 * of write request or NULL for read requests.
 	 */
 	const char* property_value;
+
+	/** \brief Hash of the property name computed by \ref CS_NameHash.
+	 *
+	 * Calculated while parsing the request so that nodes can look up their
+	 * properties using \ref CS_NameIndexFind without hashing the name again.
+	 */
+	uint32_t property_hash;
+};
+
+/** \brief Open addressing hash table mapping names to small integer ids.
+ *
+ * Used by CS to dispatch requests to nodes and by nodes to dispatch requests
+ * to their properties without comparing the name against every entry.
+ * Name strings are not copied and have to remain valid while the index is used.
+ */
+struct CS_NameIndex_Struct
+{
+	const char* name[CS_NAME_INDEX_SIZE];
+	uint8_t id[CS_NAME_INDEX_SIZE];
 };
 
 /** \brief Function prototype for node request handler.
@@ -140,9 +184,59 @@ struct CS_Node_Struct
 	/** \brief Polling function that is called from main loop to handle internal
 	 * processes of the node.
 	 *
+	 * It is called only when the node has pending work, i.e. after
+	 * \ref CS_NotifyNode or when poll_timer expires.
+	 *
 	 * This function is optional and can be set to NULL if not required.
 	 */
 	CS_PollHandler poll_handler;
+
+	/** \brief Timer of the node that makes poll_handler due when it expires.
+	 *
+	 * This timer is optional and can be set to NULL if not required.
+	 */
+	struct stimer* poll_timer;
+
+	/** \brief Position of the node in the node table.
+	 *
+	 * Assigned by \ref CS_RegisterNode.
+	 */
+	int index;
+};
+
+/** \brief Periodic push of property values requested by the peer device. */
+struct CS_Subscription_Struct
+{
+	/** \brief Subscribed node or NULL if this entry is not used. */
+	struct CS_Node_Struct* node;
+
+	/** \brief Property name or comma separated list of property names. */
+	char property[CS_SUB_PROPERTY_LEN + 1];
+
+	/** \brief Token used for all pushed response packets. */
+	char token;
+
+	/** \brief Push period in milliseconds. */
+	uint32_t interval_ms;
+
+	struct stimer timer;
+};
+
+/** \brief Asynchronous request waiting for completion by its node.
+ *
+ * Identical requests for the same node property that arrive while the
+ * request is in flight are coalesced and receive the same response.
+ */
+struct CS_Pending_Struct
+{
+	/** \brief Node processing the request or NULL if this entry is not used. */
+	struct CS_Node_Struct* node;
+
+	char property[CS_PENDING_PROPERTY_LEN + 1];
+
+	/** \brief Tokens of all requests waiting for the response. */
+	char token[CS_PENDING_MAX_TOKENS];
+	int token_cnt;
 };
 
 struct CS_Handle_Struct
@@ -150,17 +244,45 @@ struct CS_Handle_Struct
 	int node_cnt;
 	struct CS_Node_Struct* node[CS_MAX_NODE_COUNT];
 
+	/** \brief Bitmap of nodes with pending poll_handler call. */
+	volatile uint32_t poll_pending;
+	struct CS_NameIndex_Struct node_index;
+
+	/** \brief Timer context used by subscriptions or NULL if not set. */
+	struct stimer_ctx* timer_ctx;
+	struct CS_Subscription_Struct sub[CS_MAX_SUBSCRIPTION_COUNT];
+
+	/** \brief Non-zero if peer selected binary encoding of responses. */
+	int binary_encoding;
+
+	struct CS_Pending_Struct pending[CS_MAX_PENDING_COUNT];
+
 	const char* conf_content;
 	int conf_content_len;
 	int conf_page_cnt;
 };
 
+/** \brief Value types of binary encoded response items.
+ *
+ * Values are fixed point numbers. Decimal exponent of each property is
+ * appended to its property definition when binary encoding is enabled,
+ * e.g. "p/R/c/O/-1" means that value 1234 represents 123.4.
+ */
+enum CS_BinaryType
+{
+	CS_BIN_INT8   = 0,
+	CS_BIN_INT16  = 1,
+	CS_BIN_INT32  = 2,
+	CS_BIN_UINT32 = 3
+};
+
 enum CS_ErrorCodes
 {
 	CS_OK          = 0, /* \brief Generic success return value. */
 	CS_ERROR       = 1, /* \brief Generic error return value. */
 	CS_TIMEOUT     = 2,
-	CS_NO_RESPONSE = 3
+	CS_NO_RESPONSE = 3,
+	CS_PENDING     = 4  /* \brief Request joined one already in flight. */
 };
 
 
@@ -168,20 +290,172 @@ enum CS_ErrorCodes
 // EXPORTED FUNCTION DECLARATIONS
 //-----------------------------------------------------------------------------
 
+/** \brief Adds one character to a name hash.
+ *
+ * Start with \ref CS_NAME_HASH_INIT and feed all characters of the name.
+ */
+static inline uint32_t CS_NameHashUpdate(uint32_t hash, char c)
+{
+	return (hash ^ (uint8_t)c) * 16777619U;
+}
+
+/** \brief Calculates hash of zero terminated name string. */
+extern uint32_t CS_NameHash(const char* name);
+
+/** \brief Clears all entries of given name index. */
+extern void CS_NameIndexInit(struct CS_NameIndex_Struct* index);
+
+/** \brief Inserts name into the index.
+ *
+ * \param index
+ * Index to insert into.
+ *
+ * \param name
+ * Zero terminated name. Pointer is stored in the index.
+ *
+ * \param id
+ * Value that will be returned by \ref CS_NameIndexFind for this name.
+ *
+ * \returns CS_OK on success.
+ * \returns CS_ERROR if the index is full or the name is already present.
+ */
+extern int CS_NameIndexAdd(struct CS_NameIndex_Struct* index, const char* name,
+		uint8_t id);
+
+/** \brief Looks up name in the index.
+ *
+ * \param index
+ * Index to search.
+ *
+ * \param name
+ * Zero terminated name to look for.
+ *
+ * \param hash
+ * Hash of \p name as returned by \ref CS_NameHash.
+ *
+ * \returns id of the name if found.
+ * \returns -1 if the name is not present in the index.
+ */
+extern int CS_NameIndexFind(const struct CS_NameIndex_Struct* index,
+		const char* name, uint32_t hash);
+
 extern int CS_Init();
 
 extern int CS_RegisterNode(struct CS_Node_Struct* node);
 
-/**
+/** \brief Checks if peer device selected binary encoding of responses.
+ *
+ * Binary encoding is selected by writing 1 to SYS property ENC and is reset
+ * to ASCII encoding when nodes enter sleep mode on disconnect.
+ * Nodes that support it should encode their numeric responses using
+ * \ref CS_EncodeInt16 or \ref CS_EncodeInt32 when this returns non-zero.
+ * Error responses are always sent as ASCII strings.
+ */
+extern int CS_IsBinaryEncoding(void);
+
+/** \brief Writes binary tagged array of 16-bit values into response.
+ *
+ * \param[out] response
+ * Response buffer passed to request handler.
+ *
+ * \param[in] values
+ * Values to encode.
+ *
+ * \param count
+ * Number of values. (1 - 8)
+ *
+ * \returns Number of bytes written excluding terminating zero character.
+ */
+extern int CS_EncodeInt16(char* response, const int16_t* values, int count);
+
+/** \brief Writes binary tagged array of 32-bit values into response.
+ *
+ * Same as \ref CS_EncodeInt16 with up to 4 values.
+ */
+extern int CS_EncodeInt32(char* response, const int32_t* values, int count);
+
+/** \brief Calculates length of response that may contain binary items.
+ *
+ * Response is a sequence of binary tagged items and ';' separated ASCII
+ * strings terminated by zero character at the position of next item.
+ *
+ * \returns Number of bytes of the response excluding terminating zero.
+ */
+extern int CS_ResponseLength(const char* response);
+
+/** \brief Registers request that will be completed asynchronously.
+ *
+ * Called from node request handler that cannot respond immediately, e.g.
+ * because it has to wait for a sensor measurement. The handler then returns
+ * CS_NO_RESPONSE and later passes the response to \ref CS_AsyncComplete.
+ *
+ * \param[in] request
+ * Request passed to the request handler.
+ *
+ * \param[out] handle
+ * Handle identifying the asynchronous request.
+ *
+ * \returns CS_OK if a new asynchronous request was started. Node has to start
+ * the operation and complete it using the returned handle.
+ * \returns CS_PENDING if the same property is already being processed. Request
+ * token was added to the request in flight and will receive its response.
+ * \returns CS_ERROR if there are too many requests in flight. Handler should
+ * respond with an error.
+ */
+extern int CS_AsyncBegin(const struct CS_Request_Struct* request, int* handle);
+
+/** \brief Sends response of asynchronous request to all waiting tokens.
+ *
+ * \param handle
+ * Handle returned by \ref CS_AsyncBegin.
+ *
+ * \param[in] response
+ * Node response without token, same as request handler would provide.
+ */
+extern int CS_AsyncComplete(int handle, const char* response);
+
+/** \brief Drops asynchronous request without sending any response. */
+extern void CS_AsyncCancel(int handle);
+
+/** \brief Parses request packet and passes it to the addressed node.
+ *
+ * Read requests may address multiple properties of one node at once by
+ * separating property names with commas, e.g. "5/AO/H,P,R". Responses to such
+ * requests are joined with ';' and packed into as few response packets as
+ * possible, each starting with the request token, e.g. "5/f/12.5;f/0.3".
+ *
+ * Property value "SUB/<ms>" subscribes to periodic push of the property (or
+ * list of properties) with given period, e.g. "7/AO/O/SUB/100".
+ * The current value is sent immediately and then every period with the token
+ * of the subscribe request until "7/AO/O/UNSUB" is received or all
+ * subscriptions are cleared by \ref CS_SetPowerMode.
  *
  * \param[in] request
  * Pointer to zero terminated C-string that contains request payload.
+ * Content of the string is modified during parsing.
  */
 extern int CS_ProcessRequest(char *request);
 
-/** */
+/** \brief Calls poll handlers of nodes with pending work and pushes values
+ * of due subscriptions.
+ *
+ * Poll handler of a node is called if the node was notified by
+ * \ref CS_NotifyNode since the last call or if its poll_timer expired.
+ */
 extern int CS_PollNodes(void);
 
+/** \brief Marks node as having pending work for its poll handler.
+ *
+ * Can be called from interrupt context.
+ */
+extern void CS_NotifyNode(const struct CS_Node_Struct* node);
+
+/** \brief Checks if some node was notified and waits for its poll handler.
+ *
+ * Expired node timers are not reported by this function.
+ */
+extern bool CS_IsPollPending(void);
+
 /**
  *
  * \param response
@@ -190,8 +464,20 @@ extern int CS_PollNodes(void);
  */
 extern int CS_InjectResponse(char* response);
 
+/** \brief Sets power mode of all nodes.
+ *
+ * Entering \ref CS_POWER_MODE_SLEEP also cancels all subscriptions and
+ * asynchronous requests in flight.
+ */
 extern int CS_SetPowerMode(enum CS_PowerMode mode);
 
+/** \brief Provides timer context used to schedule subscriptions.
+ *
+ * Has to be called after the timer context is initialized.
+ * Subscribe requests are rejected until this function is called.
+ */
+extern void CS_SetTimerContext(struct stimer_ctx* ctx);
+
 //extern void CS_SetAppConfig(const char* content);
 
 
@@ -20,6 +20,7 @@
 #include "CSN_LP_ALS.h"
 #include "CSN_LP_ENV.h"
 #include "CSN_LP_AO.h"
+#include "CSN_LP_VB.h"
 
 
 //#ifdef RTE_ICS_PROTOCOL_NODE_ENV
@@ -33,6 +33,30 @@ extern "C" {
 #endif /* __cplusplus */
 
 
+/**
+ * Maximum number of running timers kept in the expiry queue of one context.
+ * Timers that do not fit into the queue are still serviced, but finding the
+ * next expiration falls back to a scan of all timers until space is available.
+ * The scan recomputes deadlines of those timers and costs more than a plain
+ * walk of the timer list, so the queue should hold all timers of a context.
+ */
+#ifndef STIMER_MAX_QUEUED
+#define STIMER_MAX_QUEUED                   (16)
+#endif
+
+
+/**
+ * Set to 1 to keep timer intervals and elapsed times as raw get_time_fn counts
+ * instead of seconds and nanoseconds. Time units are converted to counts by
+ * precomputed multiply and shift, so checking timers needs no 64-bit division.
+ * The API is the same in both modes, but intervals are rounded up to whole
+ * counts, so periodic timers driven by stimer_advance may run slightly slower.
+ */
+#ifndef STIMER_COUNT_MODE
+#define STIMER_COUNT_MODE                   (0)
+#endif
+
+
 // ----------------------------------------------------------- Timer structures
 
 /**
@@ -62,6 +86,17 @@ struct stimer_duration {
 };
 
 
+#if STIMER_COUNT_MODE
+/**
+ * Conversion of a time unit to counts: counts = (value * mul) >> shift
+ */
+struct stimer_conversion {
+    uint32_t mul;
+    uint8_t shift;
+};
+#endif /* STIMER_COUNT_MODE */
+
+
 // ---------------------- Timer context
 struct stimer_ctx {
     // Timer linked list root
@@ -71,11 +106,27 @@ struct stimer_ctx {
     // Timer math
     struct tm_math                      tm;
     uint32_t                            ns_per_count;
+#if STIMER_COUNT_MODE
+    struct stimer_conversion            s_to_counts;
+    struct stimer_conversion            ms_to_counts;
+    struct stimer_conversion            us_to_counts;
+    struct stimer_conversion            ns_to_counts;
+#endif /* STIMER_COUNT_MODE */
 
 
     // Time function
     stimer_get_time_fn                  get_time_fn;
     void *                              hint;
+
+
+    // Running timers ordered by deadline (binary min-heap)
+    struct stimer *                     queue[STIMER_MAX_QUEUED];
+    uint16_t                            queue_len;
+    bool                                queue_overflow;
+
+
+    // Time of last stimer_execute_context call
+    uint32_t                            last_execute;
 };
 
 
@@ -93,13 +144,32 @@ struct stimer {
     uint32_t                            checkpoint;
 
 
+#if STIMER_COUNT_MODE
+    // Expire period in counts
+    uint64_t                            expire_counts;
+
+
+    // Elapsed time in counts
+    uint64_t                            elapsed_counts;
+#else
     // Expire period
     struct stimer_duration              expire_interval;
 
 
     // Elapsed time
     struct stimer_duration              elapsed;
+#endif /* STIMER_COUNT_MODE */
     bool                                is_running;
+
+
+    // Allowed expiration delay in counts
+    uint32_t                            slack;
+
+
+    // Latest time of expiration (including slack) and position in context
+    // queue (-1 if not queued)
+    uint32_t                            deadline;
+    int16_t                             queue_index;
 };
 
 
@@ -166,6 +236,23 @@ void
 stimer_execute_context(struct stimer_ctx * ctx);
 
 
+/**
+ * @brief Gets time remaining until the nearest timer expiration
+ * @details Running timers with an expiration set are kept ordered by their
+ *          latest allowed expiration time (expiration + slack), so this does
+ *          not iterate over all timers. Waking up at the returned time
+ *          services the most urgent timer as well as every other timer that
+ *          expires before it. It also calls stimer_execute_context when
+ *          needed to keep timers safe from get_time_fn value rollover.
+ * @param ctx Timer context
+ * @param counts Number of get_time_fn counts until the nearest timer
+ *          has to be serviced or 0 if it is already overdue
+ * @return true if some timer is set to expire, else false
+ */
+bool
+stimer_get_next_expiry(struct stimer_ctx * ctx, uint32_t * counts);
+
+
 // --------------------------------------------------------------- Timer handle
 
 /**
@@ -290,6 +377,21 @@ void
 stimer_expire_from_now_ns(struct stimer * ts, uint32_t ns);
 
 
+/**
+ * @brief Sets how long the timer expiration may be delayed
+ * @details A timer with slack still reports expiration at the exact time, but
+ *          stimer_get_next_expiry may postpone the wake up for it by up to
+ *          the slack so that it can be serviced together with other timers.
+ *          The slack is kept until changed and applies to all following
+ *          expirations of the timer.
+ *
+ * @param ts Timer handle
+ * @param ms Allowed delay in milliseconds
+ */
+void
+stimer_set_slack_ms(struct stimer * ts, uint32_t ms);
+
+
 /**
  * @brief Checks if a timer has expired
  *
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+//-----------------------------------------------------------------------------
+
+#ifndef FFT_Q15_H_
+#define FFT_Q15_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/** \brief Largest supported transform size. */
+#define FFT_Q15_MAX_SIZE               512
+
+/** \brief Complex number with Q15 real and imaginary part. */
+struct FFT_Q15_Complex
+{
+    int16_t re;
+    int16_t im;
+};
+
+/** \brief Computes forward FFT in place.
+ *
+ * Radix-4 butterflies are used for pairs of radix-2 stages with one radix-2
+ * stage added for odd powers of two. Each stage scales its output so that
+ * the result is DFT of the input divided by \p size.
+ *
+ * Does not depend on any device specific code and can be built for host.
+ *
+ * \param data
+ * Input samples in natural order. Replaced by frequency bins 0 .. size-1.
+ * Magnitude of each input value must not exceed 32767.
+ *
+ * \param size
+ * Number of samples. Power of two from 4 to FFT_Q15_MAX_SIZE.
+ *
+ * \returns
+ * 0 on success, -1 if size is not supported.
+ */
+extern int FFT_Q15_Transform(struct FFT_Q15_Complex* data, uint32_t size);
+
+/** \brief Returns Q15 coefficient of Hann window.
+ *
+ * \param n
+ * Sample index. (0 .. size-1)
+ *
+ * \param size
+ * Window length. Power of two up to FFT_Q15_MAX_SIZE.
+ */
+extern int16_t FFT_Q15_Hann(uint32_t n, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FFT_Q15_H_ */
@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+//-----------------------------------------------------------------------------
+
+#ifndef FUSION_Q_H_
+#define FUSION_Q_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/** \brief Value of 1.0 in Q30 format used for quaternion components. */
+#define FUSION_Q_ONE                   (1L << 30)
+
+/** \brief State of Mahony orientation filter. */
+struct Fusion_Q_State
+{
+    /** Orientation quaternion w, x, y, z in Q30. */
+    int32_t q[4];
+
+    /** Integral feedback of gyroscope bias in rad/s Q30. */
+    int32_t integral[3];
+
+    /** Doubled proportional gain in Q16. */
+    int32_t two_kp;
+
+    /** Doubled integral gain in Q16. */
+    int32_t two_ki;
+
+    /** Estimate was aligned to measured gravity and magnetic field. */
+    uint8_t is_aligned;
+};
+
+/** \brief Resets filter so that the next update aligns it to measured
+ * orientation.
+ *
+ * \param state
+ * Filter state to initialize.
+ *
+ * \param kp
+ * Proportional gain in Q16.
+ *
+ * \param ki
+ * Integral gain in Q16. Zero disables gyroscope bias estimation.
+ */
+extern void Fusion_Q_Init(struct Fusion_Q_State* state, int32_t kp,
+        int32_t ki);
+
+/** \brief Updates orientation estimate with one set of sensor samples.
+ *
+ * Fixed point implementation of Mahony's complementary filter. Accelerometer
+ * and magnetometer samples are normalized internally so their scale does not
+ * matter as long as all three axes use the same one.
+ *
+ * The first update with both accelerometer and magnetometer sample sets the
+ * estimate directly from them instead of waiting for the filter to converge
+ * from identity orientation.
+ *
+ * Does not depend on any device specific code and can be built for host.
+ *
+ * \param state
+ * Filter state.
+ *
+ * \param gyro
+ * Angular rate for x, y, z axis in rad/s Q16.
+ *
+ * \param accel
+ * Latest accelerometer sample. Correction from gravity is skipped if NULL
+ * or all axes are zero.
+ *
+ * \param mag
+ * Latest magnetometer sample. Heading correction is skipped if NULL or all
+ * axes are zero.
+ *
+ * \param dt
+ * Time elapsed since previous update in seconds Q32. Must be below 1 s.
+ */
+extern void Fusion_Q_Update(struct Fusion_Q_State* state, const int32_t* gyro,
+        const int16_t* accel, const int16_t* mag, uint32_t dt);
+
+/** \brief Converts current orientation to Euler angles.
+ *
+ * Angles follow the convention of BHI160 orientation virtual sensor.
+ *
+ * \param state
+ * Filter state.
+ *
+ * \param euler
+ * Output array for heading (0 .. 36000), pitch (-18000 .. 18000) and
+ * roll (-9000 .. 9000) in hundredths of a degree.
+ */
+extern void Fusion_Q_GetEuler(const struct Fusion_Q_State* state,
+        int32_t* euler);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FUSION_Q_H_ */
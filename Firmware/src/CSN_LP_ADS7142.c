@@ -18,6 +18,7 @@
 #include <string.h>
 
 #include <BDK.h>
+#include <HAL_RTC.h>
 #include <ics/CS.h>
 #include <ads7142.h>
 #include <CSN_LP_ADS7142.h>
@@ -36,7 +37,13 @@
 //#define CSN_ADS7142_AVAIL_BIT              ((uint32_t)0x00000080)
 #define CSN_ADS7142_AVAIL_BIT              ((uint32_t)0x00000040)
 
-#define CSN_ADS7142_PROP_CNT               (2)
+#define CSN_ADS7142_PROP_CNT               (4)
+
+// Number of captured alert windows kept until they are read by EW property.
+#define CSN_ADS7142_EVENT_LOG_SIZE         (4)
+
+// Allowed delay of measurements to share wake-ups with other timers.
+#define CSN_ADS7142_TIMER_SLACK_MS         (50)
 
 // Shortcut macros for logging of ALS node messages.
 #define CSN_ADS7142_Error(...) CS_LogError("ADS", __VA_ARGS__)
@@ -50,6 +57,9 @@
 
 static int CSN_LP_ADS7142_PowerModeHandler(enum CS_PowerMode mode);
 static void CSN_LP_ADS7142_PollHandler(void);
+static void CSN_ADS7142_AlertCallback(void);
+static void CSN_ADS7142_HandleAlerts(void);
+static void CSN_ADS7142_LogEvent(uint64_t time);
 
 /** \brief Handler for CS requests provided in node structure. */
 static int CSN_ADS7142_RequestHandler(const struct CS_Request_Struct* request,
@@ -59,18 +69,48 @@ static int CSN_ADS7142_RequestHandler(const struct CS_Request_Struct* request,
 static int CSN_ADS7142_X_PropHandler(char* response);
 static int CSN_ADS7142_Y_PropHandler(char* response);
 
+// Event log
+static int CSN_ADS7142_EC_PropHandler(char* response);
+static int CSN_ADS7142_EventRead(const struct CS_Request_Struct* request,
+        char* response);
+
 //-----------------------------------------------------------------------------
 // INTERNAL VARIABLES
 //-----------------------------------------------------------------------------
 
 static struct stimer env_timer;
 
-static struct stimer env_timebase_timer;
-
 static int32_t channels[2] = { -1 };
 
 static bool data_requested = false;
 
+/** \brief Alerts lost due to full ADS7142 alert queue, already reported. */
+static uint32_t alerts_dropped = 0;
+
+/** \brief Pre-alert window captured after an alert. */
+struct CSN_ADS7142_Event_Struct
+{
+    /** RTC time of the alert. */
+    uint64_t time;
+
+    /** Channels that crossed low threshold. */
+    uint8_t low_flags;
+
+    /** Channels that crossed high threshold. */
+    uint8_t high_flags;
+
+    /** Pre-alert data buffer, channels 0 and 1 interleaved. */
+    uint16_t sample[ADS7142_PRE_ALERT_SAMPLES];
+};
+
+/** \brief Captured windows waiting to be read by EW property.
+ *
+ * Indexes are free running, head - tail is the number of pending events.
+ */
+static struct CSN_ADS7142_Event_Struct event_log[CSN_ADS7142_EVENT_LOG_SIZE];
+static uint32_t event_head = 0;
+static uint32_t event_tail = 0;
+
 /** \brief CS node structure passed to CS. */
 static struct CS_Node_Struct env_node = {
         CSN_ADS7142_NODE_NAME,
@@ -89,9 +129,15 @@ struct CSN_ADS7142_Property_Struct
 
 static struct CSN_ADS7142_Property_Struct env_prop[CSN_ADS7142_PROP_CNT] = {
         { "T",  "p/R/f/T",  &CSN_ADS7142_X_PropHandler},
-        { "TF", "p/R/f/TF", &CSN_ADS7142_Y_PropHandler}
+        { "TF", "p/R/f/TF", &CSN_ADS7142_Y_PropHandler},
+        { "EC", "p/R/i/EC", &CSN_ADS7142_EC_PropHandler},
+        // Reads are handled by CSN_ADS7142_EventRead which needs request token.
+        { "EW", "p/R/i/EW", NULL}
 };
 
+/** \brief Lookup table from property name to index into env_prop. */
+static struct CS_NameIndex_Struct env_prop_index;
+
 
 //-----------------------------------------------------------------------------
 // FUNCTION DEFINITIONS
@@ -109,6 +155,17 @@ struct CS_Node_Struct* CSN_LP_ADS7142_Create(struct stimer_ctx* ctx)
 {
     struct CS_Node_Struct* retval_node = NULL;
 
+    CS_NameIndexInit(&env_prop_index);
+    for (int i = 0; i < CSN_ADS7142_PROP_CNT; ++i)
+    {
+        if (CS_NameIndexAdd(&env_prop_index, env_prop[i].name, i) != CS_OK)
+        {
+            CSN_ADS7142_Error("Failed to index property '%s'.",
+                    env_prop[i].name);
+            return NULL;
+        }
+    }
+
 	/* Check if timer context was provided. */
 	if (ctx != NULL) {
 
@@ -119,15 +176,11 @@ struct CS_Node_Struct* CSN_LP_ADS7142_Create(struct stimer_ctx* ctx)
 			 * BSEC processing should be called from main loop.
 			 */
 			stimer_init(&env_timer, ctx);
+			stimer_set_slack_ms(&env_timer, CSN_ADS7142_TIMER_SLACK_MS);
 			stimer_expire_from_now_ns(&env_timer, 1);
+			env_node.poll_timer = &env_timer;
 
-			/* Always running timer that keeps track of how much time has
-			 * elapsed since node initialization.
-			 * This timer uses RTC due to usage of deep slep mode of RSL10.
-			 * Used as a source of timestamps for BSEC library.
-			 */
-			stimer_init(&env_timebase_timer, ctx);
-			stimer_start(&env_timebase_timer);
+			ads7142_set_alert_callback(&CSN_ADS7142_AlertCallback);
 
 			retval_node = &env_node;
 
@@ -171,10 +224,74 @@ static int CSN_LP_ADS7142_PowerModeHandler(enum CS_PowerMode mode)
     return CS_OK;
 }
 
+/** \brief Called from main loop after ADS7142 ALERT interrupt. */
+static void CSN_ADS7142_AlertCallback(void)
+{
+    CS_NotifyNode(&env_node);
+}
+
+/** \brief Processes alerts queued by ALERT interrupt and re-arms monitoring.
+ */
+static void CSN_ADS7142_HandleAlerts(void)
+{
+    uint64_t alert_time;
+    uint64_t first_time = 0;
+    bool alerted = false;
+
+    while (ads7142_alert_pop(&alert_time))
+    {
+        CSN_ADS7142_Info("Alert at %lu ms.",
+                (uint32_t)HAL_RTC_TICKS_TO_MS(alert_time));
+        if (!alerted)
+        {
+            first_time = alert_time;
+        }
+        alerted = true;
+    }
+
+    if (ads7142_alert_get_dropped() != alerts_dropped)
+    {
+        alerts_dropped = ads7142_alert_get_dropped();
+        CSN_ADS7142_Warn("Alert queue overflow, %lu alerts lost.",
+                alerts_dropped);
+    }
+
+    // Monitoring runs only while no data was requested.
+    if (alerted && !data_requested)
+    {
+        // ALERT stays high until flags are reset, so later alerts in the
+        // queue belong to the window that triggered the first one.
+        CSN_ADS7142_LogEvent(first_time);
+        ads7142_autonomous_mode_start();
+    }
+}
+
+/** \brief Stores alert flags and pre-alert data buffer into event log. */
+static void CSN_ADS7142_LogEvent(uint64_t time)
+{
+    struct CSN_ADS7142_Event_Struct* e;
+
+    if (event_head - event_tail >= CSN_ADS7142_EVENT_LOG_SIZE)
+    {
+        CSN_ADS7142_Warn("Event log full, alert window discarded.");
+        return;
+    }
+
+    e = &event_log[event_head % CSN_ADS7142_EVENT_LOG_SIZE];
+    if (ads7142_read_flags(&e->low_flags, &e->high_flags, e->sample)
+        != ADS7142_OK)
+    {
+        CSN_ADS7142_Error("Failed to read alert window (err=%d).",
+                (int)ads7142_get_hal_error());
+        return;
+    }
+    e->time = time;
+    event_head++;
+}
+
 static void CSN_LP_ADS7142_PollHandler(void)
 {
-    static struct stimer_duration last;
-    struct stimer_duration now;
+    CSN_ADS7142_HandleAlerts();
 
     if (env_timer.is_running && stimer_is_expired(&env_timer))
     {
@@ -190,10 +307,7 @@ static void CSN_LP_ADS7142_PollHandler(void)
 
 			stimer_expire_from_now_ms(&env_timer, next_call_ms);
 
-			stimer_get_elapsed_time(&env_timebase_timer, &now);
 			TRACE_PRINTF("Next BSEC process in: %lu ms\r\n", next_call_ms);
-
-			memcpy(&last, &now, sizeof(struct stimer_duration));
     	}
     }
 }
@@ -208,18 +322,21 @@ static int CSN_ADS7142_RequestHandler(const struct CS_Request_Struct* request, c
         return CS_OK;
     }
 
+    if (strcmp(request->property, "EW") == 0)
+    {
+        return CSN_ADS7142_EventRead(request, response);
+    }
+
     // AO Data property requests
-    data_requested = true;
-    for (int i = 0; i < CSN_ADS7142_PROP_CNT; ++i)
+    int i = CS_NameIndexFind(&env_prop_index, request->property,
+            request->property_hash);
+    if (i >= 0)
     {
-        if (strcmp(request->property, env_prop[i].name) == 0)
+        if (env_prop[i].callback(response) != CS_OK)
         {
-            if (env_prop[i].callback(response) != CS_OK)
-            {
-                strcpy(response, "e/NODE_ERR");
-            }
-            return CS_OK;
+            strcpy(response, "e/NODE_ERR");
         }
+        return CS_OK;
     }
 
     // PROP property request
@@ -251,7 +368,15 @@ static int CSN_ADS7142_RequestHandler(const struct CS_Request_Struct* request, c
             int prop_index = atoi(&request->property[4]);
             if (prop_index >= 0 && prop_index < CSN_ADS7142_PROP_CNT)
             {
-                sprintf(response, "n/%s", env_prop[prop_index].prop_def);
+                if (CS_IsBinaryEncoding())
+                {
+                    // Raw ADC counts are sent as int32 without scaling.
+                    sprintf(response, "n/%s/0", env_prop[prop_index].prop_def);
+                }
+                else
+                {
+                    sprintf(response, "n/%s", env_prop[prop_index].prop_def);
+                }
                 return CS_OK;
             }
             else
@@ -274,12 +399,114 @@ static int CSN_ADS7142_RequestHandler(const struct CS_Request_Struct* request, c
 
 static int CSN_ADS7142_X_PropHandler(char* response)
 {
-    sprintf(response, "f/%.2f", (float) channels[0]);
+    data_requested = true;
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt32(response, &channels[0], 1);
+    }
+    else
+    {
+        sprintf(response, "f/%.2f", (float) channels[0]);
+    }
     return CS_OK;
 }
 
 static int CSN_ADS7142_Y_PropHandler(char* response)
 {
-    sprintf(response, "f/%.2f", (float) channels[1]);
+    data_requested = true;
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt32(response, &channels[1], 1);
+    }
+    else
+    {
+        sprintf(response, "f/%.2f", (float) channels[1]);
+    }
+    return CS_OK;
+}
+
+/** \brief Returns number of captured alert windows waiting to be read. */
+static int CSN_ADS7142_EC_PropHandler(char* response)
+{
+    int32_t count = event_head - event_tail;
+
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt32(response, &count, 1);
+    }
+    else
+    {
+        sprintf(response, "i/%d", (int) count);
+    }
     return CS_OK;
 }
+
+/** \brief Streams all captured alert windows and removes them from the log.
+ *
+ * Each window is sent as notifications with the token of the request.
+ * Header packet contains four int32 values: event number, alert time in ms,
+ * alert flags (low flags in bits 0-7, high flags in bits 8-15) and sample
+ * count. It is followed by packets of up to 8 int16 samples of the pre-alert
+ * buffer with channels 0 and 1 interleaved.
+ *
+ * Single header with sample count 0 is sent if the log is empty.
+ *
+ * Available only with binary encoding.
+ */
+static int CSN_ADS7142_EventRead(const struct CS_Request_Struct* request,
+        char* response)
+{
+    char packet[21];
+    int32_t header[4];
+    int16_t v[8];
+    int n = 0;
+
+    if (CS_IsBinaryEncoding() == 0)
+    {
+        strcpy(response, "e/ENC");
+        return CS_OK;
+    }
+
+    packet[0] = request->token[0];
+    packet[1] = '/';
+
+    if (event_tail == event_head)
+    {
+        header[0] = event_tail;
+        header[1] = 0;
+        header[2] = 0;
+        header[3] = 0;
+        CS_EncodeInt32(&packet[2], header, 4);
+        CS_InjectResponse(packet);
+        return CS_NO_RESPONSE;
+    }
+
+    while (event_tail != event_head)
+    {
+        const struct CSN_ADS7142_Event_Struct* e =
+                &event_log[event_tail % CSN_ADS7142_EVENT_LOG_SIZE];
+
+        header[0] = event_tail;
+        header[1] = HAL_RTC_TICKS_TO_MS(e->time);
+        header[2] = e->low_flags | (e->high_flags << 8);
+        header[3] = ADS7142_PRE_ALERT_SAMPLES;
+        CS_EncodeInt32(&packet[2], header, 4);
+        CS_InjectResponse(packet);
+
+        for (int k = 0; k < ADS7142_PRE_ALERT_SAMPLES; ++k)
+        {
+            v[n++] = e->sample[k];
+
+            if (n == 8 || k + 1 == ADS7142_PRE_ALERT_SAMPLES)
+            {
+                CS_EncodeInt16(&packet[2], v, n);
+                CS_InjectResponse(packet);
+                n = 0;
+            }
+        }
+
+        event_tail++;
+    }
+
+    return CS_NO_RESPONSE;
+}
@@ -27,6 +27,9 @@
 
 #define CSN_ALS_AVAIL_BIT ((uint32_t)0x00000002)
 
+// Allowed delay of reading the measurement to share wake-ups with other timers.
+#define CSN_ALS_TIMER_SLACK_MS (20)
+
 // Shortcut macros for logging of ALS node messages.
 #define CSN_ALS_Error(...) CS_LogError("ALS", __VA_ARGS__)
 #define CSN_ALS_Warn(...) CS_LogWarning("ALS", __VA_ARGS__)
@@ -68,7 +71,8 @@ static bool noa1305_is_awake = false;
  */
 static struct stimer noa1305_timer;
 
-static char als_response_token = 0;
+/* Handle of asynchronous L request waiting for the measurement or -1. */
+static int als_pending_handle = -1;
 
 //-----------------------------------------------------------------------------
 // FUNCTION DEFINITIONS
@@ -132,6 +136,10 @@ struct CS_Node_Struct* CSN_LP_ALS_Create(struct stimer_ctx *ctx)
 
     /* Initialize internal timer. */
     stimer_init(&noa1305_timer, ctx);
+    stimer_set_slack_ms(&noa1305_timer, CSN_ALS_TIMER_SLACK_MS);
+
+    /* Poll handler is called when measurement time elapses. */
+    als_node.poll_timer = &noa1305_timer;
 
     return retval_node;
 }
@@ -149,19 +157,32 @@ static int CSN_ALS_RequestHandler(const struct CS_Request_Struct* request, char*
     // LUX property request
     if (strcmp(request->property, "L") == 0)
     {
-        /* Wake-up the NOA1305 sensor. */
-        CSN_ALS_PowerModeHandler(CS_POWER_MODE_NORMAL);
+        int handle;
+
+        switch (CS_AsyncBegin(request, &handle))
+        {
+        case CS_OK:
+            /* Wake-up the NOA1305 sensor. */
+            CSN_ALS_PowerModeHandler(CS_POWER_MODE_NORMAL);
+
+            // Set timer to read light data after required number of
+            // measurement cycles elapsed.
+            stimer_expire_from_now_us(&noa1305_timer,
+                    CSN_LP_ALS_MEASURE_CYCLES * CSN_LP_ALS_INTEG_TIME_US);
 
-        // Set timer to read light data after required number of measurement
-        // cycles elapsed.
-        stimer_expire_from_now_us(&noa1305_timer,
-                CSN_LP_ALS_MEASURE_CYCLES * CSN_LP_ALS_INTEG_TIME_US);
+            als_pending_handle = handle;
 
-        // Save token of this request that will be used in the response
-        als_response_token = request->token[0];
+            // Response is sent when the measurement completes.
+            return CS_NO_RESPONSE;
 
-        // Tell ICS that it should not send any response to peer device.
-        return CS_NO_RESPONSE;
+        case CS_PENDING:
+            // Measurement in progress will answer this request as well.
+            return CS_NO_RESPONSE;
+
+        default:
+            sprintf(response, "e/BUSY");
+            return CS_OK;
+        }
     }
 
     // PROP property request
@@ -199,6 +220,8 @@ static int CSN_ALS_PowerModeHandler(enum CS_PowerMode mode)
         retval = noa1305_set_power_mode(NOA1305_POWER_DOWN, &noa1305);
         noa1305_is_awake = false;
         stimer_stop(&noa1305_timer);
+        CS_AsyncCancel(als_pending_handle);
+        als_pending_handle = -1;
         CSN_ALS_Verbose("NOA1305 powered off.");
         break;
     }
@@ -219,16 +242,18 @@ static void CSN_ALS_PollHandler(void)
         retval = noa1305_convert_als_data_lux(&lux, &noa1305);
         if (retval == NOA1305_OK)
         {
-            // Compose response packet and send notification to peer device.
-            snprintf(response, 21, "%c/f/%lu.00", als_response_token, lux);
-
-            CS_InjectResponse(response);
+            snprintf(response, 19, "f/%lu.00", lux);
         }
         else
         {
             CSN_ALS_Error("Failed to read ALS data.");
+            sprintf(response, "e/NODE_ERR");
         }
 
+        // Send response to all requests waiting for this measurement.
+        CS_AsyncComplete(als_pending_handle, response);
+        als_pending_handle = -1;
+
         /* Put the sensor to power down mode until next request is received. */
         CSN_ALS_PowerModeHandler(CS_POWER_MODE_SLEEP);
     }
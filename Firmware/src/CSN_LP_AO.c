@@ -22,8 +22,12 @@
 #include <string.h>
 
 #include <BDK.h>
+#include <EventCallback.h>
+#include <HAL_RTC.h>
 #include <CSN_LP_AO.h>
 #include <BHI160_NDOF.h>
+#include <RTE_HB_BHI160_NDOF.h>
+#include <fusion_q.h>
 
 
 //-----------------------------------------------------------------------------
@@ -34,7 +38,83 @@
 
 #define CSN_AO_AVAIL_BIT               0x00000010
 
-#define CSN_AO_PROP_CNT                21
+#define CSN_AO_PROP_CNT                29
+
+#if (CSN_LP_AO_HISTORY_SIZE & (CSN_LP_AO_HISTORY_SIZE - 1)) != 0
+#error "RTE_APP_ICS_AO_HISTORY_SIZE has to be power of two."
+#endif
+
+#define CSN_AO_HISTORY_MASK            (CSN_LP_AO_HISTORY_SIZE - 1)
+
+#if (CSN_LP_AO_CAPTURE_SIZE & (CSN_LP_AO_CAPTURE_SIZE - 1)) != 0
+#error "RTE_APP_ICS_AO_CAPTURE_SIZE has to be power of two."
+#endif
+
+#if CSN_LP_AO_CAPTURE_PRE_TRIGGER >= CSN_LP_AO_CAPTURE_SIZE
+#error "RTE_APP_ICS_AO_CAPTURE_PRE_TRIGGER has to be less than RTE_APP_ICS_AO_CAPTURE_SIZE."
+#endif
+
+#define CSN_AO_CAPTURE_MASK            (CSN_LP_AO_CAPTURE_SIZE - 1)
+
+/** \brief Number of window samples recorded from the trigger sample on. */
+#define CSN_AO_CAPTURE_POST_TRIGGER \
+    (CSN_LP_AO_CAPTURE_SIZE - CSN_LP_AO_CAPTURE_PRE_TRIGGER)
+
+/** \brief Number of consecutive samples below free fall threshold that
+ * trigger free fall event. */
+#define CSN_AO_FREE_FALL_CNT \
+    ((CSN_LP_AO_CAPTURE_RATE * CSN_LP_AO_FREE_FALL_TIME + 999) / 1000)
+
+#if (CSN_LP_AO_SAMPLE_RATE * 5) > CSN_LP_AO_MAX_TOTAL_RATE
+#error "RTE_APP_ICS_AO_REPORT_RATE of all sensors exceeds RTE_APP_ICS_AO_MAX_TOTAL_RATE."
+#endif
+
+/** \brief Allowed delay of the idle sensor timer so that it can share
+ * wake-ups with other timers. */
+#define CSN_AO_TIMER_SLACK_MS          (1000)
+
+/** \brief Q24 factor converting raw orientation to 0.01 degree.
+ * (360 / 32768 * 100 * 2^24)
+ */
+#define CSN_AO_SCALE_ORIENTATION       (360 * 51200)
+
+/** \brief Q24 factor converting raw value to 0.01 of dynamic range unit for
+ * dynamic range of 1. (1 / 32768 * 100 * 2^24)
+ */
+#define CSN_AO_SCALE_PER_RANGE         (51200)
+
+/** \brief Q24 factor converting raw acceleration to 0.01 m/s^2 for dynamic
+ * range of 1 g. (9.80665 * CSN_AO_SCALE_PER_RANGE)
+ */
+#define CSN_AO_SCALE_PER_G             (502100)
+
+/** \brief Converts BHI160 timestamp (1/32000 s) to milliseconds. */
+#define CSN_AO_TIMESTAMP_TO_MS(ts)     ((ts) / 32)
+
+/** \brief Factor converting BHI160 timestamp difference to seconds in Q32.
+ * (2^32 / 32000)
+ */
+#define CSN_AO_TIMESTAMP_TO_Q32        (134218)
+
+/** \brief Q24 factor converting raw angular rate to rad/s in Q16 for dynamic
+ * range of 1 dps. (pi / 180 / 32768 * 2^16 * 2^24)
+ */
+#define CSN_AO_SCALE_GYRO_RAD          (585635)
+
+/** \brief Orientation computed by BHI160 fusion core. */
+#define CSN_AO_FUSION_BHI160           (0)
+
+/** \brief Orientation computed by software fusion on RSL10. */
+#define CSN_AO_FUSION_SOFTWARE         (1)
+
+/** \brief Proportional gain of software fusion in Q16. (0.5) */
+#define CSN_AO_FUSION_KP               (32768)
+
+/** \brief Integral gain of software fusion in Q16.
+ *
+ * Gyroscope virtual sensor is already bias compensated by BHI160.
+ */
+#define CSN_AO_FUSION_KI               (0)
 
 // Shortcut macros for logging of AO node messages.
 #define CSN_AO_Error(...) CS_LogError("AO", __VA_ARGS__)
@@ -46,8 +126,24 @@
 // EXTERNAL / FORWARD DECLARATIONS
 //-----------------------------------------------------------------------------
 
+struct CSN_AO_Sample_Struct;
+struct CSN_AO_Timestamp_Struct;
+
 static void CSN_AO_SensorCallback(bhy_data_generic_t *data,
         bhy_virtual_sensor_t sensor);
+static void CSN_AO_CaptureCallback(bhy_data_generic_t *data,
+        bhy_virtual_sensor_t sensor);
+static uint64_t CSN_AO_ExtendTimestamp(struct CSN_AO_Timestamp_Struct* t,
+        uint32_t timestamp);
+static uint64_t CSN_AO_SampleTimestamp(void);
+static void CSN_AO_BatchCallback(void *arg);
+static void CSN_AO_UpdateScales(void *arg);
+static uint32_t CSN_AO_Threshold(uint32_t mg, uint32_t range);
+static int CSN_AO_HistoryRequest(const struct CS_Request_Struct* request,
+        char* response);
+static void CSN_AO_SendSamples(char token,
+        const struct CSN_AO_Sample_Struct* sample, uint32_t mask, uint32_t seq,
+        uint32_t index, uint32_t count);
 
 /** \brief Handler for CS requests provided in node structure. */
 static int CSN_LP_AO_RequestHandler(const struct CS_Request_Struct* request,
@@ -56,10 +152,29 @@ static int CSN_LP_AO_RequestHandler(const struct CS_Request_Struct* request,
 static int CSN_LP_AO_PowerModeHandler(enum CS_PowerMode mode);
 static void CSN_LP_AO_PollHandler(void);
 static void CSN_LP_AO_EnableVirtualSensor(enum BHI160_NDOF_Sensor sensor);
+static void CSN_AO_DisableIdleSensors(void);
+static int CSN_AO_FindSensor(enum BHI160_NDOF_Sensor sensor);
+static int32_t CSN_AO_SetVirtualSensor(int idx, bool enable);
+static void CSN_AO_FusionUpdate(uint64_t timestamp, const int16_t* raw,
+        uint8_t status);
+static uint32_t CSN_AO_TotalRate(int idx, uint32_t rate);
+
+// Event Capture
+static int CSN_AO_CaptureRequest(const struct CS_Request_Struct* request,
+        char* response);
+static int32_t CSN_AO_CaptureSetSensor(bool enable);
+static int32_t CSN_AO_CaptureStop(void);
+static uint32_t CSN_AO_CaptureStart(void);
+static void CSN_AO_CaptureNotify(void);
+static void CSN_AO_CaptureRead(char token, uint32_t index, uint32_t count);
+static int CSN_AO_EV_PropHandler(char* response);
 
 // Sensor Calibration Status
 static int CSN_AO_C_PropHandler(char* response);
 
+// Streaming Statistics
+static int CSN_AO_ST_PropHandler(char* response);
+
 // Absolute Orientation Properties
 static int CSN_AO_H_PropHandler(char* response);
 static int CSN_AO_P_PropHandler(char* response);
@@ -92,6 +207,26 @@ static int CSN_AO_A_PropHandler(char* response);
 static int CSN_AO_M_PropHandler(char* response);
 static int CSN_AO_AR_PropHandler(char* response);
 
+static int CSN_AO_FO_PropHandler(char* response);
+static int CSN_AO_FG_PropHandler(char* response);
+static int CSN_AO_FA_PropHandler(char* response);
+static int CSN_AO_FM_PropHandler(char* response);
+static int CSN_AO_FAR_PropHandler(char* response);
+static int CSN_AO_FU_PropHandler(char* response);
+
+static int CSN_AO_FO_WriteHandler(const char* value, char* response);
+static int CSN_AO_FG_WriteHandler(const char* value, char* response);
+static int CSN_AO_FA_WriteHandler(const char* value, char* response);
+static int CSN_AO_FM_WriteHandler(const char* value, char* response);
+static int CSN_AO_FAR_WriteHandler(const char* value, char* response);
+static int CSN_AO_FU_WriteHandler(const char* value, char* response);
+
+static int CSN_AO_SetRate(int idx, const char* value, char* response);
+static void CSN_AO_WriteInteger(char* response, int32_t value);
+static void CSN_AO_WriteScalar(char* response, int32_t value);
+static void CSN_AO_WriteVector(char* response, const int32_t* v,
+        int32_t divisor);
+
 //-----------------------------------------------------------------------------
 // INTERNAL VARIABLES
 //-----------------------------------------------------------------------------
@@ -111,48 +246,287 @@ struct CSN_AO_Property_Struct
 	const char* prop_def;
 	int (*callback)(char* response);
 	enum BHI160_NDOF_Sensor required_sensor;
+
+	/** \brief Decimal exponent of binary encoded values. */
+	int8_t exponent;
+
+	/** \brief Handles write request, NULL for read only properties. */
+	int (*write_callback)(const char* value, char* response);
 };
 
 static const struct CSN_AO_Property_Struct ao_prop[CSN_AO_PROP_CNT] = {
-    { "C",   "p/R/h/CAL",  &CSN_AO_C_PropHandler,                                  0 },
-    { "O",     "p/R/c/O",   &CSN_AO_O_PropHandler,         BHI160_NDOF_S_ORIENTATION },
-    { "G",     "p/R/c/G",   &CSN_AO_G_PropHandler,             BHI160_NDOF_S_GRAVITY },
-    { "A",     "p/R/c/A",   &CSN_AO_A_PropHandler, BHI160_NDOF_S_LINEAR_ACCELERATION },
-    { "M",     "p/R/c/M",   &CSN_AO_M_PropHandler,      BHI160_NDOF_S_MAGNETIC_FIELD },
-    { "AR",   "p/R/c/AR",  &CSN_AO_AR_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION },
-    { "H",     "p/R/f/H",   &CSN_AO_H_PropHandler,         BHI160_NDOF_S_ORIENTATION },
-    { "P",     "p/R/f/P",   &CSN_AO_P_PropHandler,         BHI160_NDOF_S_ORIENTATION },
-    { "R",     "p/R/f/R",   &CSN_AO_R_PropHandler,         BHI160_NDOF_S_ORIENTATION },
-    { "GX",   "p/R/f/GX",  &CSN_AO_GX_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION },
-    { "GY",   "p/R/f/GY",  &CSN_AO_GY_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION },
-    { "GZ",   "p/R/f/GZ",  &CSN_AO_GZ_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION },
-    { "AX",   "p/R/f/AX",  &CSN_AO_AX_PropHandler, BHI160_NDOF_S_LINEAR_ACCELERATION },
-    { "AY",   "p/R/f/AY",  &CSN_AO_AY_PropHandler, BHI160_NDOF_S_LINEAR_ACCELERATION },
-    { "AZ",   "p/R/f/AZ",  &CSN_AO_AZ_PropHandler, BHI160_NDOF_S_LINEAR_ACCELERATION },
-    { "MX",   "p/R/f/MX",  &CSN_AO_MX_PropHandler,      BHI160_NDOF_S_MAGNETIC_FIELD },
-    { "MY",   "p/R/f/MY",  &CSN_AO_MY_PropHandler,      BHI160_NDOF_S_MAGNETIC_FIELD },
-    { "MZ",   "p/R/f/MZ",  &CSN_AO_MZ_PropHandler,      BHI160_NDOF_S_MAGNETIC_FIELD },
-    { "ARX", "p/R/f/ARX", &CSN_AO_ARX_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION },
-    { "ARY", "p/R/f/ARY", &CSN_AO_ARY_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION },
-    { "ARZ", "p/R/f/ARZ", &CSN_AO_ARZ_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION }
+    { "C",   "p/R/h/CAL",  &CSN_AO_C_PropHandler,                                  0,  0 },
+    { "O",     "p/R/c/O",   &CSN_AO_O_PropHandler,         BHI160_NDOF_S_ORIENTATION, -1 },
+    { "G",     "p/R/c/G",   &CSN_AO_G_PropHandler,             BHI160_NDOF_S_GRAVITY, -2 },
+    { "A",     "p/R/c/A",   &CSN_AO_A_PropHandler, BHI160_NDOF_S_LINEAR_ACCELERATION, -2 },
+    { "M",     "p/R/c/M",   &CSN_AO_M_PropHandler,      BHI160_NDOF_S_MAGNETIC_FIELD, -1 },
+    { "AR",   "p/R/c/AR",  &CSN_AO_AR_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION, -1 },
+    { "H",     "p/R/f/H",   &CSN_AO_H_PropHandler,         BHI160_NDOF_S_ORIENTATION, -2 },
+    { "P",     "p/R/f/P",   &CSN_AO_P_PropHandler,         BHI160_NDOF_S_ORIENTATION, -2 },
+    { "R",     "p/R/f/R",   &CSN_AO_R_PropHandler,         BHI160_NDOF_S_ORIENTATION, -2 },
+    { "GX",   "p/R/f/GX",  &CSN_AO_GX_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION, -2 },
+    { "GY",   "p/R/f/GY",  &CSN_AO_GY_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION, -2 },
+    { "GZ",   "p/R/f/GZ",  &CSN_AO_GZ_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION, -2 },
+    { "AX",   "p/R/f/AX",  &CSN_AO_AX_PropHandler, BHI160_NDOF_S_LINEAR_ACCELERATION, -2 },
+    { "AY",   "p/R/f/AY",  &CSN_AO_AY_PropHandler, BHI160_NDOF_S_LINEAR_ACCELERATION, -2 },
+    { "AZ",   "p/R/f/AZ",  &CSN_AO_AZ_PropHandler, BHI160_NDOF_S_LINEAR_ACCELERATION, -2 },
+    { "MX",   "p/R/f/MX",  &CSN_AO_MX_PropHandler,      BHI160_NDOF_S_MAGNETIC_FIELD, -2 },
+    { "MY",   "p/R/f/MY",  &CSN_AO_MY_PropHandler,      BHI160_NDOF_S_MAGNETIC_FIELD, -2 },
+    { "MZ",   "p/R/f/MZ",  &CSN_AO_MZ_PropHandler,      BHI160_NDOF_S_MAGNETIC_FIELD, -2 },
+    { "ARX", "p/R/f/ARX", &CSN_AO_ARX_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION, -2 },
+    { "ARY", "p/R/f/ARY", &CSN_AO_ARY_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION, -2 },
+    { "ARZ", "p/R/f/ARZ", &CSN_AO_ARZ_PropHandler,    BHI160_NDOF_S_RATE_OF_ROTATION, -2 },
+    { "ST",   "p/R/c/ST",  &CSN_AO_ST_PropHandler,                                  0,  0 },
+    { "FO",   "p/RW/i/FO",  &CSN_AO_FO_PropHandler,                                 0,  0,  &CSN_AO_FO_WriteHandler },
+    { "FG",   "p/RW/i/FG",  &CSN_AO_FG_PropHandler,                                 0,  0,  &CSN_AO_FG_WriteHandler },
+    { "FA",   "p/RW/i/FA",  &CSN_AO_FA_PropHandler,                                 0,  0,  &CSN_AO_FA_WriteHandler },
+    { "FM",   "p/RW/i/FM",  &CSN_AO_FM_PropHandler,                                 0,  0,  &CSN_AO_FM_WriteHandler },
+    { "FAR", "p/RW/i/FAR", &CSN_AO_FAR_PropHandler,                                 0,  0, &CSN_AO_FAR_WriteHandler },
+    { "FU",   "p/RW/i/FU",  &CSN_AO_FU_PropHandler,                                 0,  0,  &CSN_AO_FU_WriteHandler },
+    // Writes are handled by CSN_AO_CaptureRequest which needs request token.
+    { "EV",   "p/RW/i/EV",  &CSN_AO_EV_PropHandler,                                 0,  0 }
 };
 
-static bhy_data_vector_t orientation = { 0 };
-static bhy_data_vector_t gravity = { 0 };
-static bhy_data_vector_t lin_accel = { 0 };
-static bhy_data_vector_t rate_of_rotation = { 0 };
-static bhy_data_vector_t magnetic_field = { 0 };
+/** \brief Lookup table from property name to index into ao_prop. */
+static struct CS_NameIndex_Struct ao_prop_index;
 
 static uint32_t ao_enabled_sensors = 0;
 
+/** \brief Indexes of virtual sensors used by AO node. */
+enum CSN_AO_Sensor_Index
+{
+	CSN_AO_SENSOR_ORIENTATION = 0,
+	CSN_AO_SENSOR_GRAVITY,
+	CSN_AO_SENSOR_LIN_ACCEL,
+	CSN_AO_SENSOR_MAGNETIC_FIELD,
+	CSN_AO_SENSOR_RATE_OF_ROTATION,
+	CSN_AO_SENSOR_CNT
+};
+
+struct CSN_AO_Sample_Struct
+{
+	/** \brief Extended BHI160 timestamp of the sample. */
+	uint64_t timestamp;
+
+	int16_t v[3];
+};
+
+/** \brief Ring buffer of latest samples of single virtual sensor.
+ *
+ * Sample with sequence number n is stored at index n & CSN_AO_HISTORY_MASK
+ * and is available while it is one of the last CSN_LP_AO_HISTORY_SIZE
+ * samples.
+ */
+struct CSN_AO_History_Struct
+{
+	/** \brief Sequence number of the next sample. */
+	uint32_t seq;
+
+	struct CSN_AO_Sample_Struct sample[CSN_LP_AO_HISTORY_SIZE];
+};
+
+static struct CSN_AO_History_Struct ao_history[CSN_AO_SENSOR_CNT];
+
+/** \brief BHI160 virtual sensor of each sensor index. */
+static const enum BHI160_NDOF_Sensor ao_sensor_id[CSN_AO_SENSOR_CNT] = {
+	BHI160_NDOF_S_ORIENTATION,
+	BHI160_NDOF_S_GRAVITY,
+	BHI160_NDOF_S_LINEAR_ACCELERATION,
+	BHI160_NDOF_S_MAGNETIC_FIELD,
+	BHI160_NDOF_S_RATE_OF_ROTATION
+};
+
+/** \brief Sample rate of each virtual sensor in Hz. */
+static uint16_t ao_rate[CSN_AO_SENSOR_CNT] = {
+	CSN_LP_AO_SAMPLE_RATE,
+	CSN_LP_AO_SAMPLE_RATE,
+	CSN_LP_AO_SAMPLE_RATE,
+	CSN_LP_AO_SAMPLE_RATE,
+	CSN_LP_AO_SAMPLE_RATE
+};
+
+/** \brief RTC time of the last property read of each virtual sensor. */
+static uint64_t ao_last_read[CSN_AO_SENSOR_CNT];
+
+/** \brief Disables virtual sensors that were not read for
+ * CSN_LP_AO_IDLE_TIMEOUT. */
+static struct stimer ao_idle_timer;
+
+/** \brief AO node does not hold BHI160 in normal power mode. */
+static bool ao_is_suspended = true;
+
+/** \brief Latest sample of a virtual sensor converted to 0.01 of the output
+ * unit.
+ */
+struct CSN_AO_Value_Struct
+{
+	int32_t v[3];
+	uint8_t status;
+};
+
+static struct CSN_AO_Value_Struct ao_value[CSN_AO_SENSOR_CNT];
+
+/** \brief Q24 factors converting raw values of each virtual sensor to 0.01 of
+ * the output unit.
+ *
+ * Updated when BHI160 reports change of dynamic range.
+ */
+static int32_t ao_scale[CSN_AO_SENSOR_CNT];
+
+/** \brief Listener for BHI160 dynamic range changes. */
+static EventCallback_Type ao_range_event;
+
+/** \brief Source of orientation, one of CSN_AO_FUSION_* values. */
+static uint8_t ao_fusion = CSN_LP_AO_FUSION;
+
+/** \brief State of software fusion filter. */
+static struct Fusion_Q_State ao_fusion_state;
+
+/** \brief Latest raw accelerometer sample used by software fusion. */
+static int16_t ao_fusion_accel[3];
+
+/** \brief Magnetometer history sequence number when software fusion was
+ * started. Older samples are not used.
+ */
+static uint32_t ao_fusion_mag_seq;
+
+/** \brief Extended timestamp up to which gyroscope samples were integrated
+ * by software fusion, 0 if there was none yet.
+ */
+static uint64_t ao_fusion_timestamp = 0;
+
+/** \brief Q24 factor converting raw angular rate to rad/s in Q16. */
+static int32_t ao_fusion_gyro_scale;
+
+/** \brief States of event capture reported by EV property. */
+enum CSN_AO_Capture_State
+{
+	CSN_AO_CAPTURE_IDLE = 0,
+	CSN_AO_CAPTURE_ARMED,
+	CSN_AO_CAPTURE_TRIGGERED,
+	CSN_AO_CAPTURE_DONE
+};
+
+/** \brief Types of captured events. */
+enum CSN_AO_Event_Type
+{
+	CSN_AO_EVENT_IMPACT = 1,
+	CSN_AO_EVENT_FREE_FALL
+};
+
+/** \brief Accelerometer samples around impact or free fall event.
+ *
+ * Sample with sequence number n is stored at index n & CSN_AO_CAPTURE_MASK.
+ * After the trigger, recording continues until CSN_AO_CAPTURE_POST_TRIGGER
+ * samples are stored from the trigger sample on, then the window is frozen
+ * until the host arms the capture again.
+ */
+struct CSN_AO_Capture_Struct
+{
+	/** \brief One of CSN_AO_CAPTURE_* values. */
+	uint8_t state;
+
+	/** \brief One of CSN_AO_EVENT_* values once triggered. */
+	uint8_t event;
+
+	/** \brief Token of the arm request used for event notification. */
+	char token;
+
+	/** \brief Accelerometer is enabled and holds BHI160 in normal mode. */
+	bool is_sampling;
+
+	/** \brief Event notification waits for poll handler. */
+	bool notify;
+
+	/** \brief Number of consecutive samples below free fall threshold. */
+	uint32_t free_fall_cnt;
+
+	/** \brief Sequence number of the next sample. */
+	uint32_t seq;
+
+	/** \brief Sequence number of the trigger sample. */
+	uint32_t trigger_seq;
+
+	struct CSN_AO_Sample_Struct sample[CSN_LP_AO_CAPTURE_SIZE];
+};
+
+static struct CSN_AO_Capture_Struct ao_capture = { 0 };
+
+/** \brief Squared impact and free fall thresholds in raw accelerometer units.
+ *
+ * Updated when BHI160 reports change of dynamic range.
+ */
+static uint32_t ao_impact_threshold;
+static uint32_t ao_free_fall_threshold;
+
+/** \brief State of extending 32-bit BHI160 timestamps of one FIFO. */
+struct CSN_AO_Timestamp_Struct
+{
+	/** \brief Upper 32 bits of extended timestamp. */
+	uint64_t high;
+
+	/** \brief Newest timestamp seen so far. */
+	uint32_t last;
+
+	/** \brief At least one timestamp was extended. */
+	bool is_valid;
+};
+
+/** \brief Extension of wakeup FIFO timestamps used by AO virtual sensors. */
+static struct CSN_AO_Timestamp_Struct ao_timestamp = { 0 };
+
+/** \brief Extension of non-wakeup FIFO timestamps used by event capture. */
+static struct CSN_AO_Timestamp_Struct ao_capture_timestamp = { 0 };
+
+/** \brief Samples delivered by single drain of BHI160 FIFO. */
+struct CSN_AO_Batch_Struct
+{
+	/** \brief Number of samples of all virtual sensors. */
+	uint32_t sample_cnt;
+
+	/** \brief BHI160 timestamp of the first sample. */
+	uint32_t first_timestamp;
+
+	/** \brief BHI160 timestamp of the last sample. */
+	uint32_t last_timestamp;
+};
+
+/** \brief Batch that is being collected from FIFO. */
+static struct CSN_AO_Batch_Struct ao_batch = { 0 };
+
+/** \brief Last complete batch. */
+static struct CSN_AO_Batch_Struct ao_last_batch = { 0 };
+
+/** \brief Listener for BHI160 FIFO drain events. */
+static EventCallback_Type ao_batch_event;
+
+/** \brief State of counters when the first virtual sensor was enabled. */
+static uint64_t ao_stream_start_time = 0;
+static uint32_t ao_stream_start_irq_cnt = 0;
+static uint32_t ao_stream_sample_cnt = 0;
+
 //-----------------------------------------------------------------------------
 // FUNCTION DEFINITIONS
 //-----------------------------------------------------------------------------
 
-struct CS_Node_Struct* CSN_LP_AO_Create(void)
+struct CS_Node_Struct* CSN_LP_AO_Create(struct stimer_ctx* ctx)
 {
     int32_t errcode = 0;
 
+    stimer_init(&ao_idle_timer, ctx);
+    stimer_set_slack_ms(&ao_idle_timer, CSN_AO_TIMER_SLACK_MS);
+    ao_node.poll_timer = &ao_idle_timer;
+
+    CS_NameIndexInit(&ao_prop_index);
+    for (int i = 0; i < CSN_AO_PROP_CNT; ++i)
+    {
+        if (CS_NameIndexAdd(&ao_prop_index, ao_prop[i].name, i) != CS_OK)
+        {
+            CSN_AO_Error("Failed to index property '%s'.", ao_prop[i].name);
+            return NULL;
+        }
+    }
+
     errcode = BHI160_NDOF_Initialize();
     if (errcode == BHY_SUCCESS)
     {
@@ -166,9 +540,32 @@ struct CS_Node_Struct* CSN_LP_AO_Create(void)
                 VS_WAKEUP, CSN_AO_SensorCallback);
         errcode += bhy_install_sensor_callback(BHI160_NDOF_S_RATE_OF_ROTATION,
                 VS_WAKEUP, CSN_AO_SensorCallback);
+        errcode += bhy_install_sensor_callback(BHI160_NDOF_S_ACCELEROMETER,
+                VS_WAKEUP, CSN_AO_SensorCallback);
+
+        // Non-wakeup instance of accelerometer is used by event capture
+        // independently of the rate of software fusion.
+        errcode += bhy_install_sensor_callback(BHI160_NDOF_S_ACCELEROMETER,
+                VS_NON_WAKEUP, CSN_AO_CaptureCallback);
+
+        if (CSN_LP_AO_FIFO_WATERMARK > 0)
+        {
+            errcode += BHI160_NDOF_SetFifoWatermark(CSN_LP_AO_FIFO_WATERMARK);
+        }
 
         if (errcode == BHY_SUCCESS)
         {
+            EventCallback_Init(&ao_batch_event,
+                    RTE_HB_BHI160_NDOF_FIFO_EVENT_ID, &CSN_AO_BatchCallback,
+                    NULL);
+            EventCallback_Register(&ao_batch_event);
+
+            CSN_AO_UpdateScales(NULL);
+            EventCallback_Init(&ao_range_event,
+                    RTE_HB_BHI160_NDOF_RANGE_EVENT_ID, &CSN_AO_UpdateScales,
+                    NULL);
+            EventCallback_Register(&ao_range_event);
+
             return &ao_node;
         }
         else
@@ -185,66 +582,367 @@ struct CS_Node_Struct* CSN_LP_AO_Create(void)
     return NULL;
 }
 
+/** \brief Converts raw sensor value using Q24 scale factor. */
+static inline int32_t CSN_AO_Convert(int16_t raw, int32_t scale)
+{
+    return (int32_t) (((int64_t) raw * scale + (1 << 23)) >> 24);
+}
+
+/** \brief Recomputes conversion factors from current dynamic ranges. */
+static void CSN_AO_UpdateScales(void *arg)
+{
+    const int32_t accel = BHI160_NDOF_GetAccelDynamicRange()
+            * CSN_AO_SCALE_PER_G;
+
+    ao_scale[CSN_AO_SENSOR_ORIENTATION] = CSN_AO_SCALE_ORIENTATION;
+    ao_scale[CSN_AO_SENSOR_GRAVITY] = accel;
+    ao_scale[CSN_AO_SENSOR_LIN_ACCEL] = accel;
+    ao_scale[CSN_AO_SENSOR_MAGNETIC_FIELD] = BHI160_NDOF_GetMagDynamicRange()
+            * CSN_AO_SCALE_PER_RANGE;
+    ao_scale[CSN_AO_SENSOR_RATE_OF_ROTATION] =
+            BHI160_NDOF_GetGyroDynamicRange() * CSN_AO_SCALE_PER_RANGE;
+    ao_fusion_gyro_scale = BHI160_NDOF_GetGyroDynamicRange()
+            * CSN_AO_SCALE_GYRO_RAD;
+
+    ao_impact_threshold = CSN_AO_Threshold(CSN_LP_AO_IMPACT_THRESHOLD,
+            BHI160_NDOF_GetAccelDynamicRange());
+    ao_free_fall_threshold = CSN_AO_Threshold(CSN_LP_AO_FREE_FALL_THRESHOLD,
+            BHI160_NDOF_GetAccelDynamicRange());
+}
+
+/** \brief Converts acceleration magnitude in mg to squared raw accelerometer
+ * value for dynamic range in g.
+ */
+static uint32_t CSN_AO_Threshold(uint32_t mg, uint32_t range)
+{
+    const uint64_t raw = ((uint64_t) mg * 32768) / (range * 1000);
+
+    return (raw * raw > UINT32_MAX) ? UINT32_MAX : (uint32_t) (raw * raw);
+}
+
+/** \brief Extends 32-bit BHI160 timestamp so that history does not wrap.
+ *
+ * Samples of different virtual sensors may arrive slightly out of order, so
+ * only a backward jump of more than half of the 32-bit range is counted as
+ * a wrap. Older timestamps do not move the newest one back.
+ */
+static uint64_t CSN_AO_ExtendTimestamp(struct CSN_AO_Timestamp_Struct* t,
+        uint32_t timestamp)
+{
+    if (t->is_valid == false)
+    {
+        t->is_valid = true;
+        t->last = timestamp;
+    }
+
+    if ((int32_t) (timestamp - t->last) >= 0)
+    {
+        // Newer sample, possibly after the counter wrapped.
+        if (timestamp < t->last)
+        {
+            t->high += (uint64_t) 1 << 32;
+        }
+        t->last = timestamp;
+    }
+    else if (timestamp > t->last && t->high > 0)
+    {
+        // Older sample from before the last wrap.
+        return (t->high - ((uint64_t) 1 << 32)) | timestamp;
+    }
+
+    return t->high | timestamp;
+}
+
+/** \brief Returns extended timestamp of the AO virtual sensor sample that is
+ * being delivered by BHI160 and counts the sample into current batch.
+ */
+static uint64_t CSN_AO_SampleTimestamp(void)
+{
+    const uint32_t timestamp = BHI160_NDOF_GetWakeupTimestamp();
+
+    if (ao_batch.sample_cnt == 0)
+    {
+        ao_batch.first_timestamp = timestamp;
+    }
+    ao_batch.last_timestamp = timestamp;
+    ao_batch.sample_cnt += 1;
+
+    return CSN_AO_ExtendTimestamp(&ao_timestamp, timestamp);
+}
+
 static void CSN_AO_SensorCallback(bhy_data_generic_t *data,
         bhy_virtual_sensor_t sensor)
 {
+    const uint64_t timestamp = CSN_AO_SampleTimestamp();
+    int idx = -1;
+
     switch ((int) sensor)
     {
     case VS_ID_GRAVITY:
     case VS_ID_GRAVITY_WAKEUP:
-        memcpy(&gravity, &data->data_vector, sizeof(bhy_data_vector_t));
+        idx = CSN_AO_SENSOR_GRAVITY;
         break;
     case VS_ID_LINEAR_ACCELERATION:
     case VS_ID_LINEAR_ACCELERATION_WAKEUP:
-        memcpy(&lin_accel, &data->data_vector, sizeof(bhy_data_vector_t));
+        idx = CSN_AO_SENSOR_LIN_ACCEL;
         break;
     case VS_ID_MAGNETOMETER:
     case VS_ID_MAGNETOMETER_WAKEUP:
-        memcpy(&magnetic_field, &data->data_vector, sizeof(bhy_data_vector_t));
+        idx = CSN_AO_SENSOR_MAGNETIC_FIELD;
         break;
     case VS_ID_ORIENTATION:
     case VS_ID_ORIENTATION_WAKEUP:
-        memcpy(&orientation, &data->data_vector, sizeof(bhy_data_vector_t));
+        idx = CSN_AO_SENSOR_ORIENTATION;
         break;
     case VS_ID_GYROSCOPE:
     case VS_ID_GYROSCOPE_WAKEUP:
-        memcpy(&rate_of_rotation, &data->data_vector, sizeof(bhy_data_vector_t));
+        idx = CSN_AO_SENSOR_RATE_OF_ROTATION;
+        break;
+    case VS_ID_ACCELEROMETER:
+    case VS_ID_ACCELEROMETER_WAKEUP:
+        // Enabled only as input of software fusion.
+        ao_fusion_accel[0] = data->data_vector.x;
+        ao_fusion_accel[1] = data->data_vector.y;
+        ao_fusion_accel[2] = data->data_vector.z;
         break;
     default:
         CSN_AO_Warn("Unknown virtual sensor type: %d", sensor);
         break;
     }
+
+    if (idx >= 0)
+    {
+        struct CSN_AO_Value_Struct* value = &ao_value[idx];
+        struct CSN_AO_History_Struct* h = &ao_history[idx];
+        struct CSN_AO_Sample_Struct* s =
+                &h->sample[h->seq & CSN_AO_HISTORY_MASK];
+
+        s->timestamp = timestamp;
+        s->v[0] = data->data_vector.x;
+        s->v[1] = data->data_vector.y;
+        s->v[2] = data->data_vector.z;
+        h->seq += 1;
+
+        // Convert once per sample so that property reads only format values.
+        value->v[0] = CSN_AO_Convert(data->data_vector.x, ao_scale[idx]);
+        value->v[1] = CSN_AO_Convert(data->data_vector.y, ao_scale[idx]);
+        value->v[2] = CSN_AO_Convert(data->data_vector.z, ao_scale[idx]);
+        value->status = data->data_vector.status;
+
+        if (idx == CSN_AO_SENSOR_RATE_OF_ROTATION
+            && ao_fusion == CSN_AO_FUSION_SOFTWARE
+            && (ao_enabled_sensors & (1 << BHI160_NDOF_S_ORIENTATION)) != 0)
+        {
+            CSN_AO_FusionUpdate(s->timestamp, s->v, value->status);
+        }
+    }
+}
+
+/** \brief Records accelerometer sample of armed event capture and checks it
+ * for impact or free fall.
+ */
+static void CSN_AO_CaptureCallback(bhy_data_generic_t *data,
+        bhy_virtual_sensor_t sensor)
+{
+    // Capture accelerometer is batched in non-wakeup FIFO, its samples are
+    // not part of AO streaming statistics.
+    const uint64_t timestamp = CSN_AO_ExtendTimestamp(&ao_capture_timestamp,
+            BHI160_NDOF_GetTimestamp());
+    struct CSN_AO_Capture_Struct* c = &ao_capture;
+    struct CSN_AO_Sample_Struct* s;
+    uint32_t magnitude;
+
+    if (c->state != CSN_AO_CAPTURE_ARMED
+        && c->state != CSN_AO_CAPTURE_TRIGGERED)
+    {
+        return;
+    }
+
+    s = &c->sample[c->seq & CSN_AO_CAPTURE_MASK];
+    s->timestamp = timestamp;
+    s->v[0] = data->data_vector.x;
+    s->v[1] = data->data_vector.y;
+    s->v[2] = data->data_vector.z;
+    c->seq += 1;
+
+    if (c->state == CSN_AO_CAPTURE_ARMED)
+    {
+        // Squares of int16 values fit into int32, their sum into uint32.
+        magnitude = (uint32_t) (s->v[0] * s->v[0])
+                + (uint32_t) (s->v[1] * s->v[1])
+                + (uint32_t) (s->v[2] * s->v[2]);
+
+        if (magnitude >= ao_impact_threshold)
+        {
+            c->event = CSN_AO_EVENT_IMPACT;
+            c->trigger_seq = c->seq - 1;
+            c->state = CSN_AO_CAPTURE_TRIGGERED;
+        }
+        else if (magnitude <= ao_free_fall_threshold)
+        {
+            c->free_fall_cnt += 1;
+            if (c->free_fall_cnt >= CSN_AO_FREE_FALL_CNT)
+            {
+                // Trigger at the first sample of the fall.
+                c->event = CSN_AO_EVENT_FREE_FALL;
+                c->trigger_seq = c->seq - c->free_fall_cnt;
+                c->state = CSN_AO_CAPTURE_TRIGGERED;
+            }
+        }
+        else
+        {
+            c->free_fall_cnt = 0;
+        }
+    }
+
+    if (c->state == CSN_AO_CAPTURE_TRIGGERED
+        && c->seq - c->trigger_seq >= CSN_AO_CAPTURE_POST_TRIGGER)
+    {
+        c->state = CSN_AO_CAPTURE_DONE;
+        c->notify = true;
+        CS_NotifyNode(&ao_node);
+    }
+}
+
+/** \brief Integrates gyroscope sample by software fusion and stores resulting
+ * orientation as sample of orientation virtual sensor.
+ *
+ * \param timestamp
+ * Extended BHI160 timestamp of the gyroscope sample.
+ *
+ * \param raw
+ * Raw x, y, z angular rate.
+ *
+ * \param status
+ * Accuracy status of the gyroscope sample.
+ */
+static void CSN_AO_FusionUpdate(uint64_t timestamp, const int16_t* raw,
+        uint8_t status)
+{
+    const uint64_t last = ao_fusion_timestamp;
+    uint64_t delta;
+    const struct CSN_AO_History_Struct* mag =
+            &ao_history[CSN_AO_SENSOR_MAGNETIC_FIELD];
+    struct CSN_AO_Value_Struct* value = &ao_value[CSN_AO_SENSOR_ORIENTATION];
+    struct CSN_AO_History_Struct* h = &ao_history[CSN_AO_SENSOR_ORIENTATION];
+    struct CSN_AO_Sample_Struct* s;
+    int32_t gyro[3];
+
+    // Samples drained from FIFO together can share one timestamp. They are
+    // integrated over the configured gyroscope period and the time used up
+    // this way is subtracted from the next sample with a newer timestamp.
+    if (timestamp > last)
+    {
+        delta = timestamp - last;
+    }
+    else
+    {
+        delta = 32000 / ao_rate[CSN_AO_SENSOR_RATE_OF_ROTATION];
+    }
+
+    // Integration starts with the second sample and restarts after gaps
+    // longer than 1 s.
+    ao_fusion_timestamp = last + delta;
+    if (last == 0 || delta >= 32000)
+    {
+        ao_fusion_timestamp = timestamp;
+        return;
+    }
+
+    gyro[0] = CSN_AO_Convert(raw[0], ao_fusion_gyro_scale);
+    gyro[1] = CSN_AO_Convert(raw[1], ao_fusion_gyro_scale);
+    gyro[2] = CSN_AO_Convert(raw[2], ao_fusion_gyro_scale);
+
+    Fusion_Q_Update(&ao_fusion_state, gyro, ao_fusion_accel,
+            (mag->seq != ao_fusion_mag_seq) ?
+                    mag->sample[(mag->seq - 1) & CSN_AO_HISTORY_MASK].v : NULL,
+            (uint32_t) delta * CSN_AO_TIMESTAMP_TO_Q32);
+    Fusion_Q_GetEuler(&ao_fusion_state, value->v);
+    value->status = status;
+
+    // History keeps raw values in units of BHI160 orientation sensor.
+    s = &h->sample[h->seq & CSN_AO_HISTORY_MASK];
+    s->timestamp = timestamp;
+    s->v[0] = (int16_t) (value->v[0] * 32768 / 36000);
+    s->v[1] = (int16_t) (value->v[1] * 32768 / 36000);
+    s->v[2] = (int16_t) (value->v[2] * 32768 / 36000);
+    h->seq += 1;
+}
+
+/** \brief Closes batch of samples collected during last FIFO drain. */
+static void CSN_AO_BatchCallback(void *arg)
+{
+    if (ao_batch.sample_cnt > 0)
+    {
+        ao_last_batch = ao_batch;
+        ao_stream_sample_cnt += ao_batch.sample_cnt;
+        memset(&ao_batch, 0, sizeof(ao_batch));
+
+        CSN_AO_Verbose("Batch of %lu samples (ts=%lu..%lu)",
+                ao_last_batch.sample_cnt, ao_last_batch.first_timestamp,
+                ao_last_batch.last_timestamp);
+    }
 }
 
 static int CSN_LP_AO_RequestHandler(const struct CS_Request_Struct* request,
         char* response)
 {
+    // Sample history read
+    if (strcmp(request->property, "S") == 0
+        && request->property_value != NULL)
+    {
+        return CSN_AO_HistoryRequest(request, response);
+    }
+
+    // Event capture arm or stop
+    if (strcmp(request->property, "EV") == 0
+        && request->property_value != NULL)
+    {
+        return CSN_AO_CaptureRequest(request, response);
+    }
+
+    // AO Data property requests
+    int i = CS_NameIndexFind(&ao_prop_index, request->property,
+            request->property_hash);
+
     // Check request type
     if (request->property_value != NULL)
     {
-        CSN_AO_Error("AO properties support only read requests.");
+        if (i >= 0 && ao_prop[i].write_callback != NULL)
+        {
+            return ao_prop[i].write_callback(request->property_value,
+                    response);
+        }
+
+        CSN_AO_Error("AO property '%s' supports only read requests.",
+                request->property);
         sprintf(response, "e/ACCESS");
         return CS_OK;
     }
 
-    // AO Data property requests
-    for (int i = 0; i < CSN_AO_PROP_CNT; ++i)
+    if (i >= 0)
     {
-        if (strcmp(request->property, ao_prop[i].name) == 0)
+        // Wake up the sensor chip
+        CSN_LP_AO_PowerModeHandler(CS_POWER_MODE_NORMAL);
+
+        // Check for idle sensors once the timeout elapses.
+        if (CSN_LP_AO_IDLE_TIMEOUT > 0 && ao_idle_timer.is_running == false)
         {
-            // Wake up the sensor chip
-            CSN_LP_AO_PowerModeHandler(CS_POWER_MODE_NORMAL);
+            stimer_expire_from_now_s(&ao_idle_timer, CSN_LP_AO_IDLE_TIMEOUT);
+        }
 
-            // Enable respective virtual sensor
+        // Enable respective virtual sensor
+        if (ao_prop[i].required_sensor != 0)
+        {
             CSN_LP_AO_EnableVirtualSensor(ao_prop[i].required_sensor);
+        }
 
-            // Fill response with latest data
-            if (ao_prop[i].callback(response) != CS_OK)
-            {
-                sprintf(response, "e/NODE_ERR");
-            }
-            return CS_OK;
+        // Fill response with latest data
+        if (ao_prop[i].callback(response) != CS_OK)
+        {
+            sprintf(response, "e/NODE_ERR");
         }
+        return CS_OK;
     }
 
     // PROP property request
@@ -276,7 +974,15 @@ static int CSN_LP_AO_RequestHandler(const struct CS_Request_Struct* request,
             int prop_index = atoi(&request->property[4]);
             if (prop_index >= 0 && prop_index < CSN_AO_PROP_CNT)
             {
-                sprintf(response, "n/%s", ao_prop[prop_index].prop_def);
+                if (CS_IsBinaryEncoding())
+                {
+                    sprintf(response, "n/%s/%d", ao_prop[prop_index].prop_def,
+                            ao_prop[prop_index].exponent);
+                }
+                else
+                {
+                    sprintf(response, "n/%s", ao_prop[prop_index].prop_def);
+                }
                 return CS_OK;
             }
             else
@@ -298,32 +1004,35 @@ static int CSN_LP_AO_RequestHandler(const struct CS_Request_Struct* request,
 
 static int CSN_LP_AO_PowerModeHandler(enum CS_PowerMode mode)
 {
-    static bool is_suspended = true;
     int32_t errcode = BHY_SUCCESS;
 
     switch (mode)
     {
     case CS_POWER_MODE_NORMAL:
-        if (is_suspended)
+        if (ao_is_suspended)
         {
-            errcode = BHI160_NDOF_SetPowerMode(BHI160_NDOF_PM_NORMAL);
+            errcode = BHI160_NDOF_AcquireNormalMode();
             if (errcode != BHY_SUCCESS)
             {
                 return CS_ERROR;
             }
 
-            is_suspended = false;
+            ao_is_suspended = false;
             CSN_AO_Info("Entered NORMAL power mode.");
         }
         break;
 
     case CS_POWER_MODE_SLEEP:
+        stimer_stop(&ao_idle_timer);
+
         // Disable all virtual sensors
         errcode = bhy_disable_virtual_sensor(BHI160_NDOF_S_GRAVITY, VS_WAKEUP);
         errcode += bhy_disable_virtual_sensor(BHI160_NDOF_S_LINEAR_ACCELERATION, VS_WAKEUP);
         errcode += bhy_disable_virtual_sensor(BHI160_NDOF_S_MAGNETIC_FIELD, VS_WAKEUP);
         errcode += bhy_disable_virtual_sensor(BHI160_NDOF_S_ORIENTATION, VS_WAKEUP);
         errcode += bhy_disable_virtual_sensor(BHI160_NDOF_S_RATE_OF_ROTATION, VS_WAKEUP);
+        errcode += bhy_disable_virtual_sensor(BHI160_NDOF_S_ACCELEROMETER, VS_WAKEUP);
+        errcode += CSN_AO_CaptureStop();
 
         ao_enabled_sensors = 0;
         if (errcode != BHY_SUCCESS)
@@ -331,20 +1040,20 @@ static int CSN_LP_AO_PowerModeHandler(enum CS_PowerMode mode)
             return CS_ERROR;
         }
 
-        // Put chip into standby mode
-        is_suspended = true;
-        errcode = BHI160_NDOF_SetPowerMode(BHI160_NDOF_PM_STANDBY);
-        if (errcode != BHY_SUCCESS)
+        // Put chip into standby mode unless other user needs it.
+        if (ao_is_suspended == false)
         {
-            return CS_ERROR;
+            ao_is_suspended = true;
+            errcode = BHI160_NDOF_ReleaseNormalMode();
+            if (errcode != BHY_SUCCESS)
+            {
+                return CS_ERROR;
+            }
         }
 
         // Reset all sensor data.
-        memset(&orientation, 0, sizeof(orientation));
-        memset(&gravity, 0, sizeof(gravity));
-        memset(&lin_accel, 0, sizeof(lin_accel));
-        memset(&rate_of_rotation, 0, sizeof(rate_of_rotation));
-        memset(&magnetic_field, 0, sizeof(magnetic_field));
+        memset(ao_value, 0, sizeof(ao_value));
+        memset(ao_history, 0, sizeof(ao_history));
 
         CSN_AO_Info("Entered STANDBY power mode.");
         break;
@@ -353,224 +1062,1057 @@ static int CSN_LP_AO_PowerModeHandler(enum CS_PowerMode mode)
     return CS_OK;
 }
 
-static void CSN_LP_AO_PollHandler(void)
+/** \brief Sends samples from history of one virtual sensor.
+ *
+ * Request value has format "<property>/<seq>[/<count>]", e.g.
+ * "5/AO/S/G/120/16" requests up to 16 gravity vector samples starting with
+ * sample number 120. Property can be any property of the virtual sensor,
+ * e.g. G or GX. Samples are recorded only while the virtual sensor is enabled
+ * by reading one of its properties.
+ *
+ * Response is available only with binary encoding.
+ * The first packet contains int32 values: sequence number of the first sent
+ * sample, number of sent samples and timestamp of the first sample in ms.
+ * If requested samples were already overwritten, sending starts with the
+ * oldest available sample.
+ * Following packets contain two samples each as int16 values: time since
+ * previous sample in ms followed by raw x, y, z values of the sample.
+ *
+ * Property EV reads window of event capture instead, e.g. "5/AO/S/EV/0/16".
+ * Samples are numbered from the first sample of the window and none are
+ * available until the window is captured.
+ */
+static int CSN_AO_HistoryRequest(const struct CS_Request_Struct* request,
+        char* response)
 {
+    char name[4];
+    const char* c = request->property_value;
+    const struct CSN_AO_History_Struct* h;
+    uint32_t seq;
+    uint32_t count;
+    int i;
+
+    if (CS_IsBinaryEncoding() == 0)
+    {
+        sprintf(response, "e/ENC");
+        return CS_OK;
+    }
 
-}
-
-static void CSN_LP_AO_EnableVirtualSensor(enum BHI160_NDOF_Sensor sensor)
-{
-    int32_t errcode;
+    // Parse property name.
+    for (i = 0; *c != '/' && *c != '\0' && i < 3; ++i)
+    {
+        name[i] = *c++;
+    }
+    name[i] = '\0';
 
-    if ((ao_enabled_sensors & (1 << sensor)) == 0)
+    if (*c != '/' || isdigit((int) c[1]) == 0)
     {
-        errcode = bhy_enable_virtual_sensor(sensor, VS_WAKEUP,
-                CSN_LP_AO_SAMPLE_RATE, 0, VS_FLUSH_NONE, 0, 0);
-        if (errcode != BHY_SUCCESS)
-        {
-            CSN_AO_Error("Failed to enable virtual sensor %d (err=%d)", sensor,
-                    errcode);
-        }
-        else
-        {
-            CSN_AO_Verbose("Enabled virtual sensor: %d", sensor);
-        }
+        sprintf(response, "e/INV_VALUE");
+        return CS_OK;
+    }
+    seq = strtoul(c + 1, (char**) &c, 10);
+    count = CSN_LP_AO_HISTORY_MAX_READ;
+    if (*c == '/')
+    {
+        count = strtoul(c + 1, NULL, 10);
+    }
 
-        // sensor IDs range from 1 up to 31
-        ao_enabled_sensors |= (1 << sensor);
+    if (strcmp(name, "EV") == 0)
+    {
+        CSN_AO_CaptureRead(request->token[0], seq, count);
+        return CS_NO_RESPONSE;
     }
-}
 
-static int CSN_AO_C_PropHandler(char* response)
-{
-    sprintf(response, "h/%X%X%X%X", 0, gravity.status, rate_of_rotation.status,
-            magnetic_field.status);
-    return CS_OK;
-}
+    i = CS_NameIndexFind(&ao_prop_index, name, CS_NameHash(name));
+    if (i < 0 || ao_prop[i].required_sensor == 0)
+    {
+        sprintf(response, "e/UNK_PROP");
+        return CS_OK;
+    }
 
-static int CSN_AO_O_PropHandler(char* response)
-{
-    snprintf(response, 19, "%d,%d,%d",
-            (int) (orientation.x / 32768.0f * 360.0f * 10.0f),
-            (int) (orientation.y / 32768.0f * 360.0f * 10.0f),
-            (int) (orientation.z / 32768.0f * 360.0f * 10.0f));
+    i = CSN_AO_FindSensor(ao_prop[i].required_sensor);
+    h = &ao_history[i];
 
-    return CS_OK;
-}
+    // Reading history of enabled sensor keeps it from being disabled as idle.
+    if ((ao_enabled_sensors & (1 << ao_sensor_id[i])) != 0)
+    {
+        ao_last_read[i] = HAL_RTC_GetTime64();
+    }
 
-static int CSN_AO_G_PropHandler(char* response)
+    // Limit request to available samples.
+    if (seq > h->seq)
+    {
+        seq = h->seq;
+    }
+    if (h->seq - seq > CSN_LP_AO_HISTORY_SIZE)
+    {
+        seq = h->seq - CSN_LP_AO_HISTORY_SIZE;
+    }
+    if (count > h->seq - seq)
+    {
+        count = h->seq - seq;
+    }
+    if (count > CSN_LP_AO_HISTORY_MAX_READ)
+    {
+        count = CSN_LP_AO_HISTORY_MAX_READ;
+    }
+
+    CSN_AO_SendSamples(request->token[0], h->sample, CSN_AO_HISTORY_MASK, seq,
+            seq, count);
+
+    return CS_NO_RESPONSE;
+}
+
+/** \brief Sends header packet and sample packets of history read request.
+ *
+ * \param token
+ * Token of the request.
+ *
+ * \param sample
+ * Ring buffer of samples.
+ *
+ * \param mask
+ * Mask converting sequence number to index into \p sample.
+ *
+ * \param seq
+ * Sequence number of the first sent sample.
+ *
+ * \param index
+ * Number of the first sent sample reported in header packet.
+ *
+ * \param count
+ * Number of samples to send.
+ */
+static void CSN_AO_SendSamples(char token,
+        const struct CSN_AO_Sample_Struct* sample, uint32_t mask, uint32_t seq,
+        uint32_t index, uint32_t count)
+{
+    char packet[21];
+    const struct CSN_AO_Sample_Struct* s;
+    uint64_t prev_timestamp;
+    int16_t v[8];
+    int n = 0;
+
+    packet[0] = token;
+    packet[1] = '/';
+
+    s = &sample[seq & mask];
+    prev_timestamp = (count > 0) ? s->timestamp : 0;
+    {
+        const int32_t header[3] = {
+                (int32_t) index,
+                (int32_t) count,
+                (int32_t) CSN_AO_TIMESTAMP_TO_MS(prev_timestamp)
+        };
+
+        CS_EncodeInt32(&packet[2], header, 3);
+        CS_InjectResponse(packet);
+    }
+
+    for (uint32_t k = 0; k < count; ++k)
+    {
+        s = &sample[(seq + k) & mask];
+
+        v[n++] = (int16_t) (CSN_AO_TIMESTAMP_TO_MS(s->timestamp)
+                - CSN_AO_TIMESTAMP_TO_MS(prev_timestamp));
+        v[n++] = s->v[0];
+        v[n++] = s->v[1];
+        v[n++] = s->v[2];
+        prev_timestamp = s->timestamp;
+
+        if (n == 8 || k + 1 == count)
+        {
+            CS_EncodeInt16(&packet[2], v, n);
+            CS_InjectResponse(packet);
+            n = 0;
+        }
+    }
+}
+
+static void CSN_LP_AO_PollHandler(void)
+{
+    if (ao_capture.notify)
+    {
+        ao_capture.notify = false;
+        CSN_AO_CaptureNotify();
+    }
+
+    if (ao_idle_timer.is_running && stimer_is_expired(&ao_idle_timer))
+    {
+        CSN_AO_DisableIdleSensors();
+    }
+}
+
+static void CSN_LP_AO_EnableVirtualSensor(enum BHI160_NDOF_Sensor sensor)
+{
+    const int idx = CSN_AO_FindSensor(sensor);
+    int32_t errcode;
+
+    ao_last_read[idx] = HAL_RTC_GetTime64();
+
+    // Software fusion needs gyroscope and magnetometer, reading orientation
+    // keeps them from being disabled as idle.
+    if (idx == CSN_AO_SENSOR_ORIENTATION && ao_fusion == CSN_AO_FUSION_SOFTWARE)
+    {
+        CSN_LP_AO_EnableVirtualSensor(BHI160_NDOF_S_RATE_OF_ROTATION);
+        CSN_LP_AO_EnableVirtualSensor(BHI160_NDOF_S_MAGNETIC_FIELD);
+    }
+
+    if ((ao_enabled_sensors & (1 << sensor)) == 0)
+    {
+        if (ao_enabled_sensors == 0)
+        {
+            // Start of streaming, reset statistics.
+            ao_stream_start_time = HAL_RTC_GetTime64();
+            ao_stream_start_irq_cnt = BHI160_NDOF_GetFifoStats()->irq_cnt;
+            ao_stream_sample_cnt = 0;
+        }
+
+        if (idx == CSN_AO_SENSOR_ORIENTATION
+            && ao_fusion == CSN_AO_FUSION_SOFTWARE)
+        {
+            Fusion_Q_Init(&ao_fusion_state, CSN_AO_FUSION_KP,
+                    CSN_AO_FUSION_KI);
+            memset(ao_fusion_accel, 0, sizeof(ao_fusion_accel));
+            ao_fusion_mag_seq = ao_history[CSN_AO_SENSOR_MAGNETIC_FIELD].seq;
+            ao_fusion_timestamp = 0;
+        }
+
+        errcode = CSN_AO_SetVirtualSensor(idx, true);
+        if (errcode != BHY_SUCCESS)
+        {
+            CSN_AO_Error("Failed to enable virtual sensor %d (err=%d)", sensor,
+                    errcode);
+        }
+        else
+        {
+            CSN_AO_Verbose("Enabled virtual sensor: %d", sensor);
+        }
+
+        // sensor IDs range from 1 up to 31
+        ao_enabled_sensors |= (1 << sensor);
+    }
+}
+
+/** \brief Disables virtual sensors that were not read for
+ * CSN_LP_AO_IDLE_TIMEOUT and puts BHI160 into standby mode when no virtual
+ * sensor remains enabled.
+ *
+ * Otherwise the idle timer is restarted to expire when the least recently read
+ * sensor becomes idle.
+ */
+static void CSN_AO_DisableIdleSensors(void)
+{
+    const uint64_t now = HAL_RTC_GetTime64();
+    const uint64_t timeout = HAL_RTC_S_TO_TICKS(
+            (uint64_t) CSN_LP_AO_IDLE_TIMEOUT);
+    uint64_t next = timeout;
+    int32_t errcode;
+
+    stimer_stop(&ao_idle_timer);
+
+    for (int i = 0; i < CSN_AO_SENSOR_CNT; ++i)
+    {
+        const enum BHI160_NDOF_Sensor sensor = ao_sensor_id[i];
+        const uint64_t idle = now - ao_last_read[i];
+
+        if ((ao_enabled_sensors & (1 << sensor)) == 0)
+        {
+            continue;
+        }
+
+        if (idle >= timeout)
+        {
+            errcode = CSN_AO_SetVirtualSensor(i, false);
+            if (errcode != BHY_SUCCESS)
+            {
+                CSN_AO_Error("Failed to disable virtual sensor %d (err=%d)",
+                        sensor, errcode);
+                continue;
+            }
+
+            ao_enabled_sensors &= ~(1 << sensor);
+            CSN_AO_Verbose("Disabled idle virtual sensor: %d", sensor);
+        }
+        else if (timeout - idle < next)
+        {
+            next = timeout - idle;
+        }
+    }
+
+    if (ao_enabled_sensors != 0)
+    {
+        stimer_expire_from_now_ms(&ao_idle_timer,
+                HAL_RTC_TICKS_TO_MS(next) + 1);
+    }
+    else if (ao_is_suspended == false)
+    {
+        // Keep samples and history, the sensors are enabled again on the
+        // next property read.
+        ao_is_suspended = true;
+        errcode = BHI160_NDOF_ReleaseNormalMode();
+        if (errcode != BHY_SUCCESS)
+        {
+            CSN_AO_Error("Failed to enter STANDBY power mode (err=%d)",
+                    errcode);
+        }
+        else
+        {
+            CSN_AO_Info("All virtual sensors idle, entered STANDBY power mode.");
+        }
+    }
+}
+
+/** \brief Returns sensor index of BHI160 virtual sensor used by AO node. */
+static int CSN_AO_FindSensor(enum BHI160_NDOF_Sensor sensor)
+{
+    int i;
+
+    for (i = 0; i < CSN_AO_SENSOR_CNT - 1; ++i)
+    {
+        if (ao_sensor_id[i] == sensor)
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/** \brief Enables or disables BHI160 virtual sensor that provides samples
+ * for sensor index.
+ *
+ * With software fusion the orientation is computed from accelerometer samples
+ * taken at the rate of gyroscope instead of BHI160 orientation sensor.
+ */
+static int32_t CSN_AO_SetVirtualSensor(int idx, bool enable)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetAccelDynamicRange();
+    enum BHI160_NDOF_Sensor sensor = ao_sensor_id[idx];
+    uint16_t rate = ao_rate[idx];
+
+    if (idx == CSN_AO_SENSOR_ORIENTATION && ao_fusion == CSN_AO_FUSION_SOFTWARE)
+    {
+        sensor = BHI160_NDOF_S_ACCELEROMETER;
+        rate = ao_rate[CSN_AO_SENSOR_RATE_OF_ROTATION];
+    }
 
-    snprintf(response, 19, "%d,%d,%d",
-            (int) (gravity.x / 32768.0f * dyn_range * 9.80665f * 100.0f),
-            (int) (gravity.y / 32768.0f * dyn_range * 9.80665f * 100.0f),
-            (int) (gravity.z / 32768.0f * dyn_range * 9.80665f * 100.0f));
+    if (enable)
+    {
+        return bhy_enable_virtual_sensor(sensor, VS_WAKEUP, rate,
+                CSN_LP_AO_REPORT_LATENCY, VS_FLUSH_NONE, 0, 0);
+    }
 
+    return bhy_disable_virtual_sensor(sensor, VS_WAKEUP);
+}
+
+static int CSN_AO_C_PropHandler(char* response)
+{
+    sprintf(response, "h/%X%X%X%X", 0, ao_value[CSN_AO_SENSOR_GRAVITY].status,
+            ao_value[CSN_AO_SENSOR_RATE_OF_ROTATION].status,
+            ao_value[CSN_AO_SENSOR_MAGNETIC_FIELD].status);
     return CS_OK;
 }
 
-static int CSN_AO_A_PropHandler(char* response)
+/** \brief Reports BHI160 interrupt count, sample count and duration in
+ * seconds since the first virtual sensor was enabled.
+ */
+static int CSN_AO_ST_PropHandler(char* response)
+{
+    int32_t v[3] = { 0, 0, 0 };
+
+    if (ao_enabled_sensors != 0)
+    {
+        v[0] = BHI160_NDOF_GetFifoStats()->irq_cnt - ao_stream_start_irq_cnt;
+        v[1] = ao_stream_sample_cnt;
+        v[2] = (HAL_RTC_GetTime64() - ao_stream_start_time) / HAL_RTC_XTAL_FREQ;
+    }
+
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt32(response, v, 3);
+    }
+    else
+    {
+        snprintf(response, 19, "%ld,%ld,%ld", v[0], v[1], v[2]);
+    }
+
+    return CS_OK;
+}
+
+static int CSN_AO_O_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetAccelDynamicRange();
+    CSN_AO_WriteVector(response, ao_value[CSN_AO_SENSOR_ORIENTATION].v, 10);
+
+    return CS_OK;
+}
 
-    snprintf(response, 19, "%d,%d,%d",
-            (int) (lin_accel.x / 32768.0f * dyn_range * 9.80665f * 100.0f),
-            (int) (lin_accel.y / 32768.0f * dyn_range * 9.80665f * 100.0f),
-            (int) (lin_accel.z / 32768.0f * dyn_range * 9.80665f * 100.0f));
+static int CSN_AO_G_PropHandler(char* response)
+{
+    CSN_AO_WriteVector(response, ao_value[CSN_AO_SENSOR_GRAVITY].v, 1);
 
     return CS_OK;
 }
 
-static int CSN_AO_M_PropHandler(char* response)
+static int CSN_AO_A_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetMagDynamicRange();
+    CSN_AO_WriteVector(response, ao_value[CSN_AO_SENSOR_LIN_ACCEL].v, 1);
+
+    return CS_OK;
+}
 
-    snprintf(response, 19, "%d,%d,%d",
-            (int) (magnetic_field.x / 32768.0f * dyn_range * 10.0f),
-            (int) (magnetic_field.y / 32768.0f * dyn_range * 10.0f),
-            (int) (magnetic_field.z / 32768.0f * dyn_range * 10.0f));
+static int CSN_AO_M_PropHandler(char* response)
+{
+    CSN_AO_WriteVector(response, ao_value[CSN_AO_SENSOR_MAGNETIC_FIELD].v, 10);
 
     return CS_OK;
 }
 
 static int CSN_AO_AR_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetGyroDynamicRange();
-
-    snprintf(response, 19, "%d,%d,%d",
-            (int) (rate_of_rotation.x / 32768.0f * dyn_range * 10.0f),
-            (int) (rate_of_rotation.y / 32768.0f * dyn_range * 10.0f),
-            (int) (rate_of_rotation.z / 32768.0f * dyn_range * 10.0f));
+    CSN_AO_WriteVector(response, ao_value[CSN_AO_SENSOR_RATE_OF_ROTATION].v, 10);
 
     return CS_OK;
 }
 
 static int CSN_AO_H_PropHandler(char* response)
 {
-    snprintf(response, 19, "f/%f", orientation.x / 32768.0f * 360.0f);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_ORIENTATION].v[0]);
 
     return CS_OK;
 }
 
 static int CSN_AO_P_PropHandler(char* response)
 {
-    snprintf(response, 19, "f/%f", orientation.y / 32768.0f * 360.0f);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_ORIENTATION].v[1]);
 
     return CS_OK;
 }
 
 static int CSN_AO_R_PropHandler(char* response)
 {
-    snprintf(response, 19, "f/%f", orientation.z / 32768.0f * 360.0f);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_ORIENTATION].v[2]);
 
     return CS_OK;
 }
 
 static int CSN_AO_GX_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetAccelDynamicRange();
-
-    snprintf(response, 19, "f/%f", gravity.x / 32768.0f * 9.80665f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_GRAVITY].v[0]);
 
     return CS_OK;
 }
 
 static int CSN_AO_GY_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetAccelDynamicRange();
-
-    snprintf(response, 19, "f/%f", gravity.y / 32768.0f * 9.80665f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_GRAVITY].v[1]);
 
     return CS_OK;
 }
 
 static int CSN_AO_GZ_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetAccelDynamicRange();
-
-    snprintf(response, 19, "f/%f", gravity.z / 32768.0f * 9.80665f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_GRAVITY].v[2]);
 
     return CS_OK;
 }
 
 static int CSN_AO_AX_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetAccelDynamicRange();
-
-    snprintf(response, 19, "f/%f", lin_accel.x / 32768.0f * 9.80665f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_LIN_ACCEL].v[0]);
 
     return CS_OK;
 }
 
 static int CSN_AO_AY_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetAccelDynamicRange();
-
-    snprintf(response, 19, "f/%f", lin_accel.y / 32768.0f * 9.80665f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_LIN_ACCEL].v[1]);
 
     return CS_OK;
 }
 
 static int CSN_AO_AZ_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetAccelDynamicRange();
-
-    snprintf(response, 19, "f/%f", lin_accel.z / 32768.0f * 9.80665f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_LIN_ACCEL].v[2]);
 
     return CS_OK;
 }
 
 static int CSN_AO_MX_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetMagDynamicRange();
-
-    snprintf(response, 19, "f/%f", magnetic_field.x / 32768.0f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_MAGNETIC_FIELD].v[0]);
 
     return CS_OK;
 }
 
 static int CSN_AO_MY_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetMagDynamicRange();
-
-    snprintf(response, 19, "f/%f", magnetic_field.y / 32768.0f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_MAGNETIC_FIELD].v[1]);
 
     return CS_OK;
 }
 
 static int CSN_AO_MZ_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetMagDynamicRange();
-
-    snprintf(response, 19, "f/%f", magnetic_field.z / 32768.0f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_MAGNETIC_FIELD].v[2]);
 
     return CS_OK;
 }
 
 static int CSN_AO_ARX_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetGyroDynamicRange();
-
-    snprintf(response, 19, "f/%f", rate_of_rotation.x / 32768.0f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_RATE_OF_ROTATION].v[0]);
 
     return CS_OK;
 }
 
 static int CSN_AO_ARY_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetGyroDynamicRange();
-
-    snprintf(response, 19, "f/%f", rate_of_rotation.y / 32768.0f * dyn_range);
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_RATE_OF_ROTATION].v[1]);
 
     return CS_OK;
 }
 
 static int CSN_AO_ARZ_PropHandler(char* response)
 {
-    const uint16_t dyn_range = BHI160_NDOF_GetGyroDynamicRange();
+    CSN_AO_WriteScalar(response, ao_value[CSN_AO_SENSOR_RATE_OF_ROTATION].v[2]);
 
-    snprintf(response, 19, "f/%f", rate_of_rotation.z / 32768.0f * dyn_range);
+    return CS_OK;
+}
+
+static int CSN_AO_FO_PropHandler(char* response)
+{
+    CSN_AO_WriteInteger(response, ao_rate[CSN_AO_SENSOR_ORIENTATION]);
 
     return CS_OK;
 }
+
+static int CSN_AO_FG_PropHandler(char* response)
+{
+    CSN_AO_WriteInteger(response, ao_rate[CSN_AO_SENSOR_GRAVITY]);
+
+    return CS_OK;
+}
+
+static int CSN_AO_FA_PropHandler(char* response)
+{
+    CSN_AO_WriteInteger(response, ao_rate[CSN_AO_SENSOR_LIN_ACCEL]);
+
+    return CS_OK;
+}
+
+static int CSN_AO_FM_PropHandler(char* response)
+{
+    CSN_AO_WriteInteger(response, ao_rate[CSN_AO_SENSOR_MAGNETIC_FIELD]);
+
+    return CS_OK;
+}
+
+static int CSN_AO_FAR_PropHandler(char* response)
+{
+    CSN_AO_WriteInteger(response, ao_rate[CSN_AO_SENSOR_RATE_OF_ROTATION]);
+
+    return CS_OK;
+}
+
+static int CSN_AO_FO_WriteHandler(const char* value, char* response)
+{
+    return CSN_AO_SetRate(CSN_AO_SENSOR_ORIENTATION, value, response);
+}
+
+static int CSN_AO_FG_WriteHandler(const char* value, char* response)
+{
+    return CSN_AO_SetRate(CSN_AO_SENSOR_GRAVITY, value, response);
+}
+
+static int CSN_AO_FA_WriteHandler(const char* value, char* response)
+{
+    return CSN_AO_SetRate(CSN_AO_SENSOR_LIN_ACCEL, value, response);
+}
+
+static int CSN_AO_FM_WriteHandler(const char* value, char* response)
+{
+    return CSN_AO_SetRate(CSN_AO_SENSOR_MAGNETIC_FIELD, value, response);
+}
+
+static int CSN_AO_FAR_WriteHandler(const char* value, char* response)
+{
+    return CSN_AO_SetRate(CSN_AO_SENSOR_RATE_OF_ROTATION, value, response);
+}
+
+static int CSN_AO_FU_PropHandler(char* response)
+{
+    CSN_AO_WriteInteger(response, ao_fusion);
+
+    return CS_OK;
+}
+
+/** \brief Reports state of event capture: 0 - stopped, 1 - armed,
+ * 2 - recording after event, 3 - window captured.
+ */
+static int CSN_AO_EV_PropHandler(char* response)
+{
+    CSN_AO_WriteInteger(response, ao_capture.state);
+
+    return CS_OK;
+}
+
+/** \brief Selects source of orientation.
+ *
+ * Value 0 selects BHI160 fusion and 1 selects software fusion on RSL10.
+ * Enabled orientation sensor is switched to the new source immediately.
+ * Software fusion restarts from the orientation given by the first
+ * accelerometer and magnetometer samples.
+ */
+static int CSN_AO_FU_WriteHandler(const char* value, char* response)
+{
+    const uint8_t prev_fusion = ao_fusion;
+    uint8_t fusion;
+    uint32_t total;
+    int32_t errcode;
+
+    if (strcmp(value, "0") == 0)
+    {
+        fusion = CSN_AO_FUSION_BHI160;
+    }
+    else if (strcmp(value, "1") == 0)
+    {
+        fusion = CSN_AO_FUSION_SOFTWARE;
+    }
+    else
+    {
+        sprintf(response, "e/INV_VALUE");
+        return CS_OK;
+    }
+
+    // Orientation source changes which sensor and rate provide orientation.
+    ao_fusion = fusion;
+    total = CSN_AO_TotalRate(-1, 0);
+    ao_fusion = prev_fusion;
+    if (total > CSN_LP_AO_MAX_TOTAL_RATE)
+    {
+        CSN_AO_Warn("Total sample rate %lu Hz exceeds limit of %d Hz.", total,
+                CSN_LP_AO_MAX_TOTAL_RATE);
+        sprintf(response, "e/INV_VALUE");
+        return CS_OK;
+    }
+
+    if (fusion != ao_fusion
+        && (ao_enabled_sensors & (1 << BHI160_NDOF_S_ORIENTATION)) != 0)
+    {
+        errcode = CSN_AO_SetVirtualSensor(CSN_AO_SENSOR_ORIENTATION, false);
+        if (errcode != BHY_SUCCESS)
+        {
+            CSN_AO_Error("Failed to switch orientation source (err=%d)",
+                    errcode);
+            sprintf(response, "e/NODE_ERR");
+            return CS_OK;
+        }
+
+        ao_enabled_sensors &= ~(1 << BHI160_NDOF_S_ORIENTATION);
+        ao_fusion = fusion;
+        CSN_LP_AO_EnableVirtualSensor(BHI160_NDOF_S_ORIENTATION);
+    }
+
+    ao_fusion = fusion;
+    CSN_AO_Info("Orientation source set to %s fusion.",
+            (fusion == CSN_AO_FUSION_SOFTWARE) ? "software" : "BHI160");
+
+    CSN_AO_WriteInteger(response, ao_fusion);
+    return CS_OK;
+}
+
+/** \brief Changes sample rate of virtual sensor.
+ *
+ * Rate has to be in range 1 to CSN_LP_AO_MAX_SAMPLE_RATE Hz and sum of rates
+ * of all virtual sensors must not exceed CSN_LP_AO_MAX_TOTAL_RATE.
+ * Enabled sensor is reconfigured immediately, otherwise the rate is used when
+ * the sensor is enabled by the next property read.
+ *
+ * \param idx
+ * Sensor index of the virtual sensor.
+ *
+ * \param value
+ * Requested rate in Hz as decimal number.
+ *
+ * \param response
+ * Set to the new rate on success or to error code.
+ */
+static int CSN_AO_SetRate(int idx, const char* value, char* response)
+{
+    const enum BHI160_NDOF_Sensor sensor = ao_sensor_id[idx];
+    const uint16_t prev_rate = ao_rate[idx];
+    uint32_t rate;
+    uint32_t total;
+    int32_t errcode = BHY_SUCCESS;
+
+    for (const char* c = value; *c != '\0'; ++c)
+    {
+        if (isdigit((int) *c) == 0)
+        {
+            sprintf(response, "e/INV_VALUE");
+            return CS_OK;
+        }
+    }
+
+    rate = strtoul(value, NULL, 10);
+    if (*value == '\0' || rate < 1 || rate > CSN_LP_AO_MAX_SAMPLE_RATE)
+    {
+        sprintf(response, "e/INV_VALUE");
+        return CS_OK;
+    }
+
+    total = CSN_AO_TotalRate(idx, rate);
+    if (total > CSN_LP_AO_MAX_TOTAL_RATE)
+    {
+        CSN_AO_Warn("Total sample rate %lu Hz exceeds limit of %d Hz.", total,
+                CSN_LP_AO_MAX_TOTAL_RATE);
+        sprintf(response, "e/INV_VALUE");
+        return CS_OK;
+    }
+
+    ao_rate[idx] = rate;
+    if ((ao_enabled_sensors & (1 << sensor)) != 0)
+    {
+        errcode = CSN_AO_SetVirtualSensor(idx, true);
+    }
+
+    // Accelerometer of software fusion follows the rate of gyroscope.
+    if (errcode == BHY_SUCCESS && idx == CSN_AO_SENSOR_RATE_OF_ROTATION
+        && ao_fusion == CSN_AO_FUSION_SOFTWARE
+        && (ao_enabled_sensors & (1 << BHI160_NDOF_S_ORIENTATION)) != 0)
+    {
+        errcode = CSN_AO_SetVirtualSensor(CSN_AO_SENSOR_ORIENTATION, true);
+    }
+
+    if (errcode != BHY_SUCCESS)
+    {
+        CSN_AO_Error("Failed to change rate of virtual sensor %d (err=%d)",
+                sensor, errcode);
+        ao_rate[idx] = prev_rate;
+        sprintf(response, "e/NODE_ERR");
+        return CS_OK;
+    }
+
+    CSN_AO_Verbose("Sample rate of virtual sensor %d set to %lu Hz.", sensor,
+            rate);
+
+    CSN_AO_WriteInteger(response, ao_rate[idx]);
+    return CS_OK;
+}
+
+/** \brief Returns sum of sample rates of all virtual sensors and of event
+ * capture while it is sampling.
+ *
+ * \param idx
+ * Sensor index whose rate is replaced by \p rate or -1.
+ *
+ * \param rate
+ * Rate in Hz used for sensor index \p idx.
+ */
+static uint32_t CSN_AO_TotalRate(int idx, uint32_t rate)
+{
+    uint32_t total = ao_capture.is_sampling ? CSN_LP_AO_CAPTURE_RATE : 0;
+
+    for (int i = 0; i < CSN_AO_SENSOR_CNT; ++i)
+    {
+        uint32_t r = (i == idx) ? rate : ao_rate[i];
+
+        // Software fusion samples accelerometer at the rate of gyroscope
+        // instead of orientation sensor.
+        if (i == CSN_AO_SENSOR_ORIENTATION
+            && ao_fusion == CSN_AO_FUSION_SOFTWARE)
+        {
+            r = (idx == CSN_AO_SENSOR_RATE_OF_ROTATION) ?
+                    rate : ao_rate[CSN_AO_SENSOR_RATE_OF_ROTATION];
+        }
+        total += r;
+    }
+
+    return total;
+}
+
+/** \brief Arms or stops event capture.
+ *
+ * Request "7/AO/EV/1" discards previously captured window and starts
+ * recording of accelerometer samples. Once impact or free fall is detected
+ * and the window is complete, notification is sent with the token of this
+ * request. "7/AO/EV/0" stops the capture and discards the window.
+ *
+ * Available only with binary encoding, same as download of the window.
+ * Responds with the new state of the capture.
+ */
+static int CSN_AO_CaptureRequest(const struct CS_Request_Struct* request,
+        char* response)
+{
+    const char* value = request->property_value;
+    int32_t errcode = BHY_SUCCESS;
+
+    if (CS_IsBinaryEncoding() == 0)
+    {
+        sprintf(response, "e/ENC");
+        return CS_OK;
+    }
+
+    if (strcmp(value, "0") == 0)
+    {
+        errcode = CSN_AO_CaptureStop();
+    }
+    else if (strcmp(value, "1") == 0)
+    {
+        if (ao_capture.is_sampling == false)
+        {
+            if (CSN_AO_TotalRate(-1, 0) + CSN_LP_AO_CAPTURE_RATE
+                > CSN_LP_AO_MAX_TOTAL_RATE)
+            {
+                CSN_AO_Warn("Event capture exceeds sample rate limit of %d Hz.",
+                        CSN_LP_AO_MAX_TOTAL_RATE);
+                sprintf(response, "e/INV_VALUE");
+                return CS_OK;
+            }
+
+            errcode = CSN_AO_CaptureSetSensor(true);
+            ao_capture.is_sampling = (errcode == BHY_SUCCESS);
+        }
+
+        if (errcode == BHY_SUCCESS)
+        {
+            ao_capture.state = CSN_AO_CAPTURE_ARMED;
+            ao_capture.token = request->token[0];
+            ao_capture.notify = false;
+            ao_capture.free_fall_cnt = 0;
+            ao_capture.seq = 0;
+            CSN_AO_Info("Event capture armed.");
+        }
+    }
+    else
+    {
+        sprintf(response, "e/INV_VALUE");
+        return CS_OK;
+    }
+
+    if (errcode != BHY_SUCCESS)
+    {
+        CSN_AO_Error("Failed to change event capture state (err=%d)",
+                errcode);
+        sprintf(response, "e/NODE_ERR");
+        return CS_OK;
+    }
+
+    CSN_AO_WriteInteger(response, ao_capture.state);
+    return CS_OK;
+}
+
+/** \brief Enables or disables accelerometer of event capture.
+ *
+ * Capture holds BHI160 in normal mode on its own so that it keeps running
+ * when AO virtual sensors become idle.
+ */
+static int32_t CSN_AO_CaptureSetSensor(bool enable)
+{
+    int32_t errcode;
+
+    if (enable)
+    {
+        errcode = BHI160_NDOF_AcquireNormalMode();
+        if (errcode != BHY_SUCCESS)
+        {
+            return errcode;
+        }
+
+        errcode = bhy_enable_virtual_sensor(BHI160_NDOF_S_ACCELEROMETER,
+                VS_NON_WAKEUP, CSN_LP_AO_CAPTURE_RATE,
+                CSN_LP_AO_CAPTURE_LATENCY, VS_FLUSH_NONE, 0, 0);
+        if (errcode != BHY_SUCCESS)
+        {
+            BHI160_NDOF_ReleaseNormalMode();
+        }
+        return errcode;
+    }
+
+    errcode = bhy_disable_virtual_sensor(BHI160_NDOF_S_ACCELEROMETER,
+            VS_NON_WAKEUP);
+    errcode += BHI160_NDOF_ReleaseNormalMode();
+    return errcode;
+}
+
+/** \brief Stops event capture and discards captured window. */
+static int32_t CSN_AO_CaptureStop(void)
+{
+    int32_t errcode = BHY_SUCCESS;
+
+    if (ao_capture.is_sampling)
+    {
+        ao_capture.is_sampling = false;
+        errcode = CSN_AO_CaptureSetSensor(false);
+    }
+
+    ao_capture.state = CSN_AO_CAPTURE_IDLE;
+    ao_capture.notify = false;
+    ao_capture.seq = 0;
+
+    return errcode;
+}
+
+/** \brief Returns sequence number of the first sample of captured window.
+ *
+ * Window starts CSN_LP_AO_CAPTURE_PRE_TRIGGER samples before the trigger
+ * sample or with the first recorded sample if the event came earlier.
+ */
+static uint32_t CSN_AO_CaptureStart(void)
+{
+    const struct CSN_AO_Capture_Struct* c = &ao_capture;
+    uint32_t start = 0;
+
+    if (c->trigger_seq > CSN_LP_AO_CAPTURE_PRE_TRIGGER)
+    {
+        start = c->trigger_seq - CSN_LP_AO_CAPTURE_PRE_TRIGGER;
+    }
+    if (c->seq - start > CSN_LP_AO_CAPTURE_SIZE)
+    {
+        start = c->seq - CSN_LP_AO_CAPTURE_SIZE;
+    }
+
+    return start;
+}
+
+/** \brief Stops sampling of completed capture and notifies the host.
+ *
+ * Notification is sent with the token of the arm request and contains int32
+ * values: event type (1 - impact, 2 - free fall), number of window samples,
+ * index of the trigger sample in the window and timestamp of the trigger
+ * sample in ms.
+ */
+static void CSN_AO_CaptureNotify(void)
+{
+    const struct CSN_AO_Capture_Struct* c = &ao_capture;
+    const uint32_t start = CSN_AO_CaptureStart();
+    char packet[21];
+    int32_t v[4];
+    int32_t errcode;
+
+    if (ao_capture.is_sampling)
+    {
+        ao_capture.is_sampling = false;
+        errcode = CSN_AO_CaptureSetSensor(false);
+        if (errcode != BHY_SUCCESS)
+        {
+            CSN_AO_Error("Failed to stop event capture (err=%d)", errcode);
+        }
+    }
+
+    v[0] = c->event;
+    v[1] = c->seq - start;
+    v[2] = c->trigger_seq - start;
+    v[3] = CSN_AO_TIMESTAMP_TO_MS(
+            c->sample[c->trigger_seq & CSN_AO_CAPTURE_MASK].timestamp);
+
+    CSN_AO_Info("Captured %s event.",
+            (c->event == CSN_AO_EVENT_IMPACT) ? "impact" : "free fall");
+
+    packet[0] = c->token;
+    packet[1] = '/';
+    CS_EncodeInt32(&packet[2], v, 4);
+    CS_InjectResponse(packet);
+}
+
+/** \brief Sends samples of captured window.
+ *
+ * \param token
+ * Token of the request.
+ *
+ * \param index
+ * Index of the first requested sample in the window.
+ *
+ * \param count
+ * Number of requested samples.
+ */
+static void CSN_AO_CaptureRead(char token, uint32_t index, uint32_t count)
+{
+    uint32_t start = 0;
+    uint32_t available = 0;
+
+    if (ao_capture.state == CSN_AO_CAPTURE_DONE)
+    {
+        start = CSN_AO_CaptureStart();
+        available = ao_capture.seq - start;
+    }
+
+    // Limit request to available samples.
+    if (index > available)
+    {
+        index = available;
+    }
+    if (count > available - index)
+    {
+        count = available - index;
+    }
+    if (count > CSN_LP_AO_HISTORY_MAX_READ)
+    {
+        count = CSN_LP_AO_HISTORY_MAX_READ;
+    }
+
+    CSN_AO_SendSamples(token, ao_capture.sample, CSN_AO_CAPTURE_MASK,
+            start + index, index, count);
+}
+
+/** \brief Writes integer property value. */
+static void CSN_AO_WriteInteger(char* response, int32_t value)
+{
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt32(response, &value, 1);
+    }
+    else
+    {
+        sprintf(response, "i/%d", (int) value);
+    }
+}
+
+/** \brief Writes scalar property value as ASCII fixed point number with two
+ * decimal places or binary int32 with exponent -2.
+ *
+ * \param value
+ * Property value multiplied by 100.
+ */
+static void CSN_AO_WriteScalar(char* response, int32_t value)
+{
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt32(response, &value, 1);
+    }
+    else
+    {
+        const uint32_t abs_value = (value < 0) ? -value : value;
+
+        snprintf(response, 19, "f/%s%lu.%02lu", (value < 0) ? "-" : "",
+                abs_value / 100, abs_value % 100);
+    }
+}
+
+/** \brief Writes composite property value as comma separated ASCII integers
+ * or binary int16 vector.
+ *
+ * \param v
+ * Values multiplied by 100.
+ *
+ * \param divisor
+ * Divisor that converts values to the exponent of the property.
+ */
+static void CSN_AO_WriteVector(char* response, const int32_t* v,
+        int32_t divisor)
+{
+    const int16_t out[3] = {
+            (int16_t) (v[0] / divisor),
+            (int16_t) (v[1] / divisor),
+            (int16_t) (v[2] / divisor)
+    };
+
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt16(response, out, 3);
+    }
+    else
+    {
+        snprintf(response, 19, "%d,%d,%d", out[0], out[1], out[2]);
+    }
+}
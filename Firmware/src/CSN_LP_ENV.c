@@ -24,6 +24,7 @@
 #include <I2CEeprom.h>
 #include <api/led_api.h>
 #include <stimer.h>
+#include <HAL_RTC.h>
 #include <app_trace.h>
 
 //-----------------------------------------------------------------------------
@@ -38,6 +39,10 @@
 
 #define CSN_ENV_PROP_CNT               (8)
 
+// Allowed delay of BSEC processing to share wake-ups with other timers.
+// BSEC takes timestamps from the timebase timer, so small delays are fine.
+#define CSN_ENV_TIMER_SLACK_MS         (20)
+
 
 // Shortcut macros for logging of ALS node messages.
 #define CSN_ENV_Error(...) CS_LogError("ENV", __VA_ARGS__)
@@ -118,7 +123,9 @@ static bsec_env_output_struct env_data = { 0 };
 
 static struct stimer env_timer;
 
-static struct stimer env_timebase_timer;
+/* RTC time of node initialization.
+ * Used as a base of timestamps for BSEC library. */
+static uint64_t env_timebase_start;
 
 static I2CEeprom m24rf64;
 
@@ -151,6 +158,9 @@ static struct CSN_ENV_Property_Struct env_prop[CSN_ENV_PROP_CNT] = {
         { "DI", "p/R/c/DI", &CSN_ENV_DI_PropHandler}
 };
 
+/** \brief Lookup table from property name to index into env_prop. */
+static struct CS_NameIndex_Struct env_prop_index;
+
 
 //-----------------------------------------------------------------------------
 // FUNCTION DEFINITIONS
@@ -171,6 +181,16 @@ struct CS_Node_Struct* CSN_LP_ENV_Create(struct stimer_ctx* ctx)
     bsec_env_return_val retval_bsec;
     bsec_env_init_struct init_params = CSN_BSEC_INIT_STRUCT_VALUE;
 
+    CS_NameIndexInit(&env_prop_index);
+    for (int i = 0; i < CSN_ENV_PROP_CNT; ++i)
+    {
+        if (CS_NameIndexAdd(&env_prop_index, env_prop[i].name, i) != CS_OK)
+        {
+            CSN_ENV_Error("Failed to index property '%s'.", env_prop[i].name);
+            return NULL;
+        }
+    }
+
     /* Check if timer context was provided. */
     if (ctx != NULL)
     {
@@ -187,15 +207,14 @@ struct CS_Node_Struct* CSN_LP_ENV_Create(struct stimer_ctx* ctx)
                  * BSEC processing should be called from main loop.
                  */
                 stimer_init(&env_timer, ctx);
+                stimer_set_slack_ms(&env_timer, CSN_ENV_TIMER_SLACK_MS);
                 stimer_expire_from_now_ns(&env_timer, 1);
+                env_node.poll_timer = &env_timer;
 
-                /* Always running timer that keeps track of how much time has
-                 * elapsed since node initialization.
-                 * This timer uses RTC due to usage of deep slep mode of RSL10.
-                 * Used as a source of timestamps for BSEC library.
+                /* Timestamps for BSEC library are taken from RTC due to usage
+                 * of deep sleep mode of RSL10.
                  */
-                stimer_init(&env_timebase_timer, ctx);
-                stimer_start(&env_timebase_timer);
+                env_timebase_start = HAL_RTC_GetTime64();
 
                 retval_node = &env_node;
             }
@@ -224,9 +243,6 @@ static int CSN_LP_ENV_PowerModeHandler(enum CS_PowerMode mode)
 
 static void CSN_LP_ENV_PollHandler(void)
 {
-    static struct stimer_duration last;
-    struct stimer_duration now;
-
     if (env_timer.is_running && stimer_is_expired(&env_timer))
     {
         int32_t next_call_ms = 0;
@@ -235,10 +251,7 @@ static void CSN_LP_ENV_PollHandler(void)
 
         stimer_expire_from_now_ms(&env_timer, next_call_ms);
 
-        stimer_get_elapsed_time(&env_timebase_timer, &now);
         TRACE_PRINTF("Next BSEC process in: %lu ms\r\n", next_call_ms);
-
-        memcpy(&last, &now, sizeof(struct stimer_duration));
     }
 }
 
@@ -254,15 +267,7 @@ void CSN_BsecOutputReady(bsec_env_output_struct *output)
 
 int64_t CSN_BsecGetTimestampUs()
 {
-    struct stimer_duration elapsed;
-    int64_t timestamp_us;
-
-    stimer_get_elapsed_time(&env_timebase_timer, &elapsed);
-
-    timestamp_us = ((int64_t) elapsed.seconds * 1000000U)
-            + ((int64_t) elapsed.nanoseconds / 1000U);
-
-    return timestamp_us;
+    return HAL_RTC_TICKS_TO_US(HAL_RTC_GetTime64() - env_timebase_start);
 }
 
 //static uint32_t CSN_BsecStateLoadFromEEPROM(uint8_t *state_buffer,
@@ -335,16 +340,15 @@ static int CSN_ENV_RequestHandler(const struct CS_Request_Struct* request, char*
     }
 
     // AO Data property requests
-    for (int i = 0; i < CSN_ENV_PROP_CNT; ++i)
+    int i = CS_NameIndexFind(&env_prop_index, request->property,
+            request->property_hash);
+    if (i >= 0)
     {
-        if (strcmp(request->property, env_prop[i].name) == 0)
+        if (env_prop[i].callback(response) != CS_OK)
         {
-            if (env_prop[i].callback(response) != CS_OK)
-            {
-                strcpy(response, "e/NODE_ERR");
-            }
-            return CS_OK;
+            strcpy(response, "e/NODE_ERR");
         }
+        return CS_OK;
     }
 
     // PROP property request
@@ -0,0 +1,720 @@
+// ----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+// ----------------------------------------------------------------------------
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <BDK.h>
+#include <CSN_LP_VB.h>
+#include <BHI160_NDOF.h>
+#include <fft_q15.h>
+
+
+//-----------------------------------------------------------------------------
+// DEFINES / CONSTANTS
+//-----------------------------------------------------------------------------
+
+#define CSN_VB_NODE_NAME               "VB"
+
+#define CSN_VB_AVAIL_BIT               0x00000100
+
+#define CSN_VB_PROP_CNT                5
+
+#if CSN_LP_VB_FFT_SIZE > FFT_Q15_MAX_SIZE \
+    || (CSN_LP_VB_FFT_SIZE & (CSN_LP_VB_FFT_SIZE - 1)) != 0
+#error "RTE_APP_ICS_VB_FFT_SIZE has to be power of two up to 512."
+#endif
+
+#if CSN_LP_VB_BAND_CNT < 1 || CSN_LP_VB_BAND_CNT > 4
+#error "RTE_APP_ICS_VB_BAND_CNT has to be in range 1 to 4."
+#endif
+
+/** \brief Number of spectrum bins from DC up to half of the sample rate. */
+#define CSN_VB_BIN_CNT                 (CSN_LP_VB_FFT_SIZE / 2)
+
+/** \brief Q24 factor converting raw acceleration to 0.01 m/s^2 for dynamic
+ * range of 1 g. (9.80665 / 32768 * 100 * 2^24)
+ */
+#define CSN_VB_SCALE_PER_G             (502100)
+
+/** \brief Frequency of BHI160 timestamp counter in Hz. */
+#define CSN_VB_TIMESTAMP_FREQ          (32000)
+
+// Shortcut macros for logging of VB node messages.
+#define CSN_VB_Error(...) CS_LogError("VB", __VA_ARGS__)
+#define CSN_VB_Warn(...) CS_LogWarning("VB", __VA_ARGS__)
+#define CSN_VB_Info(...) CS_LogInfo("VB", __VA_ARGS__)
+#define CSN_VB_Verbose(...) CS_LogVerbose("VB", __VA_ARGS__)
+
+//-----------------------------------------------------------------------------
+// EXTERNAL / FORWARD DECLARATIONS
+//-----------------------------------------------------------------------------
+
+static void CSN_VB_SensorCallback(bhy_data_generic_t *data,
+        bhy_virtual_sensor_t sensor);
+
+static int CSN_LP_VB_RequestHandler(const struct CS_Request_Struct* request,
+        char* response);
+static int CSN_LP_VB_PowerModeHandler(enum CS_PowerMode mode);
+static void CSN_LP_VB_PollHandler(void);
+
+static int CSN_VB_Enable(void);
+static void CSN_VB_Analyze(void);
+static void CSN_VB_PowerSpectrum(const int32_t* mean, int shift);
+static uint32_t CSN_VB_Sqrt(uint64_t value);
+static int32_t CSN_VB_ToCenti(uint64_t value, int shift);
+
+static int CSN_VB_F_PropHandler(char* response);
+static int CSN_VB_PA_PropHandler(char* response);
+static int CSN_VB_B_PropHandler(char* response);
+static int CSN_VB_RMS_PropHandler(char* response);
+static int CSN_VB_CF_PropHandler(char* response);
+
+static void CSN_VB_WriteScalar(char* response, int32_t value);
+static void CSN_VB_WriteVector(char* response, const int16_t* v, int count);
+
+//-----------------------------------------------------------------------------
+// INTERNAL VARIABLES
+//-----------------------------------------------------------------------------
+
+/** \brief CS node structure passed to CS. */
+static struct CS_Node_Struct vb_node = {
+		CSN_VB_NODE_NAME,
+		CSN_VB_AVAIL_BIT,
+		&CSN_LP_VB_RequestHandler,
+		&CSN_LP_VB_PowerModeHandler,
+		&CSN_LP_VB_PollHandler
+};
+
+struct CSN_VB_Property_Struct
+{
+	const char* name;
+	const char* prop_def;
+	int (*callback)(char* response);
+
+	/** \brief Decimal exponent of binary encoded values. */
+	int8_t exponent;
+};
+
+static const struct CSN_VB_Property_Struct vb_prop[CSN_VB_PROP_CNT] = {
+    { "F",     "p/R/c/F",   &CSN_VB_F_PropHandler, -1 },
+    { "PA",   "p/R/c/PA",  &CSN_VB_PA_PropHandler, -2 },
+    { "B",     "p/R/c/B",   &CSN_VB_B_PropHandler, -2 },
+    { "RMS", "p/R/f/RMS", &CSN_VB_RMS_PropHandler, -2 },
+    { "CF",   "p/R/f/CF",  &CSN_VB_CF_PropHandler, -2 }
+};
+
+/** \brief Lookup table from property name to index into vb_prop. */
+static struct CS_NameIndex_Struct vb_prop_index;
+
+/** \brief Results of the last analyzed frame. */
+struct CSN_VB_Result_Struct
+{
+	/** \brief Frequencies of highest spectrum peaks in 0.1 Hz. */
+	int16_t peak_freq[CSN_LP_VB_PEAK_CNT];
+
+	/** \brief Amplitudes of highest spectrum peaks in 0.01 m/s^2. */
+	int16_t peak_ampl[CSN_LP_VB_PEAK_CNT];
+
+	/** \brief RMS acceleration of each frequency band in 0.01 m/s^2. */
+	int16_t band_rms[CSN_LP_VB_BAND_CNT];
+
+	/** \brief RMS acceleration of whole spectrum in 0.01 m/s^2. */
+	int32_t rms;
+
+	/** \brief Ratio of peak and RMS acceleration multiplied by 100. */
+	int32_t crest;
+};
+
+static struct CSN_VB_Result_Struct vb_result;
+
+/** \brief Linear acceleration samples of x, y and z axis. */
+static int16_t vb_sample[3][CSN_LP_VB_FFT_SIZE];
+
+/** \brief Number of samples in vb_sample. */
+static uint32_t vb_sample_cnt = 0;
+
+/** \brief BHI160 timestamps of the first and last sample of the frame. */
+static uint32_t vb_first_timestamp;
+static uint32_t vb_last_timestamp;
+
+/** \brief Number of samples dropped while waiting for analysis. */
+static uint32_t vb_drop_cnt = 0;
+
+/** \brief FFT work buffer. */
+static struct FFT_Q15_Complex vb_fft[CSN_LP_VB_FFT_SIZE];
+
+/** \brief Sum of power of all axes in each spectrum bin. */
+static uint32_t vb_power[CSN_VB_BIN_CNT];
+
+/** \brief Linear acceleration virtual sensor is enabled. */
+static bool vb_enabled = false;
+
+//-----------------------------------------------------------------------------
+// FUNCTION DEFINITIONS
+//-----------------------------------------------------------------------------
+
+struct CS_Node_Struct* CSN_LP_VB_Create(void)
+{
+    int32_t errcode;
+
+    CS_NameIndexInit(&vb_prop_index);
+    for (int i = 0; i < CSN_VB_PROP_CNT; ++i)
+    {
+        if (CS_NameIndexAdd(&vb_prop_index, vb_prop[i].name, i) != CS_OK)
+        {
+            CSN_VB_Error("Failed to index property '%s'.", vb_prop[i].name);
+            return NULL;
+        }
+    }
+
+    errcode = BHI160_NDOF_Initialize();
+    if (errcode != BHY_SUCCESS)
+    {
+        CSN_VB_Error("Failed to initialize BHI160. (err=%d)", errcode);
+        return NULL;
+    }
+
+    // Non-wakeup instance of the sensor is independent of the one used by AO
+    // node and can run at different sample rate.
+    errcode = bhy_install_sensor_callback(BHI160_NDOF_S_LINEAR_ACCELERATION,
+            VS_NON_WAKEUP, CSN_VB_SensorCallback);
+    if (errcode != BHY_SUCCESS)
+    {
+        CSN_VB_Error("Failed to install sensor callback.");
+        return NULL;
+    }
+
+    return &vb_node;
+}
+
+static void CSN_VB_SensorCallback(bhy_data_generic_t *data,
+        bhy_virtual_sensor_t sensor)
+{
+    const uint32_t timestamp = BHI160_NDOF_GetTimestamp();
+
+    // Previous frame was not analyzed yet.
+    if (vb_sample_cnt == CSN_LP_VB_FFT_SIZE)
+    {
+        vb_drop_cnt += 1;
+        return;
+    }
+
+    if (vb_sample_cnt == 0)
+    {
+        vb_first_timestamp = timestamp;
+    }
+
+    vb_sample[0][vb_sample_cnt] = data->data_vector.x;
+    vb_sample[1][vb_sample_cnt] = data->data_vector.y;
+    vb_sample[2][vb_sample_cnt] = data->data_vector.z;
+    vb_sample_cnt += 1;
+
+    if (vb_sample_cnt == CSN_LP_VB_FFT_SIZE)
+    {
+        vb_last_timestamp = timestamp;
+        CS_NotifyNode(&vb_node);
+    }
+}
+
+static int CSN_LP_VB_RequestHandler(const struct CS_Request_Struct* request,
+        char* response)
+{
+    // Check request type
+    if (request->property_value != NULL)
+    {
+        CSN_VB_Error("VB properties support only read requests.");
+        sprintf(response, "e/ACCESS");
+        return CS_OK;
+    }
+
+    // VB Data property requests
+    int i = CS_NameIndexFind(&vb_prop_index, request->property,
+            request->property_hash);
+    if (i >= 0)
+    {
+        // Start sampling on first request, results are available once
+        // the first frame is collected.
+        if (vb_enabled == false && CSN_VB_Enable() != CS_OK)
+        {
+            sprintf(response, "e/NODE_ERR");
+            return CS_OK;
+        }
+
+        return vb_prop[i].callback(response);
+    }
+
+    // PROP property request
+    if (strcmp(request->property, "PROP") == 0)
+    {
+        sprintf(response, "i/%d", CSN_VB_PROP_CNT);
+        return CS_OK;
+    }
+
+    // PROPx property request
+    if (strlen(request->property) > 4
+            && memcmp(request->property, "PROP", 4) == 0)
+    {
+        const char* c = &request->property[4];
+
+        while (isdigit((int) *c))
+        {
+            ++c;
+        }
+
+        if (*c == '\0')
+        {
+            int prop_index = atoi(&request->property[4]);
+            if (prop_index >= 0 && prop_index < CSN_VB_PROP_CNT)
+            {
+                if (CS_IsBinaryEncoding())
+                {
+                    sprintf(response, "n/%s/%d", vb_prop[prop_index].prop_def,
+                            vb_prop[prop_index].exponent);
+                }
+                else
+                {
+                    sprintf(response, "n/%s", vb_prop[prop_index].prop_def);
+                }
+                return CS_OK;
+            }
+        }
+    }
+
+    CSN_VB_Error("VB property '%s' does not exist.", request->property);
+    sprintf(response, "e/UNK_PROP");
+    return CS_OK;
+}
+
+static int CSN_LP_VB_PowerModeHandler(enum CS_PowerMode mode)
+{
+    int32_t errcode;
+
+    switch (mode)
+    {
+    case CS_POWER_MODE_NORMAL:
+        break;
+
+    case CS_POWER_MODE_SLEEP:
+        if (vb_enabled)
+        {
+            vb_enabled = false;
+
+            errcode = bhy_disable_virtual_sensor(
+                    BHI160_NDOF_S_LINEAR_ACCELERATION, VS_NON_WAKEUP);
+            errcode += BHI160_NDOF_ReleaseNormalMode();
+            if (errcode != BHY_SUCCESS)
+            {
+                return CS_ERROR;
+            }
+        }
+
+        vb_sample_cnt = 0;
+        memset(&vb_result, 0, sizeof(vb_result));
+
+        CSN_VB_Info("Sampling stopped.");
+        break;
+    }
+
+    return CS_OK;
+}
+
+static void CSN_LP_VB_PollHandler(void)
+{
+    if (vb_sample_cnt == CSN_LP_VB_FFT_SIZE)
+    {
+        CSN_VB_Analyze();
+
+        vb_sample_cnt = 0;
+    }
+}
+
+static int CSN_VB_Enable(void)
+{
+    int32_t errcode;
+
+    errcode = BHI160_NDOF_AcquireNormalMode();
+    if (errcode != BHY_SUCCESS)
+    {
+        CSN_VB_Error("Failed to wake up BHI160 (err=%d)", errcode);
+        return CS_ERROR;
+    }
+
+    errcode = bhy_enable_virtual_sensor(BHI160_NDOF_S_LINEAR_ACCELERATION,
+            VS_NON_WAKEUP, CSN_LP_VB_SAMPLE_RATE, CSN_LP_VB_REPORT_LATENCY,
+            VS_FLUSH_NONE, 0, 0);
+    if (errcode != BHY_SUCCESS)
+    {
+        CSN_VB_Error("Failed to enable virtual sensor (err=%d)", errcode);
+        BHI160_NDOF_ReleaseNormalMode();
+        return CS_ERROR;
+    }
+
+    vb_sample_cnt = 0;
+    vb_drop_cnt = 0;
+    vb_enabled = true;
+
+    CSN_VB_Info("Sampling started.");
+
+    return CS_OK;
+}
+
+/** \brief Computes spectrum features of collected frame.
+ *
+ * Mean of each axis is removed and samples are scaled to use full range of
+ * the FFT before applying Hann window. Features are computed from the sum of
+ * power spectra of all axes.
+ */
+static void CSN_VB_Analyze(void)
+{
+    const uint32_t n = CSN_LP_VB_FFT_SIZE;
+    int32_t mean[3];
+    int32_t max_abs = 0;
+    uint64_t sum_sq = 0;
+    uint64_t peak_sq = 0;
+    int shift = 0;
+
+    for (int a = 0; a < 3; ++a)
+    {
+        int32_t sum = 0;
+
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            sum += vb_sample[a][i];
+        }
+        mean[a] = sum / (int32_t) n;
+    }
+
+    // Crest factor of acceleration vector in time domain.
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        uint64_t sq = 0;
+
+        for (int a = 0; a < 3; ++a)
+        {
+            const int32_t v = vb_sample[a][i] - mean[a];
+            const int32_t v_abs = (v < 0) ? -v : v;
+
+            sq += (uint64_t) ((int64_t) v * v);
+            if (v_abs > max_abs)
+            {
+                max_abs = v_abs;
+            }
+        }
+
+        sum_sq += sq;
+        if (sq > peak_sq)
+        {
+            peak_sq = sq;
+        }
+    }
+
+    vb_result.crest = (sum_sq > 0) ?
+            CSN_VB_Sqrt(peak_sq * n * 10000 / sum_sq) : 0;
+
+    // Block floating point scaling keeps FFT input below 2^14 while using as
+    // many bits as possible.
+    if (max_abs > 0)
+    {
+        while ((max_abs << (shift + 1)) < 16384 && shift < 14)
+        {
+            shift += 1;
+        }
+        while (shift <= 0 && (max_abs >> -shift) >= 16384)
+        {
+            shift -= 1;
+        }
+    }
+
+    CSN_VB_PowerSpectrum(mean, shift);
+
+    // Peak search and band RMS over all bins except DC.
+    {
+        uint32_t peak_bin[CSN_LP_VB_PEAK_CNT] = { 0 };
+        uint64_t band_sum[CSN_LP_VB_BAND_CNT] = { 0 };
+        uint64_t total = 0;
+        uint32_t fs_x100 = CSN_LP_VB_SAMPLE_RATE * 100;
+        const uint32_t dt = vb_last_timestamp - vb_first_timestamp;
+
+        // Measured sample rate is more accurate than the requested one.
+        if (dt > 0)
+        {
+            fs_x100 = (uint32_t) ((uint64_t) (n - 1) * CSN_VB_TIMESTAMP_FREQ
+                    * 100 / dt);
+        }
+
+        for (uint32_t k = 1; k < CSN_VB_BIN_CNT; ++k)
+        {
+            const uint32_t b = (k - 1) * CSN_LP_VB_BAND_CNT
+                    / (CSN_VB_BIN_CNT - 1);
+
+            band_sum[b] += vb_power[k];
+            total += vb_power[k];
+
+            // Local maximum
+            if (vb_power[k] > vb_power[k - 1]
+                && (k + 1 == CSN_VB_BIN_CNT || vb_power[k] >= vb_power[k + 1]))
+            {
+                for (int p = 0; p < CSN_LP_VB_PEAK_CNT; ++p)
+                {
+                    if (peak_bin[p] == 0 || vb_power[k] > vb_power[peak_bin[p]])
+                    {
+                        memmove(&peak_bin[p + 1], &peak_bin[p],
+                                (CSN_LP_VB_PEAK_CNT - 1 - p)
+                                * sizeof(peak_bin[0]));
+                        peak_bin[p] = k;
+                        break;
+                    }
+                }
+            }
+        }
+
+        // vb_power holds half of the power of one-sided spectrum, which is
+        // half of the signal power. Hann window has power gain of 3/8.
+        for (int b = 0; b < CSN_LP_VB_BAND_CNT; ++b)
+        {
+            vb_result.band_rms[b] = (int16_t) CSN_VB_ToCenti(
+                    CSN_VB_Sqrt(band_sum[b] * 32 / 3), shift);
+        }
+        vb_result.rms = CSN_VB_ToCenti(CSN_VB_Sqrt(total * 32 / 3), shift);
+
+        for (int p = 0; p < CSN_LP_VB_PEAK_CNT; ++p)
+        {
+            const uint32_t k = peak_bin[p];
+            int64_t num = 0;
+            int64_t den = 0;
+
+            if (k == 0)
+            {
+                vb_result.peak_freq[p] = 0;
+                vb_result.peak_ampl[p] = 0;
+                continue;
+            }
+
+            // Parabolic interpolation of the peak position using magnitudes
+            // of neighboring bins.
+            if (k + 1 < CSN_VB_BIN_CNT)
+            {
+                const int64_t m0 = CSN_VB_Sqrt(vb_power[k - 1]);
+                const int64_t m1 = CSN_VB_Sqrt(vb_power[k]);
+                const int64_t m2 = CSN_VB_Sqrt(vb_power[k + 1]);
+
+                num = m0 - m2;
+                den = 2 * (m0 - 2 * m1 + m2);
+            }
+
+            if (den != 0)
+            {
+                vb_result.peak_freq[p] = (int16_t) (((int64_t) k * den + num)
+                        * fs_x100 / (den * (int64_t) n * 10));
+            }
+            else
+            {
+                vb_result.peak_freq[p] = (int16_t) ((uint64_t) k * fs_x100
+                        / (n * 10));
+            }
+
+            // Sine amplitude is 4 times the bin magnitude with Hann window.
+            vb_result.peak_ampl[p] = (int16_t) CSN_VB_ToCenti(
+                    CSN_VB_Sqrt((uint64_t) vb_power[k] * 32), shift);
+        }
+    }
+
+    CSN_VB_Verbose("Frame analyzed (shift=%d, dropped=%lu)", shift,
+            vb_drop_cnt);
+}
+
+/** \brief Computes vb_power from samples in vb_sample.
+ *
+ * X and Y axis are transformed together as real and imaginary part of one
+ * complex signal, Z axis is transformed separately.
+ * Power of bin k of two real signals x + jy is (|Z[k]|^2 + |Z[n-k]|^2) / 2.
+ * Stored power is halved so that the sum of all axes fits 32 bits.
+ *
+ * \param mean
+ * Mean value of each axis that is subtracted from samples.
+ *
+ * \param shift
+ * Number of bits samples are shifted left by. Negative for right shift.
+ */
+static void CSN_VB_PowerSpectrum(const int32_t* mean, int shift)
+{
+    const uint32_t n = CSN_LP_VB_FFT_SIZE;
+
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        for (uint32_t i = 0; i < n; ++i)
+        {
+            const int32_t w = FFT_Q15_Hann(i, n);
+            int32_t v[2] = { 0, 0 };
+
+            for (int a = 0; a < 2; ++a)
+            {
+                const int axis = 2 * pass + a;
+
+                if (axis < 3)
+                {
+                    v[a] = vb_sample[axis][i] - mean[axis];
+                    v[a] = (shift >= 0) ? (v[a] << shift) : (v[a] >> -shift);
+                }
+            }
+
+            vb_fft[i].re = (int16_t) ((v[0] * w) >> 15);
+            vb_fft[i].im = (int16_t) ((v[1] * w) >> 15);
+        }
+
+        FFT_Q15_Transform(vb_fft, n);
+
+        for (uint32_t k = 0; k < CSN_VB_BIN_CNT; ++k)
+        {
+            const struct FFT_Q15_Complex* z = &vb_fft[k];
+            uint32_t p = (uint32_t) (z->re * z->re) + (uint32_t) (z->im * z->im);
+
+            if (pass == 0)
+            {
+                const struct FFT_Q15_Complex* zn = &vb_fft[(n - k) % n];
+
+                p = (p >> 1) + (((uint32_t) (zn->re * zn->re)
+                        + (uint32_t) (zn->im * zn->im)) >> 1);
+                vb_power[k] = p >> 1;
+            }
+            else
+            {
+                vb_power[k] += p >> 1;
+            }
+        }
+    }
+}
+
+/** \brief Converts value in raw accelerometer units scaled by 2^shift to
+ * 0.01 m/s^2 using current accelerometer dynamic range.
+ *
+ * Samples are at most 17 bits wide so shift is never below -2.
+ */
+static int32_t CSN_VB_ToCenti(uint64_t value, int shift)
+{
+    const uint64_t scale = (uint64_t) BHI160_NDOF_GetAccelDynamicRange()
+            * CSN_VB_SCALE_PER_G;
+    const uint64_t centi = (value * scale + ((uint64_t) 1 << (shift + 23)))
+            >> (shift + 24);
+
+    return (centi > INT16_MAX) ? INT16_MAX : (int32_t) centi;
+}
+
+/** \brief Integer square root rounded down. */
+static uint32_t CSN_VB_Sqrt(uint64_t value)
+{
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t) 1 << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t) result;
+}
+
+static int CSN_VB_F_PropHandler(char* response)
+{
+    CSN_VB_WriteVector(response, vb_result.peak_freq, CSN_LP_VB_PEAK_CNT);
+
+    return CS_OK;
+}
+
+static int CSN_VB_PA_PropHandler(char* response)
+{
+    CSN_VB_WriteVector(response, vb_result.peak_ampl, CSN_LP_VB_PEAK_CNT);
+
+    return CS_OK;
+}
+
+static int CSN_VB_B_PropHandler(char* response)
+{
+    CSN_VB_WriteVector(response, vb_result.band_rms, CSN_LP_VB_BAND_CNT);
+
+    return CS_OK;
+}
+
+static int CSN_VB_RMS_PropHandler(char* response)
+{
+    CSN_VB_WriteScalar(response, vb_result.rms);
+
+    return CS_OK;
+}
+
+static int CSN_VB_CF_PropHandler(char* response)
+{
+    CSN_VB_WriteScalar(response, vb_result.crest);
+
+    return CS_OK;
+}
+
+/** \brief Writes scalar property value as ASCII fixed point number with two
+ * decimal places or binary int32 with exponent -2.
+ *
+ * \param value
+ * Property value multiplied by 100.
+ */
+static void CSN_VB_WriteScalar(char* response, int32_t value)
+{
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt32(response, &value, 1);
+    }
+    else
+    {
+        const uint32_t abs_value = (value < 0) ? -value : value;
+
+        snprintf(response, 19, "f/%s%lu.%02lu", (value < 0) ? "-" : "",
+                abs_value / 100, abs_value % 100);
+    }
+}
+
+/** \brief Writes composite property value as comma separated ASCII integers
+ * or binary int16 vector.
+ */
+static void CSN_VB_WriteVector(char* response, const int16_t* v, int count)
+{
+    if (CS_IsBinaryEncoding())
+    {
+        CS_EncodeInt16(response, v, count);
+    }
+    else
+    {
+        int len = 0;
+
+        for (int i = 0; i < count && len < 18; ++i)
+        {
+            len += snprintf(&response[len], 19 - len, (i == 0) ? "%d" : ",%d",
+                    v[i]);
+        }
+    }
+}
@@ -26,18 +26,22 @@
  *
  * Keeps track of elapsed time when RTC counter is restarted with custom value
  * to schedule RTC alarm.
- *
- * \note
- * This value will overflow approx. every 36 hours.
+ * Contains number of ticks elapsed until RTC_COUNT had value of
+ * rtc_checkpoint.
  */
-volatile uint32_t rtc_time = 0;
+volatile uint64_t rtc_time = 0;
 
-/* Last seen RTC_COUNT value that was read and added to rtc_time.
- * Used to calculate number of RTC ticks since last time read. */
+/* RTC_COUNT value at the time rtc_time was last updated.
+ * Used to calculate number of RTC ticks since last update. */
 volatile uint32_t rtc_checkpoint = 0;
 
 volatile bool rtc_ignore_irq = false;
 
+/* Sequence counter protecting rtc_time, rtc_checkpoint and rtc_ignore_irq.
+ * Odd value indicates that an update is in progress. Readers retry if the
+ * value changed while they were reading. */
+volatile uint32_t rtc_seq = 0;
+
 /* debug only */
 #ifdef _HAL_RTC_DEBUG
 volatile uint32_t rtc_irq_calls = 0;
@@ -48,30 +52,41 @@ volatile uint32_t rtc_irq_calls = 0;
  *  synchronization between SYSCLK and RTC_CLK clock domains.
  *
  *  As the read of ACS_RTC_COUNT is not atomic (byte wise read in the ACS
- *  bridge), three reads are performed to make sure the counter is not clocked
- *  in the middle of the read.
- *
- *  \pre
- *  All interrupts must be disabled to prevent delays between subsequent reads
- *  of RTC_COUNT register.
+ *  bridge), the register is read until two subsequent reads return the same
+ *  value to make sure the counter is not clocked in the middle of the read.
+ *  RTC ticks are much longer than a register read, so this repeats at most
+ *  once unless the reads are preempted.
  *
  *  \returns
  *  Current value of RTC_COUNT register.
  */
 uint32_t HAL_RTC_ReadCount(void)
 {
-    uint32_t read1 = ACS->RTC_COUNT;
+    uint32_t read1;
     uint32_t read2 = ACS->RTC_COUNT;
 
-    if (read1 != read2)
-    {
-        uint32_t read3 = ACS->RTC_COUNT;
-        return read3;
-    }
-    else
+    do
     {
-        return read1;
-    }
+        read1 = read2;
+        read2 = ACS->RTC_COUNT;
+    } while (read1 != read2);
+
+    return read1;
+}
+
+/* Marks start of rtc_time / rtc_checkpoint update.
+ * Interrupts must be disabled by caller. */
+static inline void HAL_RTC_WriteBegin(void)
+{
+    rtc_seq += 1;
+    __DMB();
+}
+
+/* Marks end of rtc_time / rtc_checkpoint update. */
+static inline void HAL_RTC_WriteEnd(void)
+{
+    __DMB();
+    rtc_seq += 1;
 }
 
 
@@ -83,12 +98,14 @@ void HAL_RTC_Initialize(void)
     NVIC_ClearPendingIRQ(RTC_CLOCK_IRQn);
 
     // Reset RTC counter and checkpoint to default values.
+    HAL_RTC_WriteBegin();
     rtc_time = 0;
     rtc_checkpoint = HAL_RTC_RELOAD_VALUE;
 
     // Restart of the RTC will cause an RTC alarm interrupt on next RTC clock
     // tick. We want to ignore this interrupt.
     rtc_ignore_irq = true;
+    HAL_RTC_WriteEnd();
 
     // Set initial reload value. This is big number to minimize number of RTC
     // alarm wake ups.
@@ -112,7 +129,11 @@ void HAL_RTC_Wakeup(void)
         // If so the RTC COUNT register value has been reloaded on wake-up
         // Therefore time in this moment is:
         //   rtc_time = rtc_time + rtc_checkpoint + (RTC->CFG - RTC->COUNT)
-        rtc_time += rtc_checkpoint + (ACS->RTC_CFG - HAL_RTC_ReadCount());
+        uint32_t count = HAL_RTC_ReadCount();
+
+        HAL_RTC_WriteBegin();
+        rtc_time += rtc_checkpoint;
+        rtc_checkpoint = ACS->RTC_CFG;
 
         // Restore default reload value after RTC wake up.
         if (ACS->RTC_CFG != HAL_RTC_RELOAD_VALUE)
@@ -120,6 +141,7 @@ void HAL_RTC_Wakeup(void)
             // Reset CFG and checkpoint to default reload value to prevent
             // unnecessary interrupts / wake-ups until application sets new alarm
             // time.
+            rtc_time += rtc_checkpoint - count;
             rtc_ignore_irq = true;
             rtc_checkpoint = HAL_RTC_RELOAD_VALUE;
             ACS->RTC_CFG = HAL_RTC_RELOAD_VALUE;
@@ -128,6 +150,7 @@ void HAL_RTC_Wakeup(void)
             // Clear interrupt flag since RTC was restarted.
             NVIC_ClearPendingIRQ(RTC_ALARM_IRQn);
         }
+        HAL_RTC_WriteEnd();
     }
 
     // Re-enable RTC Alarm interrupt to catch counter reloads while application
@@ -136,64 +159,56 @@ void HAL_RTC_Wakeup(void)
 }
 
 
-uint32_t HAL_RTC_GetTime(void * hint)
+uint64_t HAL_RTC_GetTime64(void)
 {
-    uint32_t count_check;
-    uint32_t count2;
+    uint32_t seq;
+    uint64_t time;
+    uint32_t checkpoint;
+    uint32_t count;
+    uint32_t reload;
+    bool ignore_irq;
     bool rtc_alarm_pending;
 
-    // BEGIN CRITICAL SECTION
+    // Read consistent snapshot of the software counter without masking
+    // interrupts. Retry if it was updated while reading.
+    do
+    {
+        seq = rtc_seq;
+        __DMB();
 
-    // Disable all interrupts to make sure this part of code is not preempted.
-    __disable_irq();
+        time = rtc_time;
+        checkpoint = rtc_checkpoint;
+        ignore_irq = rtc_ignore_irq;
+        count = HAL_RTC_ReadCount();
+        rtc_alarm_pending = NVIC_GetPendingIRQ(RTC_ALARM_IRQn);
+        reload = ACS->RTC_CFG;
 
-    // Read RTC_COUNT value for counter reload test
-    count_check = HAL_RTC_ReadCount();
-    // Read RTC Alarm ISR status
-    rtc_alarm_pending = NVIC_GetPendingIRQ(RTC_ALARM_IRQn);
-    // Read RTC_COUNT second time
-    count2 = HAL_RTC_ReadCount();
+        __DMB();
+    } while ((seq & 1U) != 0 || seq != rtc_seq);
 
-    // Determine if RTC counter overflowed.
-    // RTC_COUNT is counting down; count2 <= count_check if no reload occurred
-    if ((rtc_alarm_pending == true) || (count_check < count2))
+    if (ignore_irq == true)
     {
-        // Manually add time that elapsed between last checkpoint and RTC_COUNT
-        // reload.
-        rtc_time += rtc_checkpoint;
-
-        // Set new checkpoint to current reload value.
-        rtc_checkpoint = ACS->RTC_CFG;
-
-        NVIC_ClearPendingIRQ(RTC_ALARM_IRQn);
+        // RTC was just restarted. RTC_COUNT stays at 0 until the next RTC
+        // clock tick reloads it.
+        if (count == 0)
+        {
+            return time;
+        }
     }
-
-    // Add ticks elapsed since last checkpoint to the software counter.
-    rtc_time += rtc_checkpoint - count2;
-    // Set checkpoint to last read counter value.
-    rtc_checkpoint = count2;
-
-    // Reenable interrupts after overflow checks are done.
-    __enable_irq();
-
-    // END CRITICAL SECTION
-
-
-
-#ifdef _HAL_RTC_DEBUG
-    if ((rtc_alarm_pending == true) || (count_check < count2))
+    else if ((rtc_alarm_pending == true) || (count > checkpoint))
     {
-        TRACE_PRINTF("%s:%d: IRQ_PEND=%d, count_check=%lu, count2=%lu\r\n\n",
-                __FUNCTION__, __LINE__, rtc_alarm_pending, count_check, count2);
-
-        TRACE_PRINTF("%s:%d: T=%lu, CH=%lu, CFG=%lu, CNT=%lu CTRL=0x%lX IRQ=%lu\r\n",
-                __FUNCTION__, __LINE__, rtc_time, rtc_checkpoint, ACS->RTC_CFG,
-                HAL_RTC_ReadCount(), ACS->RTC_CTRL, rtc_irq_calls);
+        // RTC_COUNT was reloaded but the RTC Alarm ISR did not run yet.
+        // RTC_COUNT is counting down; it can only increase on reload.
+        time += checkpoint;
+        checkpoint = reload;
     }
 
-#endif /* _HAL_RTC_DEBUG */
+    return time + (checkpoint - count);
+}
 
-    return rtc_time;
+uint32_t HAL_RTC_GetTime(void * hint)
+{
+    return (uint32_t)HAL_RTC_GetTime64();
 }
 
 void HAL_RTC_SetAlarmS(uint32_t sec)
@@ -230,6 +245,7 @@ void HAL_RTC_SetAlarmTicks(uint32_t ticks)
 
     // Determine if RTC counter overflowed.
     // RTC_COUNT is counting down; count2 <= count_check if no reload occurred
+    HAL_RTC_WriteBegin();
     if ((rtc_alarm_pending == true) || (count_check < count2))
     {
         // Manually add time that elapsed between last checkpoint and RTC_COUNT
@@ -251,6 +267,7 @@ void HAL_RTC_SetAlarmTicks(uint32_t ticks)
     // Set checkpoint to new reload value.
     rtc_checkpoint = ticks;
     rtc_ignore_irq = true;
+    HAL_RTC_WriteEnd();
 
     // END CRITICAL SECTION
 
@@ -258,12 +275,17 @@ void HAL_RTC_SetAlarmTicks(uint32_t ticks)
 
 #ifdef _HAL_RTC_DEBUG
         TRACE_PRINTF("%s:%d: TIME=%lu, CFG=%lu COUNT=%lu\r\n", __FUNCTION__,
-                __LINE__, rtc_time, ACS->RTC_CFG, HAL_RTC_ReadCount());
+                __LINE__, (uint32_t)rtc_time, ACS->RTC_CFG, HAL_RTC_ReadCount());
 #endif /* _HAL_RTC_DEBUG */
 }
 
 void RTC_ALARM_IRQHandler(void)
 {
+    // Readers in higher priority interrupts would spin forever if they
+    // preempted the update.
+    __disable_irq();
+    HAL_RTC_WriteBegin();
+
     if (rtc_ignore_irq == true)
     {
         rtc_ignore_irq = false;
@@ -271,7 +293,7 @@ void RTC_ALARM_IRQHandler(void)
     else
     {
 
-        // Add ticks elapsed between last time read and counter reload.
+        // Add ticks elapsed between last update and counter reload.
         rtc_time += rtc_checkpoint;
 
         // Reset checkpoint to current reload value.
@@ -283,4 +305,7 @@ void RTC_ALARM_IRQHandler(void)
         rtc_irq_calls += 1;
 #endif
     }
+
+    HAL_RTC_WriteEnd();
+    __enable_irq();
 }
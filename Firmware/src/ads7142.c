@@ -1,9 +1,81 @@
 #include "ads7142.h"
 #include "HAL_I2C.h"
 #include <BDK.h>
+#include <HAL_RTC.h>
+#include <RTE_app_config.h>
+#include <RTE_HB_Button.h>
+#include <RTE_HB_NOA1305_ALS.h>
+
+#if RTE_APP_ICS_EV_ENABLED == 1
+
+#if RTE_APP_ICS_EV_ALERT_INT_SRC == RTE_APP_ICS_EV_READY_INT_SRC
+#error ADS7142 ALERT and READY have to use different DIO interrupt sources.
+#endif
+
+// Each DIO interrupt source has a single handler, BDK drivers using the same
+// source would define it twice.
+#if RTE_BUTTON_HB_BTN0_INT_ENABLE == 1
+#if RTE_BUTTON_HB_BTN0_INT_SRC == RTE_APP_ICS_EV_ALERT_INT_SRC \
+    || RTE_BUTTON_HB_BTN0_INT_SRC == RTE_APP_ICS_EV_READY_INT_SRC
+#error Button 0 and ADS7142 interrupts have to be sourced from different INT sources.
+#endif
+#endif /* RTE_BUTTON_HB_BTN0_INT_ENABLE == 1 */
+
+#if RTE_BUTTON_HB_BTN1_INT_ENABLE == 1
+#if RTE_BUTTON_HB_BTN1_INT_SRC == RTE_APP_ICS_EV_ALERT_INT_SRC \
+    || RTE_BUTTON_HB_BTN1_INT_SRC == RTE_APP_ICS_EV_READY_INT_SRC
+#error Button 1 and ADS7142 interrupts have to be sourced from different INT sources.
+#endif
+#endif /* RTE_BUTTON_HB_BTN1_INT_ENABLE == 1 */
+
+#if RTE_NOA1305_ALS_INT_ENABLED == 1
+#if RTE_NOA1305_ALS_INT_SRC == RTE_APP_ICS_EV_ALERT_INT_SRC \
+    || RTE_NOA1305_ALS_INT_SRC == RTE_APP_ICS_EV_READY_INT_SRC
+#error NOA1305 and ADS7142 interrupts have to be sourced from different INT sources.
+#endif
+#endif /* RTE_NOA1305_ALS_INT_ENABLED == 1 */
+
+#endif /* RTE_APP_ICS_EV_ENABLED == 1 */
+
+#if RTE_APP_ICS_EV_ALERT_INT_SRC == 0
+#define ADS7142_ALERT_IRQn             (DIO0_IRQn)
+#define ADS7142_ALERT_ISR              DIO0_IRQHandler
+#elif RTE_APP_ICS_EV_ALERT_INT_SRC == 1
+#define ADS7142_ALERT_IRQn             (DIO1_IRQn)
+#define ADS7142_ALERT_ISR              DIO1_IRQHandler
+#elif RTE_APP_ICS_EV_ALERT_INT_SRC == 2
+#define ADS7142_ALERT_IRQn             (DIO2_IRQn)
+#define ADS7142_ALERT_ISR              DIO2_IRQHandler
+#elif RTE_APP_ICS_EV_ALERT_INT_SRC == 3
+#define ADS7142_ALERT_IRQn             (DIO3_IRQn)
+#define ADS7142_ALERT_ISR              DIO3_IRQHandler
+#endif
+
+#if RTE_APP_ICS_EV_READY_INT_SRC == 0
+#define ADS7142_READY_IRQn             (DIO0_IRQn)
+#define ADS7142_READY_ISR              DIO0_IRQHandler
+#elif RTE_APP_ICS_EV_READY_INT_SRC == 1
+#define ADS7142_READY_IRQn             (DIO1_IRQn)
+#define ADS7142_READY_ISR              DIO1_IRQHandler
+#elif RTE_APP_ICS_EV_READY_INT_SRC == 2
+#define ADS7142_READY_IRQn             (DIO2_IRQn)
+#define ADS7142_READY_ISR              DIO2_IRQHandler
+#elif RTE_APP_ICS_EV_READY_INT_SRC == 3
+#define ADS7142_READY_IRQn             (DIO3_IRQn)
+#define ADS7142_READY_ISR              DIO3_IRQHandler
+#endif
 
 static int32_t hal_error;
 
+// Alert timestamps are written only by ALERT interrupt and read only from
+// main loop. Indexes are free running so no locking is needed.
+static volatile uint64_t alert_time[ADS7142_ALERT_QUEUE_SIZE];
+static volatile uint32_t alert_head;
+static volatile uint32_t alert_tail;
+static volatile uint32_t alert_dropped;
+
+static ads7142_alert_cb_t alert_cb;
+
 static ret_t ads7142_read_reg(uint8_t dev_id, uint8_t addr, uint8_t *value)
 {
     uint8_t data[] = { OP_SINGLE_READ, addr };
@@ -50,10 +122,70 @@ static uint16_t ads7142_value_decode(uint8_t *data) {
 }
 
 static void ads7142_waitReady() {
-	// wait on the busy/ready pin
-	while (DIO_DATA->ALIAS[PIN_READY] != 0);
+	uint32_t primask = __get_PRIMASK();
+
+	// Sleep until READY interrupt instead of spinning on the busy/ready pin.
+	// Pin is checked with interrupts masked so that an edge arriving just
+	// before WFI leaves the interrupt pending and the core does not stall.
+	SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
+	__disable_irq();
+	while (DIO_DATA->ALIAS[PIN_ADS7142_READY] != 0) {
+		__WFI();
+		NVIC_ClearPendingIRQ(ADS7142_READY_IRQn);
+
+		// let other interrupts that woke up the core run
+		__set_PRIMASK(primask);
+		__disable_irq();
+	}
+	__set_PRIMASK(primask);
+}
+
+static void ads7142_irq_config() {
+	NVIC_DisableIRQ(ADS7142_ALERT_IRQn);
+	NVIC_DisableIRQ(ADS7142_READY_IRQn);
+
+	Sys_DIO_IntConfig(RTE_APP_ICS_EV_ALERT_INT_SRC,
+			DIO_DEBOUNCE_ENABLE | DIO_EVENT_RISING_EDGE | PIN_ADS7142_ALERT,
+			DIO_DEBOUNCE_SLOWCLK_DIV32, 1);
+
+	Sys_DIO_IntConfig(RTE_APP_ICS_EV_READY_INT_SRC,
+			DIO_DEBOUNCE_DISABLE | DIO_EVENT_FALLING_EDGE | PIN_ADS7142_READY,
+			DIO_DEBOUNCE_SLOWCLK_DIV32, 0);
+
+	NVIC_ClearPendingIRQ(ADS7142_ALERT_IRQn);
+	NVIC_ClearPendingIRQ(ADS7142_READY_IRQn);
+	NVIC_EnableIRQ(ADS7142_ALERT_IRQn);
+	NVIC_EnableIRQ(ADS7142_READY_IRQn);
+}
+
+#if RTE_APP_ICS_EV_ENABLED == 1
+
+static void ads7142_alert_task(void *arg) {
+	if (alert_cb != NULL) {
+		alert_cb();
+	}
 }
 
+void ADS7142_ALERT_ISR(void) {
+	uint32_t head = alert_head;
+
+	if (head - alert_tail < ADS7142_ALERT_QUEUE_SIZE) {
+		alert_time[head % ADS7142_ALERT_QUEUE_SIZE] = HAL_RTC_GetTime64();
+		alert_head = head + 1;
+	} else {
+		alert_dropped++;
+	}
+
+	// handle the alert from main loop
+	BDK_TaskSchedule(&ads7142_alert_task, NULL);
+}
+
+void ADS7142_READY_ISR(void) {
+	// Nothing to do here, the interrupt only wakes up ads7142_waitReady().
+}
+
+#endif /* RTE_APP_ICS_EV_ENABLED == 1 */
+
 static ret_t ads7142_device_reset() {
 	// send reset command
     uint8_t data[] = { OP_DEVICE_RESET };
@@ -68,6 +200,8 @@ static ret_t ads7142_device_reset() {
 }
 
 ret_t ads7142_init() {
+	ads7142_irq_config();
+
 	// wait ready
 	ads7142_waitReady();
 
@@ -192,6 +326,8 @@ ret_t ads7142_enable_alerts(bool channel0, bool channel1) {
 	if ((ret = ads7142_write_reg(ADS7142_I2C_ADDR, ALERT_DWC_EN, 0x01 /* enable window comparator */))) {
 		return ret;
 	}
+
+	return ret;
 }
 
 ret_t ads7142_autonomous_mode_configure() {
@@ -257,33 +393,30 @@ ret_t ads7142_autonomous_mode_start() {
 		return ret;
 	}
 
-	// wait for PIN_ADS7142_ALERT to get low
-    while (DIO_DATA->ALIAS[PIN_ADS7142_ALERT] == 0);
+	// Alerts are reported by ALERT interrupt, there is no need to wait here.
 
 	return ret;
 }
 
-ret_t ads7142_read_flags() {
-	uint8_t ret;
-	uint8_t highFlags;
-	uint8_t lowFlags;
-	if ((ret = ads7142_read_reg(ADS7142_I2C_ADDR, ALERT_LOW_FLAGS, &lowFlags))) {
+ret_t ads7142_read_flags(uint8_t *low_flags, uint8_t *high_flags,
+		uint16_t samples[ADS7142_PRE_ALERT_SAMPLES]) {
+	ret_t ret;
+	if ((ret = ads7142_read_reg(ADS7142_I2C_ADDR, ALERT_LOW_FLAGS, low_flags))) {
 		return ret;
 	}
 
-	if ((ret = ads7142_read_reg(ADS7142_I2C_ADDR, ALERT_HIGH_FLAGS, &highFlags))) {
+	if ((ret = ads7142_read_reg(ADS7142_I2C_ADDR, ALERT_HIGH_FLAGS, high_flags))) {
 		return ret;
 	}
 
-	uint8_t data[48];
+	uint8_t data[ADS7142_PRE_ALERT_SAMPLES * 2];
 	if ((hal_error = HAL_I2C_Read(ADS7142_I2C_ADDR, data, sizeof(data), false)) != HAL_OK)
 	{
 		return ADS7142_COMM_ERROR;
 	}
 
-	uint16_t values[24];
-	for (int i = 0; i < 48; i += 2) {
-		values[i / 2] = ads7142_value_decode(data + i);
+	for (int i = 0; i < ADS7142_PRE_ALERT_SAMPLES; ++i) {
+		samples[i] = ads7142_value_decode(data + 2 * i);
 	}
 
 	return ret;
@@ -292,3 +425,38 @@ ret_t ads7142_read_flags() {
 int32_t ads7142_get_hal_error() {
 	return hal_error;
 }
+
+void ads7142_set_alert_callback(ads7142_alert_cb_t cb) {
+	alert_cb = cb;
+}
+
+bool ads7142_alert_pop(uint64_t *time) {
+	uint32_t tail = alert_tail;
+
+	if (tail == alert_head) {
+		return false;
+	}
+
+	*time = alert_time[tail % ADS7142_ALERT_QUEUE_SIZE];
+	alert_tail = tail + 1;
+
+	return true;
+}
+
+uint32_t ads7142_alert_get_dropped() {
+	return alert_dropped;
+}
+
+void ads7142_pad_restore() {
+	Sys_DIO_Config(PIN_ADS7142_READY, DIO_MODE_GPIO_IN_0 | DIO_WEAK_PULL_UP);
+	Sys_DIO_Config(PIN_ADS7142_ALERT, DIO_MODE_GPIO_IN_0);
+
+	ads7142_irq_config();
+
+	// Edge that woke up the device was not seen by DIO interrupt logic.
+	// Leave it pending so that it is timestamped once timers are restored
+	// and interrupts are unmasked.
+	if (DIO_DATA->ALIAS[PIN_ADS7142_ALERT] != 0) {
+		NVIC_SetPendingIRQ(ADS7142_ALERT_IRQn);
+	}
+}
@@ -19,20 +19,11 @@
 enum App_StateStruct app_state = APP_STATE_INIT;
 struct stimer app_state_timer;
 
-void ledNotif(uint8_t cnt) {
-	ledNotif2(cnt, 250);
-}
+/* Bitmap of APP_EVENT_* values waiting for processing.
+ * Initial state has to be processed after reset. */
+static volatile uint32_t app_events = APP_EVENT_STATE;
 
-void ledNotif2(uint8_t cnt, uint8_t period) {
-	for (int i = 0; i < cnt; ++i) {
-		if (i >= 0) {
-			HAL_Delay(period);
-		}
-		LED_On(LED_RED);
-		HAL_Delay(period);
-		LED_Off(LED_RED);
-	}
-}
+static struct App_LoopStats app_loop_stats = { 0 };
 
 int main(void)
 {
@@ -44,7 +35,7 @@ int main(void)
     Main_Loop();
 }
 
-static void App_StateMachine(void)
+static void App_StateMachine(uint32_t events)
 {
     switch (app_state)
     {
@@ -52,6 +43,7 @@ static void App_StateMachine(void)
         TRACE_PRINTF("State: Init\r\n");
 
         stimer_init(&app_state_timer, Timer_GetContext());
+        stimer_set_slack_ms(&app_state_timer, APP_STATE_TIMER_SLACK_MS);
         /* no break */
     case APP_STATE_START_ADVERTISING:
         TRACE_PRINTF("State: Advertising start\r\n");
@@ -64,9 +56,7 @@ static void App_StateMachine(void)
         BDK_BLE_AdvertisingStart();
 
         // Signal to user.
-        LED_On(LED_RED);
-        HAL_Delay(APP_STATE_IND_LED_INTERVAL_MS);
-        LED_Off(LED_RED);
+        ledNotif2(1, APP_STATE_IND_LED_INTERVAL_MS);
 
         app_state = APP_STATE_ADVERTISING;
         break;
@@ -84,12 +74,29 @@ static void App_StateMachine(void)
 
             // Enter sleep state
             app_state = APP_STATE_SLEEP;
+
+#if RTE_APP_MOTION_WAKE_ENABLED == 1
+            // Restart advertising once the device is moved.
+            if (App_MotionWakeArm() != 0)
+            {
+                TRACE_PRINTF("State: Motion wake-up not available\r\n");
+            }
+#endif
         }
         break;
 
     case APP_STATE_SLEEP:
         TRACE_PRINTF("State: Sleep\r\n");
 
+        if ((events & APP_EVENT_MOTION) != 0)
+        {
+            App_MotionWakeDisarm();
+
+            app_state = APP_STATE_START_ADVERTISING;
+            App_SetEvent(APP_EVENT_STATE);
+            break;
+        }
+
         // Schedule next wake up with the same button check interval
         stimer_advance(&app_state_timer);
 
@@ -113,24 +120,81 @@ static void App_StateMachine(void)
     }
 }
 
+void App_SetEvent(uint32_t event)
+{
+    __atomic_fetch_or(&app_events, event, __ATOMIC_SEQ_CST);
+}
+
+const struct App_LoopStats * App_GetLoopStats(void)
+{
+    return &app_loop_stats;
+}
+
+/* Cycle counter is powered down in deep sleep and has to be enabled again
+ * after each wake-up. */
+static void App_LoopStatsEnable(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static void App_LoopStatsUpdate(uint32_t cycles)
+{
+    app_loop_stats.loop_cnt += 1;
+    app_loop_stats.last_cycles = cycles;
+    app_loop_stats.total_cycles += cycles;
+    if (cycles > app_loop_stats.max_cycles)
+    {
+        app_loop_stats.max_cycles = cycles;
+    }
+}
+
 void Main_Loop(void)
 {
     bool sleep_allowed = false;
+    uint32_t loop_start;
+    uint32_t events;
 
     TRACE_PRINTF("Main_Loop: Enter\r\n");
 
+    App_LoopStatsEnable();
+
     while (1)
     {
         /* Refresh watchdog timer. */
         Sys_Watchdog_Refresh();
 
+        loop_start = DWT->CYCCNT;
+
+        /* Poll nodes that were notified or whose timers expired. */
         CS_PollNodes();
 
+        /* Advance LED notification patterns. */
+        LedNotif_Poll();
+
+        /* Execute callbacks deferred from interrupts. */
+        BDK_TaskRunQueued();
+
         /* Execute any events that have occurred. */
         Kernel_Schedule();
 
         /* Application stuff follows here. */
-        App_StateMachine();
+        events = __atomic_exchange_n(&app_events, 0, __ATOMIC_SEQ_CST);
+        if ((events & (APP_EVENT_STATE | APP_EVENT_MOTION)) != 0
+            || (app_state_timer.is_running
+                && stimer_is_expired(&app_state_timer)))
+        {
+            App_StateMachine(events);
+        }
+
+        App_LoopStatsUpdate(DWT->CYCCNT - loop_start);
+
+        /* Handle events raised during this iteration before sleeping. */
+        if (CS_IsPollPending() || app_events != 0
+            || BDK_TaskIsQueueEmpty() == false)
+        {
+            continue;
+        }
 
         /* Set RTC wake up event to nearest timer. */
         if ( Timer_SetWakeupAtNextEvent() != APP_TIMER_ALARM_NOW)
@@ -142,15 +206,22 @@ void Main_Loop(void)
             /* Attempt to enter deep sleep mode.
              * BLE_Power_Mode_Enter will not return when deep sleep is
              * entered. */
-            ledNotif2(3, 150);
-
             __disable_irq();
 
+            /* Interrupt handlers could have raised an event after the check
+             * above. Do not go to sleep until it is handled. */
+            if (CS_IsPollPending() || app_events != 0
+                || BDK_TaskIsQueueEmpty() == false)
+            {
+                __enable_irq();
+                trace_init();
+                continue;
+            }
+
             sleep_allowed = BLE_Power_Mode_Enter(&sleep_mode_env,
                     POWER_MODE_SLEEP);
 
             __enable_irq();
-            ledNotif2(4, 150);
 
             /* Re-enable basic functionality needed by main loop until device is
              * ready to enter deep sleep. */
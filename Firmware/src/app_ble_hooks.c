@@ -20,7 +20,8 @@ void App_PeerDeviceConnected(void)
 {
     TRACE_PRINTF("PEER DEVICE CONNECTED\r\n");
 
-    app_state = APP_STATE_CONNECTED;
+    app_state = APP_STATE_START_CONNECTION;
+    App_SetEvent(APP_EVENT_STATE);
 
     ledNotif(1);
 }
@@ -32,6 +33,7 @@ void App_PeerDeviceDisconnected(void)
     CS_SetPowerMode(CS_POWER_MODE_SLEEP);
 
     app_state = APP_STATE_START_ADVERTISING;
+    App_SetEvent(APP_EVENT_STATE);
 
     ledNotif(3);
 }
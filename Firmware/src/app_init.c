@@ -16,6 +16,7 @@
 #include "RTE_app_config.h"
 
 #include "calibration.h"
+#include "ads7142.h"
 
 
 struct sleep_mode_env_tag sleep_mode_env;
@@ -159,6 +160,15 @@ void Device_Initialize_WakeUp(void)
     /* Restore DIO pad configuration before disabling pad retention. */
     LED_Initialize(LED_RED);
     LED_Initialize(ANALOG_POWER);
+#if RTE_APP_MOTION_WAKE_ENABLED == 1
+    if (App_MotionWakeIsArmed())
+    {
+        BHI160_NDOF_PadRestore();
+    }
+#endif
+#if RTE_APP_ICS_EV_ENABLED == 1
+    ads7142_pad_restore();
+#endif
 
     /* Turn off pad retention */
     ACS_WAKEUP_CTRL->PADS_RETENTION_EN_BYTE = PADS_RETENTION_ENABLE_BYTE;
@@ -175,6 +185,9 @@ void Device_Initialize_WakeUp(void)
     /* Stop masking interrupts. */
     __set_PRIMASK(PRIMASK_ENABLE_INTERRUPTS);
 
+    /* Account time spent in deep sleep. */
+    Timer_UpdateSleepStats();
+
     /* Mask all interrupts */
     BBIF_CTRL->WAKEUP_REQ_ALIAS = 1;
     __disable_irq();
@@ -199,18 +212,34 @@ void Device_Initialize_WakeUp(void)
     switch (ACS_WAKEUP_STATE->WAKEUP_SRC_BYTE)
     {
     case WAKEUP_DUE_TO_RTC_ALARM_BYTE:
-    	ledNotif(1);
         TRACE_PRINTF("RTC\r\n");
         break;
     case WAKEUP_DUE_TO_BB_TIMER_BYTE:
-    	ledNotif(2);
         TRACE_PRINTF("BB_TIM\r\n");
         break;
     default:
-    	ledNotif(3);
         TRACE_PRINTF("other (0x%x)\r\n", ACS_WAKEUP_STATE->WAKEUP_SRC_BYTE);
         break;
     }
+
+    const struct Timer_Stats *timer_stats = Timer_GetStats();
+    TRACE_PRINTF("Wake-ups: %lu / %lu sleeps, asleep %lu s\r\n",
+            timer_stats->wakeup_cnt, timer_stats->sleep_cnt,
+            (uint32_t)(timer_stats->sleep_ticks / HAL_RTC_XTAL_FREQ));
+
+    const struct App_LoopStats *loop_stats = App_GetLoopStats();
+    if (loop_stats->loop_cnt > 0)
+    {
+        TRACE_PRINTF("Main loop: %lu iterations, %lu cycles avg, %lu max\r\n",
+                loop_stats->loop_cnt,
+                (uint32_t)(loop_stats->total_cycles / loop_stats->loop_cnt),
+                loop_stats->max_cycles);
+    }
+
+    const struct BDK_TaskQueueStats *queue_stats = BDK_TaskGetQueueStats();
+    TRACE_PRINTF("Task queue: %lu queued, %lu overflows, %lu max depth\r\n",
+            queue_stats->queued_cnt, queue_stats->overflow_cnt,
+            queue_stats->high_water);
 #endif
 
     /* Main application loop */
@@ -256,6 +285,9 @@ void App_Env_Initialize(void)
     LED_Initialize(LED_RED);
     LED_Initialize(ANALOG_POWER);
 
+    /* LED notifications are played using application timer. */
+    LedNotif_Initialize(Timer_GetContext());
+
     Sys_DIO_Config(PIN_ADS7142_ALERT, DIO_MODE_DISABLE );
     Sys_DIO_Config(PIN_ADS7142_READY, DIO_MODE_DISABLE );
 
@@ -282,10 +314,17 @@ void App_Env_Initialize(void)
 	analogOn();
 	HAL_Delay(500);
 
+    /* Subscriptions of CS properties are driven by application timer. */
+    CS_SetTimerContext(Timer_GetContext());
+
     /** init ADS7142 **/
 #if RTE_APP_ICS_EV_ENABLED == 1
     CS_RegisterNode(CSN_LP_ADS7142_Create(Timer_GetContext()));
 #endif
 
+#if RTE_APP_ICS_VB_ENABLED == 1
+    CS_RegisterNode(CSN_LP_VB_Create());
+#endif
+
     TRACE_PRINTF("Initializing sensors done.\r\n");
 }
@@ -0,0 +1,124 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+//-----------------------------------------------------------------------------
+
+#include <BDK.h>
+#include <api/led_api.h>
+
+#include "app_led.h"
+
+struct LedNotif_Pattern
+{
+    uint8_t cnt;
+    uint8_t period;
+};
+
+static struct LedNotif_Pattern led_queue[APP_LED_QUEUE_SIZE];
+static uint8_t led_queue_head = 0;
+static uint8_t led_queue_len = 0;
+
+/* Remaining LED off / on phases of the pattern being played. */
+static uint16_t led_phases_left = 0;
+static uint8_t led_period = 0;
+
+static struct stimer led_timer;
+static bool led_timer_ready = false;
+
+void LedNotif_Initialize(struct stimer_ctx *ctx)
+{
+    stimer_init(&led_timer, ctx);
+    led_timer_ready = true;
+    led_phases_left = 0;
+}
+
+void LedNotif_Poll(void)
+{
+    if (led_timer_ready == false || LedNotif_IsBusy() == false)
+    {
+        return;
+    }
+
+    // Wait for end of current phase.
+    if (led_timer.is_running && stimer_is_expired(&led_timer) == false)
+    {
+        return;
+    }
+
+    if (led_phases_left == 0)
+    {
+        LED_Off(LED_RED);
+
+        if (led_queue_len == 0)
+        {
+            stimer_stop(&led_timer);
+            return;
+        }
+
+        // Start next pattern.
+        led_period = led_queue[led_queue_head].period;
+        led_phases_left = 2 * led_queue[led_queue_head].cnt;
+        led_queue_head = (led_queue_head + 1) % APP_LED_QUEUE_SIZE;
+        led_queue_len -= 1;
+
+        if (led_phases_left == 0)
+        {
+            return;
+        }
+    }
+
+    led_phases_left -= 1;
+
+    // Every blink starts with off phase and ends with on phase.
+    if ((led_phases_left & 1) == 0)
+    {
+        LED_On(LED_RED);
+    }
+    else
+    {
+        LED_Off(LED_RED);
+    }
+
+    stimer_expire_from_now_ms(&led_timer, led_period);
+}
+
+bool LedNotif_IsBusy(void)
+{
+    // Timer keeps running during the last phase of a pattern.
+    return (led_queue_len > 0) || led_timer.is_running;
+}
+
+void ledNotif(uint8_t cnt)
+{
+    ledNotif2(cnt, 250);
+}
+
+void ledNotif2(uint8_t cnt, uint8_t period)
+{
+    uint8_t tail;
+
+    if (led_queue_len < APP_LED_QUEUE_SIZE)
+    {
+        tail = (led_queue_head + led_queue_len) % APP_LED_QUEUE_SIZE;
+        led_queue[tail].cnt = cnt;
+        led_queue[tail].period = period;
+        led_queue_len += 1;
+    }
+
+    // Start playing right away when idle. Otherwise nothing would schedule
+    // the timer if the pattern was queued after LedNotif_Poll in this main
+    // loop iteration and the device could go to sleep before playing it.
+    if (led_timer.is_running == false)
+    {
+        LedNotif_Poll();
+    }
+}
@@ -0,0 +1,112 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+//-----------------------------------------------------------------------------
+
+#include <BHI160_NDOF.h>
+
+#include "app.h"
+
+/* Significant motion is a one-shot sensor, any non-zero rate enables it. */
+#define APP_MOTION_SAMPLE_RATE         (1)
+
+static bool app_motion_armed = false;
+static bool app_motion_callback_installed = false;
+
+static void App_MotionCallback(bhy_data_generic_t *data,
+        bhy_virtual_sensor_t sensor)
+{
+    if (app_motion_armed)
+    {
+        App_SetEvent(APP_EVENT_MOTION);
+    }
+}
+
+int32_t App_MotionWakeArm(void)
+{
+    int32_t retval;
+
+    if (app_motion_armed)
+    {
+        return BHY_SUCCESS;
+    }
+
+    retval = BHI160_NDOF_Initialize();
+    if (retval != BHY_SUCCESS)
+    {
+        return retval;
+    }
+
+    if (app_motion_callback_installed == false)
+    {
+        retval = bhy_install_sensor_callback(VS_TYPE_SIGNIFICANT_MOTION,
+                VS_WAKEUP, &App_MotionCallback);
+        if (retval != BHY_SUCCESS)
+        {
+            return retval;
+        }
+        app_motion_callback_installed = true;
+    }
+
+    retval = BHI160_NDOF_AcquireNormalMode();
+    if (retval != BHY_SUCCESS)
+    {
+        return retval;
+    }
+
+    retval = bhy_enable_virtual_sensor(VS_TYPE_SIGNIFICANT_MOTION, VS_WAKEUP,
+            APP_MOTION_SAMPLE_RATE, 0, VS_FLUSH_NONE, 0, 0);
+    if (retval != BHY_SUCCESS)
+    {
+        BHI160_NDOF_ReleaseNormalMode();
+        return retval;
+    }
+
+    app_motion_armed = true;
+
+    return BHY_SUCCESS;
+}
+
+void App_MotionWakeDisarm(void)
+{
+    if (app_motion_armed)
+    {
+        app_motion_armed = false;
+
+        // Sensor disables itself after it fires, disable it also for other
+        // reasons of disarming.
+        bhy_disable_virtual_sensor(VS_TYPE_SIGNIFICANT_MOTION, VS_WAKEUP);
+        BHI160_NDOF_ReleaseNormalMode();
+    }
+}
+
+bool App_MotionWakeIsArmed(void)
+{
+    return app_motion_armed;
+}
+
+uint32_t App_MotionWakeGetWakeupCfg(void)
+{
+    switch ((int) PIN_INT_BHI160)
+    {
+    case PIN_DIO0:
+        return WAKEUP_DIO0_ENABLE | WAKEUP_DIO0_RISING;
+    case PIN_DIO1:
+        return WAKEUP_DIO1_ENABLE | WAKEUP_DIO1_RISING;
+    case PIN_DIO2:
+        return WAKEUP_DIO2_ENABLE | WAKEUP_DIO2_RISING;
+    case PIN_DIO3:
+        return WAKEUP_DIO3_ENABLE | WAKEUP_DIO3_RISING;
+    default:
+        return 0;
+    }
+}
@@ -65,15 +65,23 @@ void Sleep_Mode_Configure(struct sleep_mode_env_tag *sleep_env)
      *    WAKEUP_DCDC_OVERLOAD_[ENABLE | DISABLE],
      *    WAKEUP_WAKEUP_PAD_[RISING | FALLING],
      *    WAKEUP_DIO*_[RISING | FALLING],
-     *    WAKEUP_DIO*_[ENABLE | DISABLE] */
+     *    WAKEUP_DIO*_[ENABLE | DISABLE]
+     *
+     * DIO2 is ALERT and DIO3 is BUSY/RDY of ADS7142. */
     sleep_mode_init_env.wakeup_cfg = // WAKEUP_DELAY_64       |
                                      WAKEUP_WAKEUP_PAD_RISING |
-                                     WAKEUP_DIO3_DISABLE      |
+                                     WAKEUP_DIO3_ENABLE       |
+                                     WAKEUP_DIO3_FALLING      |
 									 WAKEUP_DIO2_ENABLE  	  |
 									 WAKEUP_DIO2_RISING       |
                                      WAKEUP_DIO1_DISABLE      |
                                      WAKEUP_DIO0_DISABLE;
 
+#if RTE_APP_MOTION_WAKE_ENABLED == 1
+    /* BHI160 interrupt wakes up the device when it is moved. */
+    sleep_mode_init_env.wakeup_cfg |= App_MotionWakeGetWakeupCfg();
+#endif
+
     /* Set wake-up control/status registers, use
      *    PADS_RETENTION_[ENABLE | DISABLE],
      *    BOOT_FLASH_APP_REBOOT_[ENABLE | DISABLE],
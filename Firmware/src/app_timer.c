@@ -24,44 +24,13 @@
 
 struct stimer_ctx app_timer_ctx = { 0 };
 
-static bool is_duration_ge(struct stimer_duration * lhs,
-        struct stimer_duration * rhs)
-{
-    bool is_ge = false;
-    if (lhs->seconds > rhs->seconds)
-    {
-        is_ge = true;
-    }
-    else if (lhs->seconds == rhs->seconds)
-    {
-        if (lhs->nanoseconds >= rhs->nanoseconds)
-        {
-            is_ge = true;
-        }
-    }
-    return is_ge;
-}
-
-static inline void duration_diff(struct stimer_duration * lhs,
-        struct stimer_duration *rhs, struct stimer_duration *result)
-{
-    result->seconds = rhs->seconds - lhs->seconds;
+static struct Timer_Stats app_timer_stats = { 0 };
 
-    if (rhs->nanoseconds >= lhs->nanoseconds)
-    {
-        result->nanoseconds = rhs->nanoseconds - lhs->nanoseconds;
-    }
-    else
-    {
-        result->nanoseconds = 1000000000U + rhs->nanoseconds - lhs->nanoseconds;
-        result->seconds -= 1;
-    }
-}
+/* RTC time when device last attempted to enter deep sleep. */
+static uint32_t app_timer_sleep_start = 0;
 
-static inline bool duration_is_zero(struct stimer_duration *dur)
-{
-    return (dur->seconds == 0) && (dur->nanoseconds == 0);
-}
+/* Set when wake-up from deep sleep was not accounted yet. */
+static bool app_timer_woken = false;
 
 void Timer_Initialize(void)
 {
@@ -74,71 +43,77 @@ void Timer_Initialize(void)
 void Timer_Wakeup(void)
 {
     HAL_RTC_Wakeup();
+
+    app_timer_woken = true;
 }
 
-int32_t Timer_SetWakeupAtNextEvent(void)
+void Timer_UpdateSleepStats(void)
 {
-    struct stimer_duration diff;
-    int32_t retval = APP_TIMER_NO_EVENT;
-    struct stimer_duration ts_next_diff = {UINT32_MAX, UINT32_MAX};
-    struct stimer *ts_next = NULL;
+    if (app_timer_woken == true)
+    {
+        app_timer_woken = false;
 
-    // Update timestamps of all registered timers to the same checkpoint.
-    stimer_execute_context(&app_timer_ctx);
+        app_timer_stats.wakeup_cnt += 1;
+        app_timer_stats.sleep_ticks += HAL_RTC_GetTime(NULL)
+                - app_timer_sleep_start;
+    }
+}
+
+const struct Timer_Stats * Timer_GetStats(void)
+{
+    return &app_timer_stats;
+}
+
+int32_t Timer_SetWakeupAtNextEvent(void)
+{
+    int32_t retval;
+    uint32_t counts;
+    uint32_t ticks;
 
     // Find timer which will expire next.
-    for (struct stimer *ts = app_timer_ctx.root; ts != NULL; ts = ts->next)
+    if (stimer_get_next_expiry(&app_timer_ctx, &counts) == false)
     {
-        if (ts->is_running && !duration_is_zero(&ts->expire_interval))
-        {
-            if (is_duration_ge(&ts->elapsed, &ts->expire_interval))
-            {
-                // There is timer event that is already expired.
-                retval = APP_TIMER_ALARM_NOW;
-                return retval;
-            }
-            else
-            {
-                duration_diff(&ts->elapsed, &ts->expire_interval, &diff);
-
-                if (!is_duration_ge(&diff, &ts_next_diff))
-                {
-                    ts_next_diff = diff;
-                    ts_next = ts;
-                }
-            }
-        }
+        // No timer event is scheduled
+        app_timer_stats.sleep_cnt += 1;
+        app_timer_sleep_start = HAL_RTC_GetTime(NULL);
+
+        return APP_TIMER_NO_EVENT;
     }
 
-    // Set RTC wake up event for found timer event.
-    if (ts_next != NULL)
+    if (counts == 0)
     {
-        uint32_t ticks = HAL_RTC_S_TO_TICKS(ts_next_diff.seconds)
-                + HAL_RTC_NS_TO_TICKS(ts_next_diff.nanoseconds) + 1;
+        // There is timer event that is already expired.
+        return APP_TIMER_ALARM_NOW;
+    }
 
-        if (ticks <= APP_TIMER_KEEP_AWAKE_THRESH)
-        {
-            retval = APP_TIMER_ALARM_NOW;
+    // Set RTC wake up event for found timer event.
+    // Timer context counts RTC ticks.
+    ticks = counts + 1;
+    if (ticks <= APP_TIMER_KEEP_AWAKE_THRESH)
+    {
+        retval = APP_TIMER_ALARM_NOW;
 
 #ifdef _TIMER_DEBUG
-            TRACE_PRINTF("%s:%d: Next event below threshold.\r\n", __FUNCTION__,
-                    __LINE__);
+        TRACE_PRINTF("%s:%d: Next event below threshold.\r\n", __FUNCTION__,
+                __LINE__);
 #endif
-        }
-        else
-        {
-            HAL_RTC_SetAlarmTicks(ticks);
+    }
+    else
+    {
+        app_timer_stats.sleep_cnt += 1;
+        app_timer_stats.alarm_cnt += 1;
+        app_timer_sleep_start = HAL_RTC_GetTime(NULL);
+
+        HAL_RTC_SetAlarmTicks(ticks);
 
 #ifdef _TIMER_DEBUG
-            TRACE_PRINTF("%s:%d: Setting RTC alarm to %lu ticks.\r\n",
-                    __FUNCTION__, __LINE__, ticks);
+        TRACE_PRINTF("%s:%d: Setting RTC alarm to %lu ticks.\r\n",
+                __FUNCTION__, __LINE__, ticks);
 #endif
-            TRACE_PRINTF("Next RTC alarm %.4f sec.\r\n", ticks / 32768.0f);
+        TRACE_PRINTF("Next RTC alarm %.4f sec.\r\n", ticks / 32768.0f);
 
-            retval = APP_TIMER_ALARM_SET;
-        }
+        retval = APP_TIMER_ALARM_SET;
     }
 
-    // No timer event is scheduled
     return retval;
 }
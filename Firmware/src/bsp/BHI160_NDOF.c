@@ -21,6 +21,7 @@
 #include "BDK.h"
 
 #include <BHI160_NDOF.h>
+#include <EventCallback.h>
 #include <bhy1_firmware.h>
 
 #include <RTE_HB_BHI160_NDOF.h>
@@ -58,15 +59,33 @@
 //-----------------------------------------------------------------------------
 
 static uint32_t bhi160_timestamp = 0;
+static uint32_t bhi160_wakeup_timestamp = 0;
 
 static uint16_t bhi160_accel_dyn_range = 4;
 static uint16_t bhi160_gyro_dyn_range = 2000;
 static uint16_t bhi160_mag_dyn_range = 1000;
 
-uint8_t bhi160_fifo[FIFO_SIZE];
-uint8_t bhi160_bytes_left_in_fifo = 0;
+/* Circular buffer for FIFO data read from BHI160.
+ * Extra MAX_PACKET_LENGTH bytes at the end mirror the start of the buffer so
+ * that packets crossing the wrap point can be parsed in place. */
+uint8_t bhi160_fifo[FIFO_SIZE + MAX_PACKET_LENGTH];
+
+/* Position of the first unparsed byte in bhi160_fifo. */
+uint16_t bhi160_fifo_rd = 0;
+
+/* Number of unparsed bytes in bhi160_fifo. */
+uint16_t bhi160_fifo_len = 0;
+
+/* Number of bytes of current FIFO transfer still waiting in BHI160. */
 uint16_t bytes_remaining = 0;
 
+static struct BHI160_NDOF_FifoStats bhi160_fifo_stats = { 0 };
+
+static bool bhi160_initialized = false;
+
+/* Number of users that requested normal power mode. */
+static uint32_t bhi160_normal_mode_cnt = 0;
+
 
 
 
@@ -79,6 +98,11 @@ static void BHI160_NDOF_TimestampCallback(bhy_data_scalar_u16_t *data)
     bhy_update_system_timestamp(data, &bhi160_timestamp);
 }
 
+static void BHI160_NDOF_WakeupTimestampCallback(bhy_data_scalar_u16_t *data)
+{
+    bhy_update_system_timestamp(data, &bhi160_wakeup_timestamp);
+}
+
 static void BHI160_NDOF_DynamicRangeCallback(bhy_data_meta_event_t *data, bhy_meta_event_type_t event)
 {
     if (event == BHY_META_EVENT_TYPE_DYNAMIC_RANGE_CHANGED)
@@ -95,61 +119,160 @@ static void BHI160_NDOF_DynamicRangeCallback(bhy_data_meta_event_t *data, bhy_me
             bhi160_accel_dyn_range = accel.accel_dynamic_range;
             bhi160_gyro_dyn_range = gyro.gyro_dynamic_range;
             bhi160_mag_dyn_range = mag.mag_dynamic_range;
+
+            EventCallback_Call(RTE_HB_BHI160_NDOF_RANGE_EVENT_ID);
         }
     }
 }
 
-static void BHI160_NDOF_FifoRoutine(void *arg)
+/* Reads available FIFO data from BHI160 into free space of the circular
+ * buffer.
+ *
+ * bhy_read_fifo limits the transfer to the number of bytes BHI160 reports as
+ * available, so at most two reads are done when free space wraps around.
+ *
+ * Returns number of bytes read. */
+static uint16_t BHI160_NDOF_FifoRead(void)
 {
-    (void)arg;
-    uint8_t *fifoptr = bhi160_fifo;
+    uint16_t wr;
+    uint16_t space;
+    uint16_t bytes_read;
+    uint16_t total = 0;
+
+    for (int i = 0; i < 2 && bhi160_fifo_len < FIFO_SIZE; ++i)
+    {
+        wr = bhi160_fifo_rd + bhi160_fifo_len;
+        if (wr >= FIFO_SIZE)
+        {
+            wr -= FIFO_SIZE;
+        }
+
+        // Contiguous free space starting at write position.
+        space = FIFO_SIZE - bhi160_fifo_len;
+        if (space > FIFO_SIZE - wr)
+        {
+            space = FIFO_SIZE - wr;
+        }
+
+        bytes_read = 0;
+        bhy_read_fifo(bhi160_fifo + wr, space, &bytes_read, &bytes_remaining);
+        bhi160_fifo_len += bytes_read;
+        total += bytes_read;
+
+        if (bytes_read < space || bytes_remaining == 0)
+        {
+            break;
+        }
+    }
+
+    return total;
+}
+
+/* Parses complete packets stored in the circular buffer. */
+static void BHI160_NDOF_FifoParse(void)
+{
+    uint8_t *fifoptr;
+    uint16_t length;
+    uint16_t contiguous;
+    uint16_t consumed;
     bhy_data_type_t packet_type = BHY_DATA_TYPE_PADDING;
     bhy_data_generic_t fifo_packet;
-    uint16_t bytes_read = 0;
-    BHY_RETURN_FUNCTION_TYPE result;
+    BHY_RETURN_FUNCTION_TYPE result = BHY_SUCCESS;
 
-//    while (!(DIO->DATA & (1 << PIN_INT_BHI160)) && !bytes_remaining)
-//    {
-//
-//    }
+    /* the logic here is that if doing a partial parsing of the fifo, then we should not parse  */
+    /* the last 18 bytes (max length of a packet) so that we don't try to parse an incomplete   */
+    /* packet */
+    while ((result == BHY_SUCCESS)
+            && (bhi160_fifo_len > (bytes_remaining ? MAX_PACKET_LENGTH : 0)))
+    {
+        fifoptr = bhi160_fifo + bhi160_fifo_rd;
+        length = bhi160_fifo_len;
 
-    bhy_read_fifo(bhi160_fifo + bhi160_bytes_left_in_fifo,
-            FIFO_SIZE - bhi160_bytes_left_in_fifo, &bytes_read,
-            &bytes_remaining);
-    bytes_read += bhi160_bytes_left_in_fifo;
+        contiguous = FIFO_SIZE - bhi160_fifo_rd;
+        if (length > contiguous)
+        {
+            if (contiguous < MAX_PACKET_LENGTH)
+            {
+                /* Next packet may cross the wrap point, mirror start of the
+                 * buffer behind its end. */
+                length -= contiguous;
+                if (length > MAX_PACKET_LENGTH)
+                {
+                    length = MAX_PACKET_LENGTH;
+                }
+                memcpy(bhi160_fifo + FIFO_SIZE, bhi160_fifo, length);
+                length += contiguous;
+            }
+            else
+            {
+                length = contiguous;
+            }
+        }
 
-    do
-    {
         /* this function will call callbacks that are registered */
-        result = bhy_parse_next_fifo_packet(&fifoptr, &bytes_read, &fifo_packet,
+        consumed = length;
+        result = bhy_parse_next_fifo_packet(&fifoptr, &length, &fifo_packet,
                 &packet_type);
+        consumed -= length;
+
+        bhi160_fifo_len -= consumed;
+        bhi160_fifo_rd += consumed;
+        if (bhi160_fifo_rd >= FIFO_SIZE)
+        {
+            bhi160_fifo_rd -= FIFO_SIZE;
+        }
 
         /* prints all the debug packets */
         if (packet_type == BHY_DATA_TYPE_DEBUG)
         {
             bhy_print_debug_packet(&fifo_packet.data_debug, bhy_printf);
         }
+    }
 
-        /* the logic here is that if doing a partial parsing of the fifo, then we should not parse  */
-        /* the last 18 bytes (max length of a packet) so that we don't try to parse an incomplete   */
-        /* packet */
-    } while ((result == BHY_SUCCESS)
-            && (bytes_read > (bytes_remaining ? MAX_PACKET_LENGTH : 0)));
+    /* Whole FIFO content was read, drop anything that could not be parsed. */
+    if (bytes_remaining == 0)
+    {
+        bhi160_fifo_len = 0;
+    }
+
+    /* Restart from the beginning of the buffer when it is empty to keep reads
+     * contiguous. */
+    if (bhi160_fifo_len == 0)
+    {
+        bhi160_fifo_rd = 0;
+    }
+}
 
-    bhi160_bytes_left_in_fifo = 0;
+static void BHI160_NDOF_FifoRoutine(void *arg)
+{
+    (void)arg;
+    uint16_t bytes_read;
 
-    if (bytes_remaining)
+    /* Drain whole FIFO so that batched samples are processed in a single
+     * wake-up. */
+    do
     {
-        /* shifts the remaining bytes to the beginning of the buffer */
-        while (bhi160_bytes_left_in_fifo < bytes_read)
+        bytes_read = BHI160_NDOF_FifoRead();
+        bhi160_fifo_stats.byte_cnt += bytes_read;
+
+        BHI160_NDOF_FifoParse();
+
+        /* Buffer is full of data that cannot be parsed. */
+        if (bytes_read == 0)
         {
-            bhi160_fifo[bhi160_bytes_left_in_fifo++] = *(fifoptr++);
+            break;
         }
-    }
+    } while (bytes_remaining > 0);
+
+    bhi160_fifo_stats.drain_cnt += 1;
+
+    EventCallback_Call(RTE_HB_BHI160_NDOF_FIFO_EVENT_ID);
 }
 
 void BHI160_NDOF_ISR(void)
 {
+    bhi160_fifo_stats.irq_cnt += 1;
+
     BDK_TaskSchedule(&BHI160_NDOF_FifoRoutine, NULL);
 }
 
@@ -157,6 +280,11 @@ int32_t BHI160_NDOF_Initialize(void)
 {
     int32_t retval = BHY_SUCCESS;
 
+    if (bhi160_initialized)
+    {
+        return BHY_SUCCESS;
+    }
+
     /* Configure BHI160 interrupt pin. */
     NVIC_DisableIRQ(BHI160_NDOF_IRQn);
 
@@ -206,6 +334,12 @@ int32_t BHI160_NDOF_Initialize(void)
     {
         return retval;
     }
+    retval = bhy_install_timestamp_callback(VS_WAKEUP,
+            &BHI160_NDOF_WakeupTimestampCallback);
+    if (retval != BHY_SUCCESS)
+    {
+        return retval;
+    }
 
     /* Listen for dynamic range changes of physical sensors. */
     retval = bhy_install_meta_event_callback(BHY_META_EVENT_TYPE_DYNAMIC_RANGE_CHANGED, &BHI160_NDOF_DynamicRangeCallback);
@@ -219,6 +353,15 @@ int32_t BHI160_NDOF_Initialize(void)
 
     BDK_TaskSchedule(&BHI160_NDOF_FifoRoutine, NULL);
 
+    /* Stay in standby until the first user requests normal mode. */
+    retval = BHI160_NDOF_SetPowerMode(BHI160_NDOF_PM_STANDBY);
+    if (retval != BHY_SUCCESS)
+    {
+        return retval;
+    }
+
+    bhi160_initialized = true;
+
     return retval;
 }
 
@@ -231,6 +374,13 @@ void BHI160_NDOF_PadRestore(void)
             DIO_DEBOUNCE_SLOWCLK_DIV32, 1);
 
     NVIC_EnableIRQ(BHI160_NDOF_IRQn);
+
+    /* Edge that woke up the device was not seen by DIO interrupt logic, read
+     * out data that is already waiting. */
+    if ((DIO->DATA & (1 << PIN_INT_BHI160)) != 0)
+    {
+        BDK_TaskSchedule(&BHI160_NDOF_FifoRoutine, NULL);
+    }
 }
 
 uint32_t BHI160_NDOF_GetTimestamp(void)
@@ -238,6 +388,11 @@ uint32_t BHI160_NDOF_GetTimestamp(void)
     return bhi160_timestamp;
 }
 
+uint32_t BHI160_NDOF_GetWakeupTimestamp(void)
+{
+    return bhi160_wakeup_timestamp;
+}
+
 int32_t BHI160_NDOF_SetPowerMode(enum BHI160_NDOF_PowerMode power_mode)
 {
     int32_t retval = BHY_SUCCESS;
@@ -269,6 +424,39 @@ int32_t BHI160_NDOF_SetPowerMode(enum BHI160_NDOF_PowerMode power_mode)
     return retval;
 }
 
+int32_t BHI160_NDOF_AcquireNormalMode(void)
+{
+    int32_t retval = BHY_SUCCESS;
+
+    if (bhi160_normal_mode_cnt == 0)
+    {
+        retval = BHI160_NDOF_SetPowerMode(BHI160_NDOF_PM_NORMAL);
+    }
+
+    if (retval == BHY_SUCCESS)
+    {
+        bhi160_normal_mode_cnt += 1;
+    }
+
+    return retval;
+}
+
+int32_t BHI160_NDOF_ReleaseNormalMode(void)
+{
+    if (bhi160_normal_mode_cnt == 0)
+    {
+        return BHY_SUCCESS;
+    }
+
+    bhi160_normal_mode_cnt -= 1;
+    if (bhi160_normal_mode_cnt == 0)
+    {
+        return BHI160_NDOF_SetPowerMode(BHI160_NDOF_PM_STANDBY);
+    }
+
+    return BHY_SUCCESS;
+}
+
 int32_t BHI160_NDOF_EnableSensor(enum BHI160_NDOF_Sensor sensor,
         BHI160_NDOF_SensorCallback cb, uint16_t sample_rate)
 {
@@ -298,3 +486,13 @@ uint16_t BHI160_NDOF_GetMagDynamicRange(void)
 {
     return bhi160_mag_dyn_range;
 }
+
+int32_t BHI160_NDOF_SetFifoWatermark(uint16_t watermark)
+{
+    return bhy_set_fifo_water_mark(BHY_FIFO_WATER_MARK_WAKEUP, watermark);
+}
+
+const struct BHI160_NDOF_FifoStats * BHI160_NDOF_GetFifoStats(void)
+{
+    return &bhi160_fifo_stats;
+}
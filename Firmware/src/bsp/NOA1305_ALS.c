@@ -263,9 +263,9 @@ int32_t NOA1305_ALS_EnableInterrupt(uint32_t lux_threshold)
 {
     int32_t retval = NOA1305_OK;
 
+#if RTE_NOA1305_ALS_INT_ENABLED == 1
     NVIC_DisableIRQ(NOA1305_ALS_IRQn);
 
-#if RTE_NOA1305_ALS_INT_ENABLED == 1
     // Set int threshold
     retval = noa1305_set_int_threshold_lux(lux_threshold, &noa_dev);
     if (retval == NOA1305_OK)
@@ -54,6 +54,8 @@ void BDK_Schedule(void)
 {
     BDK_TaskStart();
 
+    BDK_TaskRunQueued();
+
     Kernel_Schedule();
 
     Sys_Watchdog_Refresh();
@@ -63,6 +65,8 @@ void BDK_ScheduleNoWdt(void)
 {
     BDK_TaskStart();
 
+    BDK_TaskRunQueued();
+
     Kernel_Schedule();
 }
 
@@ -30,6 +30,12 @@
 // DEFINES / CONSTANTS
 //-----------------------------------------------------------------------------
 
+#if (RTE_APP_TASK_QUEUE_SIZE & (RTE_APP_TASK_QUEUE_SIZE - 1)) != 0
+#error "RTE_APP_TASK_QUEUE_SIZE has to be power of two."
+#endif
+
+#define BDK_TASK_QUEUE_MASK            (RTE_APP_TASK_QUEUE_SIZE - 1)
+
 enum BDK_TaskRunState
 {
     BDK_TASK_STATE_RESET = 0,
@@ -43,6 +49,33 @@ struct BDK_TimerCmd
     void *arg;
 };
 
+/** Slot of the deferred callback queue.
+ *
+ * Sequence number tells which side owns the slot:
+ * - seq == pos     - Slot is free for producer writing position pos.
+ * - seq == pos + 1 - Slot holds callback for consumer reading position pos.
+ */
+struct BDK_TaskQueueSlot
+{
+    volatile uint32_t seq;
+    BDK_TaskCallback cb;
+    void *arg;
+};
+
+/** Bounded lock-free queue of deferred callbacks.
+ *
+ * Producers (any interrupt or main loop) reserve a slot by moving tail with
+ * compare-and-swap, so an interrupt can preempt another producer.
+ * Main loop is the only consumer and owns head.
+ */
+struct BDK_TaskQueue
+{
+    struct BDK_TaskQueueSlot slot[RTE_APP_TASK_QUEUE_SIZE];
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    struct BDK_TaskQueueStats stats;
+};
+
 struct BDK_Task_Resources
 {
     uint8_t run_state;
@@ -70,6 +103,8 @@ static int BDK_TimerMsgHandler(ke_msg_id_t const msg_id, void const *param,
 
 struct BDK_Task_Resources task_res = { 0 };
 
+static struct BDK_TaskQueue task_queue;
+
 //-----------------------------------------------------------------------------
 // FUNCTION DEFINITIONS
 //-----------------------------------------------------------------------------
@@ -89,6 +124,12 @@ void BDK_TaskInit(void)
         task_res.task_handle.state_max = 1;
         task_res.task_handle.idx_max = 1;
 
+        memset(&task_queue, 0, sizeof(task_queue));
+        for (uint32_t i = 0; i < RTE_APP_TASK_QUEUE_SIZE; ++i)
+        {
+            task_queue.slot[i].seq = i;
+        }
+
         task_res.run_state = BDK_TASK_STATE_INITIALIZED;
 
         BDK_TaskAddMsgHandler(KE_MSG_DEFAULT_HANDLER, &BDK_DefaultMsgHandler);
@@ -134,21 +175,151 @@ ke_msg_id_t BDK_TaskAllocateMsgId(void)
     return id;
 }
 
+/* Updates maximum queue depth. Can be called from multiple contexts. */
+static void BDK_TaskQueueUpdateHighWater(uint32_t depth)
+{
+    uint32_t high_water = __atomic_load_n(&task_queue.stats.high_water,
+            __ATOMIC_RELAXED);
+
+    while (depth > high_water)
+    {
+        if (__atomic_compare_exchange_n(&task_queue.stats.high_water,
+                &high_water, depth, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            break;
+        }
+    }
+}
+
+/* Adds callback to the queue.
+ * Returns false if the queue is full. */
+static bool BDK_TaskQueuePush(BDK_TaskCallback cb, void *arg)
+{
+    struct BDK_TaskQueueSlot *slot;
+    uint32_t pos;
+    uint32_t seq;
+    int32_t diff;
+
+    pos = __atomic_load_n(&task_queue.tail, __ATOMIC_RELAXED);
+    while (1)
+    {
+        slot = &task_queue.slot[pos & BDK_TASK_QUEUE_MASK];
+        seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        diff = (int32_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            // Slot is free, try to reserve it. On failure pos is updated to
+            // the current tail.
+            if (__atomic_compare_exchange_n(&task_queue.tail, &pos, pos + 1,
+                    true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // Slot still holds callback from previous lap.
+            return false;
+        }
+        else
+        {
+            // Another producer reserved this slot in the meantime.
+            pos = __atomic_load_n(&task_queue.tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    slot->cb = cb;
+    slot->arg = arg;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+
+    __atomic_fetch_add(&task_queue.stats.queued_cnt, 1, __ATOMIC_RELAXED);
+    BDK_TaskQueueUpdateHighWater(pos + 1
+            - __atomic_load_n(&task_queue.head, __ATOMIC_RELAXED));
+
+    return true;
+}
+
+/* Removes oldest callback from the queue.
+ * Returns false if the queue is empty. */
+static bool BDK_TaskQueuePop(BDK_TaskCallback *cb, void **arg)
+{
+    struct BDK_TaskQueueSlot *slot;
+    uint32_t pos = task_queue.head;
+
+    slot = &task_queue.slot[pos & BDK_TASK_QUEUE_MASK];
+    if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1)
+    {
+        return false;
+    }
+
+    *cb = slot->cb;
+    *arg = slot->arg;
+
+    // Release slot for producers of the next lap.
+    __atomic_store_n(&slot->seq, pos + RTE_APP_TASK_QUEUE_SIZE,
+            __ATOMIC_RELEASE);
+    __atomic_store_n(&task_queue.head, pos + 1, __ATOMIC_RELAXED);
+
+    return true;
+}
+
 void BDK_TaskSchedule(BDK_TaskCallback cb, void *arg)
 {
     struct BDK_TimerCmd *cmd;
 
     if (task_res.run_state >= BDK_TASK_STATE_INITIALIZED)
     {
-        cmd = KE_MSG_ALLOC_DYN(BDK_SCHEDULE_MSG, TASK_APP, TASK_APP, BDK_TimerCmd, 0);
+        if (BDK_TaskQueuePush(cb, arg) == false)
+        {
+            // Queue is full, fall back to kernel message so the callback is
+            // not lost.
+            __atomic_fetch_add(&task_queue.stats.overflow_cnt, 1,
+                    __ATOMIC_RELAXED);
 
-        cmd->cb = cb;
-        cmd->arg = arg;
+            cmd = KE_MSG_ALLOC_DYN(BDK_SCHEDULE_MSG, TASK_APP, TASK_APP,
+                    BDK_TimerCmd, 0);
 
-        ke_msg_send(cmd);
+            cmd->cb = cb;
+            cmd->arg = arg;
+
+            ke_msg_send(cmd);
+        }
     }
 }
 
+void BDK_TaskRunQueued(void)
+{
+    BDK_TaskCallback cb;
+    void *arg;
+
+    // Limit number of executed callbacks so that a callback which schedules
+    // itself does not block the main loop.
+    for (uint32_t i = 0; i < RTE_APP_TASK_QUEUE_SIZE; ++i)
+    {
+        if (BDK_TaskQueuePop(&cb, &arg) == false)
+        {
+            break;
+        }
+
+        if (cb != NULL)
+        {
+            cb(arg);
+        }
+    }
+}
+
+bool BDK_TaskIsQueueEmpty(void)
+{
+    return __atomic_load_n(&task_queue.tail, __ATOMIC_ACQUIRE)
+            == task_queue.head;
+}
+
+const struct BDK_TaskQueueStats * BDK_TaskGetQueueStats(void)
+{
+    return &task_queue.stats;
+}
+
 static int BDK_DefaultMsgHandler(ke_msg_id_t const msg_id, void const *param,
         ke_task_id_t const dest_id, ke_task_id_t const src_id)
 {
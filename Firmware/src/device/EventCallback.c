@@ -29,6 +29,26 @@
 // DEFINES / CONSTANTS
 //-----------------------------------------------------------------------------
 
+#if (RTE_APP_EVENT_CALLBACK_ID_COUNT & (RTE_APP_EVENT_CALLBACK_ID_COUNT - 1)) != 0
+#error "RTE_APP_EVENT_CALLBACK_ID_COUNT has to be power of two."
+#endif
+
+#define EVENT_CALLBACK_ID_MASK         (RTE_APP_EVENT_CALLBACK_ID_COUNT - 1)
+
+/** Registered callbacks of single event id.
+ *
+ * Entries are never released once used so that lookup can stop at the first
+ * unused entry.
+ */
+struct EventCallback_Entry
+{
+    EventCallback_Type *head;
+    EventCallback_Type *tail;
+    struct EventCallback_Stats stats;
+    uint16_t event_id;
+    bool used;
+};
+
 //-----------------------------------------------------------------------------
 // EXTERNAL / FORWARD DECLARATIONS
 //-----------------------------------------------------------------------------
@@ -37,7 +57,51 @@
 // INTERNAL / STATIC VARIABLES
 //-----------------------------------------------------------------------------
 
-static EventCallback_Type *head_handle = NULL;
+/** Open addressing hash table of event ids. */
+static struct EventCallback_Entry event_table[RTE_APP_EVENT_CALLBACK_ID_COUNT];
+
+//-----------------------------------------------------------------------------
+// INTERNAL FUNCTIONS
+//-----------------------------------------------------------------------------
+
+/** Finds table entry of given event id.
+ *
+ * If there is no entry for this event id and \p create is true, new entry is
+ * allocated.
+ *
+ * Returns NULL if entry does not exist or the table is full.
+ */
+static struct EventCallback_Entry* EventCallback_FindEntry(uint16_t event_id,
+        bool create)
+{
+    uint32_t idx = ((event_id * 0x9E37U) >> 8) & EVENT_CALLBACK_ID_MASK;
+
+    for (uint32_t i = 0; i < RTE_APP_EVENT_CALLBACK_ID_COUNT; ++i)
+    {
+        struct EventCallback_Entry *entry = &event_table[idx];
+
+        if (entry->used == false)
+        {
+            if (create == false)
+            {
+                return NULL;
+            }
+
+            entry->event_id = event_id;
+            entry->used = true;
+            return entry;
+        }
+
+        if (entry->event_id == event_id)
+        {
+            return entry;
+        }
+
+        idx = (idx + 1) & EVENT_CALLBACK_ID_MASK;
+    }
+
+    return NULL;
+}
 
 //-----------------------------------------------------------------------------
 // FUNCTION DEFINITIONS
@@ -52,75 +116,131 @@ void EventCallback_Init(EventCallback_Type *handle, uint16_t event_id,
     handle->callback = callback;
     handle->arg = arg;
     handle->next = NULL;
+    handle->prev = NULL;
 }
 
 void EventCallback_Register(EventCallback_Type *handle)
 {
+    struct EventCallback_Entry *entry;
+
     ASSERT_DEBUG(handle != NULL);
 
-    if (head_handle == NULL)
+    entry = EventCallback_FindEntry(handle->event_id, true);
+
+    // If this fails there are too many distinct event ids in use.
+    // RTE_APP_EVENT_CALLBACK_ID_COUNT needs to be increased.
+    ASSERT_DEBUG(entry != NULL);
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    handle->next = NULL;
+    handle->prev = entry->tail;
+
+    if (entry->tail == NULL)
     {
-        head_handle = handle;
+        entry->head = handle;
     }
     else
     {
-        EventCallback_Type *h = head_handle;
-        while (h->next != NULL)
-        {
-            h = h->next;
-        }
-        h->next = handle;
+        entry->tail->next = handle;
     }
+    entry->tail = handle;
+
+    entry->stats.handler_cnt += 1;
 }
 
 void EventCallback_Remove(EventCallback_Type *handle)
 {
+    struct EventCallback_Entry *entry;
+
     ASSERT_DEBUG(handle != NULL);
 
-    if (handle == head_handle)
+    entry = EventCallback_FindEntry(handle->event_id, false);
+    if (entry == NULL)
     {
-        // Remove handle from list if it was first registered handle.
-        head_handle = head_handle->next;
+        // No handle was registered for this event id.
+        return;
+    }
+
+    if (handle->prev == NULL && entry->head != handle)
+    {
+        // This handle was not registered.
+        return;
+    }
+
+    // Unlink handle from its neighbors.
+    if (handle->prev == NULL)
+    {
+        entry->head = handle->next;
     }
     else
     {
-        if (head_handle != NULL)
-        {
-            EventCallback_Type *h = head_handle;
+        handle->prev->next = handle->next;
+    }
 
-            // Find handle taht is before the handle to be removed.
-            while (h->next != handle)
-            {
-                if (h->next == NULL)
-                {
-                    // This handle was not registered.
-                    return;
-                }
-                // Move to next handle.
-                h = h->next;
-            }
+    if (handle->next == NULL)
+    {
+        entry->tail = handle->prev;
+    }
+    else
+    {
+        handle->next->prev = handle->prev;
+    }
 
-            // Remove handle from list.
-            h->next = handle->next;
+    // Erase any pointer to other handlers from removed handle.
+    handle->next = NULL;
+    handle->prev = NULL;
 
-            // Erase any pointer to other handlers from removed handle.
-            handle->next = NULL;
-        }
-    }
+    entry->stats.handler_cnt -= 1;
 }
 
 void EventCallback_Call(uint16_t event_id)
 {
+    struct EventCallback_Entry *entry;
     EventCallback_Type *h;
+    EventCallback_Type *next;
+    uint32_t start;
+    uint32_t cycles;
+
+    entry = EventCallback_FindEntry(event_id, false);
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    start = DWT->CYCCNT;
 
-    // Iterate over all registered event handles.
-    for (h = head_handle; h != NULL; h = h->next)
+    // Iterate over all handles registered for this event.
+    // Next handle is read before the call so that callback can remove itself.
+    for (h = entry->head; h != NULL; h = next)
     {
-        if (h->event_id == event_id && h->callback != NULL)
+        next = h->next;
+
+        if (h->callback != NULL)
         {
             h->callback(h->arg);
         }
     }
+
+    cycles = DWT->CYCCNT - start;
+
+    entry->stats.call_cnt += 1;
+    entry->stats.total_cycles += cycles;
+    if (cycles > entry->stats.max_cycles)
+    {
+        entry->stats.max_cycles = cycles;
+    }
+}
+
+const struct EventCallback_Stats * EventCallback_GetStats(uint16_t event_id)
+{
+    struct EventCallback_Entry *entry;
+
+    entry = EventCallback_FindEntry(event_id, false);
+
+    return (entry != NULL) ? &entry->stats : NULL;
 }
 
 //! \}
@@ -72,6 +72,13 @@ is_duration_ge(struct stimer_duration * lhs, struct stimer_duration * rhs)
 }
 
 
+static inline bool
+is_duration_zero(struct stimer_duration * td)
+{
+    return (0 == td->seconds) && (0 == td->nanoseconds);
+}
+
+
 static inline void
 set_duration_s(struct stimer_duration * td, uint32_t s)
 {
@@ -104,6 +111,408 @@ set_duration_ns(struct stimer_duration * td, uint32_t ns)
 }
 
 
+// ---------------- Timer value functions
+
+#if STIMER_COUNT_MODE
+
+// Finds largest shift for which unit_ns / ns_per_count still fits into the
+// 32 bit multiplier. Only called when the context is initialized.
+static void
+init_conversion(struct stimer_conversion * conv, uint32_t unit_ns,
+                uint32_t ns_per_count)
+{
+    uint8_t shift = 63;
+    uint64_t mul;
+
+    while ((((uint64_t)unit_ns << shift) >> shift) != unit_ns) {
+        shift -= 1;
+    }
+
+    for (;;) {
+        mul = (((uint64_t)unit_ns << shift) + ns_per_count - 1) / ns_per_count;
+        if ((mul <= UINT32_MAX) || (0 == shift)) {
+            break;
+        }
+        shift -= 1;
+    }
+
+    conv->mul = (mul <= UINT32_MAX) ? (uint32_t)mul : UINT32_MAX;
+    conv->shift = shift;
+}
+
+
+// Rounds up so the timer does not expire earlier than requested.
+static inline uint64_t
+convert_to_counts(const struct stimer_conversion * conv, uint32_t value)
+{
+    uint64_t scaled = (uint64_t)value * conv->mul;
+    return (scaled >> conv->shift)
+         + ((scaled & ((1ULL << conv->shift) - 1)) ? 1 : 0);
+}
+
+
+static inline void
+init_context_conversions(struct stimer_ctx * ctx)
+{
+    init_conversion(&ctx->s_to_counts, 1000000000U, ctx->ns_per_count);
+    init_conversion(&ctx->ms_to_counts, 1000000U, ctx->ns_per_count);
+    init_conversion(&ctx->us_to_counts, 1000U, ctx->ns_per_count);
+    init_conversion(&ctx->ns_to_counts, 1U, ctx->ns_per_count);
+}
+
+
+static inline void
+timer_reset_values(struct stimer * ts)
+{
+    ts->expire_counts = 0;
+    ts->elapsed_counts = 0;
+}
+
+
+static inline void
+timer_clear_elapsed(struct stimer * ts)
+{
+    ts->elapsed_counts = 0;
+}
+
+
+static inline void
+timer_add_elapsed(struct stimer * ts, uint32_t counts)
+{
+    ts->elapsed_counts += counts;
+}
+
+
+static inline bool
+timer_has_interval(struct stimer * ts)
+{
+    return 0 != ts->expire_counts;
+}
+
+
+static inline bool
+timer_is_elapsed(struct stimer * ts)
+{
+    return ts->elapsed_counts >= ts->expire_counts;
+}
+
+
+static inline uint64_t
+timer_remaining_counts(struct stimer * ts)
+{
+    return timer_is_elapsed(ts) ? 0 : ts->expire_counts - ts->elapsed_counts;
+}
+
+
+static inline void
+timer_subtract_from_elapsed(struct stimer * ts)
+{
+    if (timer_is_elapsed(ts)) {
+        ts->elapsed_counts -= ts->expire_counts;
+    } else {
+        ts->elapsed_counts = 0;
+    }
+}
+
+
+static inline void
+timer_set_interval(struct stimer * ts, struct stimer_duration * t)
+{
+    ts->expire_counts = convert_to_counts(&ts->ctx->s_to_counts, t->seconds)
+                      + convert_to_counts(&ts->ctx->ns_to_counts, t->nanoseconds);
+}
+
+
+static inline void
+timer_set_interval_s(struct stimer * ts, uint32_t s)
+{
+    ts->expire_counts = convert_to_counts(&ts->ctx->s_to_counts, s);
+}
+
+
+static inline void
+timer_set_interval_ms(struct stimer * ts, uint32_t ms)
+{
+    ts->expire_counts = convert_to_counts(&ts->ctx->ms_to_counts, ms);
+}
+
+
+static inline void
+timer_set_interval_us(struct stimer * ts, uint32_t us)
+{
+    ts->expire_counts = convert_to_counts(&ts->ctx->us_to_counts, us);
+}
+
+
+static inline void
+timer_set_interval_ns(struct stimer * ts, uint32_t ns)
+{
+    ts->expire_counts = convert_to_counts(&ts->ctx->ns_to_counts, ns);
+}
+
+
+static void
+timer_get_elapsed(struct stimer * ts, struct stimer_duration * t)
+{
+    uint64_t ns = ts->elapsed_counts * ts->ctx->ns_per_count;
+
+    t->seconds = (uint32_t)(ns / 1000000000U);
+    t->nanoseconds = (uint32_t)(ns - (uint64_t)t->seconds * 1000000000U);
+}
+
+#else
+
+static inline void
+init_context_conversions(struct stimer_ctx * ctx)
+{
+    (void)ctx;
+}
+
+
+static inline void
+timer_reset_values(struct stimer * ts)
+{
+    ts->expire_interval.seconds = 0;
+    ts->expire_interval.nanoseconds = 0;
+
+    ts->elapsed.seconds = 0;
+    ts->elapsed.nanoseconds = 0;
+}
+
+
+static inline void
+timer_clear_elapsed(struct stimer * ts)
+{
+    ts->elapsed.seconds = 0;
+    ts->elapsed.nanoseconds = 0;
+}
+
+
+static inline void
+timer_add_elapsed(struct stimer * ts, uint32_t counts)
+{
+    uint64_t ns_advance = (uint64_t)counts * (uint64_t)ts->ctx->ns_per_count;
+    advance_duration_ns(&ts->elapsed, ns_advance);
+}
+
+
+static inline bool
+timer_has_interval(struct stimer * ts)
+{
+    return !is_duration_zero(&ts->expire_interval);
+}
+
+
+static inline bool
+timer_is_elapsed(struct stimer * ts)
+{
+    return is_duration_ge(&ts->elapsed, &ts->expire_interval);
+}
+
+
+static inline uint64_t
+timer_remaining_counts(struct stimer * ts)
+{
+    uint64_t remaining_ns = 0;
+
+    if (!timer_is_elapsed(ts)) {
+        remaining_ns = ((uint64_t)ts->expire_interval.seconds * 1000000000U
+                        + ts->expire_interval.nanoseconds)
+                     - ((uint64_t)ts->elapsed.seconds * 1000000000U
+                        + ts->elapsed.nanoseconds);
+    }
+
+    // Round up so the timer is reported expired once the deadline is reached
+    return (remaining_ns + ts->ctx->ns_per_count - 1) / ts->ctx->ns_per_count;
+}
+
+
+static inline void
+timer_subtract_from_elapsed(struct stimer * ts)
+{
+    struct stimer_duration * td = &ts->expire_interval;
+
+    if (is_duration_ge(&ts->elapsed, td)) {
+        ts->elapsed.seconds -= td->seconds;
+        if (ts->elapsed.nanoseconds >= td->nanoseconds) {
+            ts->elapsed.nanoseconds -= td->nanoseconds;
+        } else {
+            ts->elapsed.seconds -= 1;
+            ts->elapsed.nanoseconds += (1000000000 - td->nanoseconds);
+        }
+    } else {
+        ts->elapsed.seconds = 0;
+        ts->elapsed.nanoseconds = 0;
+    }
+}
+
+
+static inline void
+timer_set_interval(struct stimer * ts, struct stimer_duration * t)
+{
+    ts->expire_interval = *t;
+}
+
+
+static inline void
+timer_set_interval_s(struct stimer * ts, uint32_t s)
+{
+    set_duration_s(&ts->expire_interval, s);
+}
+
+
+static inline void
+timer_set_interval_ms(struct stimer * ts, uint32_t ms)
+{
+    set_duration_ms(&ts->expire_interval, ms);
+}
+
+
+static inline void
+timer_set_interval_us(struct stimer * ts, uint32_t us)
+{
+    set_duration_us(&ts->expire_interval, us);
+}
+
+
+static inline void
+timer_set_interval_ns(struct stimer * ts, uint32_t ns)
+{
+    set_duration_ns(&ts->expire_interval, ns);
+}
+
+
+static inline void
+timer_get_elapsed(struct stimer * ts, struct stimer_duration * t)
+{
+    *t = ts->elapsed;
+}
+
+#endif /* STIMER_COUNT_MODE */
+
+
+// ------------------ Expiry queue functions
+
+static inline void
+queue_set(struct stimer_ctx * ctx, int16_t index, struct stimer * ts)
+{
+    ctx->queue[index] = ts;
+    ts->queue_index = index;
+}
+
+
+static void
+queue_sift_up(struct stimer_ctx * ctx, int16_t index)
+{
+    struct stimer * ts = ctx->queue[index];
+
+    while (index > 0) {
+        int16_t parent = (index - 1) / 2;
+        if (!tm_is_lt(&ctx->tm, ts->deadline, ctx->queue[parent]->deadline)) {
+            break;
+        }
+        queue_set(ctx, index, ctx->queue[parent]);
+        index = parent;
+    }
+    queue_set(ctx, index, ts);
+}
+
+
+static void
+queue_sift_down(struct stimer_ctx * ctx, int16_t index)
+{
+    struct stimer * ts = ctx->queue[index];
+
+    while (1) {
+        int16_t child = 2 * index + 1;
+        if (child >= ctx->queue_len) {
+            break;
+        }
+        if ((child + 1 < ctx->queue_len) &&
+            tm_is_lt(&ctx->tm, ctx->queue[child + 1]->deadline,
+                     ctx->queue[child]->deadline)) {
+            child += 1;
+        }
+        if (!tm_is_lt(&ctx->tm, ctx->queue[child]->deadline, ts->deadline)) {
+            break;
+        }
+        queue_set(ctx, index, ctx->queue[child]);
+        index = child;
+    }
+    queue_set(ctx, index, ts);
+}
+
+
+static void
+queue_remove(struct stimer * ts)
+{
+    struct stimer_ctx * ctx = ts->ctx;
+    int16_t index = ts->queue_index;
+
+    if ((NULL != ctx) && (index >= 0)) {
+        ts->queue_index = -1;
+        ctx->queue_len -= 1;
+
+        if (index < ctx->queue_len) {
+            // Move last element into the gap and restore heap order
+            struct stimer * moved = ctx->queue[ctx->queue_len];
+            queue_set(ctx, index, moved);
+            queue_sift_up(ctx, index);
+            queue_sift_down(ctx, moved->queue_index);
+        }
+    }
+}
+
+
+// Calculates latest time at which the timer has to be serviced from its last
+// checkpoint.
+static void
+update_deadline(struct stimer * ts)
+{
+    struct stimer_ctx * ctx = ts->ctx;
+    uint64_t counts = timer_remaining_counts(ts);
+
+    // Overdue timers are not delayed any further
+    if (counts > 0) {
+        counts += ts->slack;
+    }
+
+    // Keep deadlines comparable across rollover. Longer timers are
+    // rescheduled when the shortened deadline is reached.
+    if (counts > (ctx->tm.max_value >> 2)) {
+        counts = ctx->tm.max_value >> 2;
+    }
+
+    ts->deadline = tm_offset(&ctx->tm, ts->checkpoint, (int32_t)counts);
+}
+
+
+// Places timer into the expiry queue if it is set to expire.
+static void
+schedule_timer(struct stimer * ts)
+{
+    struct stimer_ctx * ctx = ts->ctx;
+
+    if (!ts->is_running || !timer_has_interval(ts)) {
+        queue_remove(ts);
+        return;
+    }
+
+    update_deadline(ts);
+
+    if (ts->queue_index >= 0) {
+        queue_sift_up(ctx, ts->queue_index);
+        queue_sift_down(ctx, ts->queue_index);
+    } else if (ctx->queue_len < STIMER_MAX_QUEUED) {
+        ctx->queue_len += 1;
+        queue_set(ctx, ctx->queue_len - 1, ts);
+        queue_sift_up(ctx, ts->queue_index);
+    } else {
+        ctx->queue_overflow = true;
+    }
+}
+
+
 // -------------------- Timer functions
 
 static void
@@ -126,6 +535,7 @@ unlink_timer(struct stimer * ts)
 {
     struct stimer * next = ts->next;
     struct stimer_ctx * ctx = ts->ctx;
+    queue_remove(ts);
     ts->next = NULL;
     ts->ctx = NULL;
 
@@ -151,8 +561,7 @@ checkpoint_timer(struct stimer * ts, struct tm_math * tm, uint32_t now)
     if (ts->is_running) {
         int32_t diff = tm_get_diff(tm, now, ts->checkpoint);
         if (diff > 0) {
-            uint64_t ns_advance = (uint64_t)diff * (uint64_t)ts->ctx->ns_per_count;
-            advance_duration_ns(&ts->elapsed, ns_advance);
+            timer_add_elapsed(ts, (uint32_t)diff);
             ts->checkpoint = now;
         }
     }
@@ -176,26 +585,7 @@ start_and_checkpoint_timer(struct stimer * ts)
     ts->checkpoint = ts->ctx->get_time_fn(ts->ctx->hint);
     ts->is_running = true;
 
-    ts->elapsed.seconds = 0;
-    ts->elapsed.nanoseconds = 0;
-}
-
-
-static inline void
-timer_subtract_from_elapsed(struct stimer * ts, struct stimer_duration * td)
-{
-    if (is_duration_ge(&ts->elapsed, td)) {
-        ts->elapsed.seconds -= td->seconds;
-        if (ts->elapsed.nanoseconds >= td->nanoseconds) {
-            ts->elapsed.nanoseconds -= td->nanoseconds;
-        } else {
-            ts->elapsed.seconds -= 1;
-            ts->elapsed.nanoseconds += (1000000000 - td->nanoseconds);
-        }
-    } else {
-        ts->elapsed.seconds = 0;
-        ts->elapsed.nanoseconds = 0;
-    }
+    timer_clear_elapsed(ts);
 }
 
 
@@ -217,8 +607,13 @@ stimer_alloc_context(void * hint,
         tm_initialize(&ctx->tm, max_time);
 
         ctx->ns_per_count = ns_per_count;
+        init_context_conversions(ctx);
         ctx->get_time_fn = get_time_fn;
         ctx->hint = hint;
+
+        ctx->queue_len = 0;
+        ctx->queue_overflow = false;
+        ctx->last_execute = 0;
     }
 
     return ctx;
@@ -237,8 +632,13 @@ stimer_init_context(struct stimer_ctx *ctx,
         tm_initialize(&ctx->tm, max_time);
 
         ctx->ns_per_count = ns_per_count;
+        init_context_conversions(ctx);
         ctx->get_time_fn = get_time_fn;
         ctx->hint = hint;
+
+        ctx->queue_len = 0;
+        ctx->queue_overflow = false;
+        ctx->last_execute = 0;
     }
 }
 
@@ -266,7 +666,81 @@ stimer_execute_context(struct stimer_ctx * ctx)
         for (ts = ctx->root; NULL != ts; ts = ts->next) {
             checkpoint_timer(ts, &ctx->tm, now);
         }
+
+        ctx->last_execute = now;
+    }
+}
+
+
+bool
+stimer_get_next_expiry(struct stimer_ctx * ctx, uint32_t * counts)
+{
+    bool found = false;
+    uint32_t next = UINT32_MAX;
+
+    if ((NULL == ctx) || (NULL == counts)) {
+        return false;
+    }
+
+    uint32_t now = ctx->get_time_fn(ctx->hint);
+
+    // Elapsed times of timers have to be updated at least 4 times per
+    // get_time_fn rollover.
+    int32_t since_execute = tm_get_diff(&ctx->tm, now, ctx->last_execute);
+    if ((since_execute < 0) ||
+        (since_execute >= (int32_t)(ctx->tm.max_value >> 3))) {
+        stimer_execute_context(ctx);
+    }
+
+    // Timers that did not fit into the queue have to be checked one by one.
+    if (ctx->queue_overflow) {
+        ctx->queue_overflow = false;
+
+        struct stimer * ts;
+        for (ts = ctx->root; NULL != ts; ts = ts->next) {
+            if (ts->is_running && (ts->queue_index < 0) &&
+                timer_has_interval(ts)) {
+                checkpoint_timer(ts, &ctx->tm, now);
+                schedule_timer(ts);
+
+                if (ts->queue_index < 0) {
+                    int32_t diff = tm_get_diff(&ctx->tm, ts->deadline, now);
+                    found = true;
+                    if (diff <= 0) {
+                        next = 0;
+                    } else if ((uint32_t)diff < next) {
+                        next = diff;
+                    }
+                }
+            }
+        }
+    }
+
+    while (ctx->queue_len > 0) {
+        struct stimer * ts = ctx->queue[0];
+        int32_t diff = tm_get_diff(&ctx->tm, ts->deadline, now);
+
+        if (diff > 0) {
+            found = true;
+            if ((uint32_t)diff < next) {
+                next = diff;
+            }
+            break;
+        }
+
+        // Deadline was reached. Check the timer itself in case its deadline
+        // was shortened and reschedule it if it did not expire yet.
+        checkpoint_timer(ts, &ctx->tm, now);
+        if (timer_is_elapsed(ts)) {
+            found = true;
+            next = 0;
+            break;
+        }
+        schedule_timer(ts);
     }
+
+    *counts = next;
+    return found;
 }
 
 
@@ -285,13 +759,13 @@ stimer_alloc(struct stimer_ctx * ctx)
 
             ts->checkpoint = 0;
 
-            ts->expire_interval.seconds = 0;
-            ts->expire_interval.nanoseconds = 0;
-
-            ts->elapsed.seconds = 0;
-            ts->elapsed.nanoseconds = 0;
+            timer_reset_values(ts);
             ts->is_running = false;
 
+            ts->slack = 0;
+            ts->deadline = 0;
+            ts->queue_index = -1;
+
             link_timer(ctx, ts);
         }
     }
@@ -309,13 +783,13 @@ stimer_init(struct stimer *ts, struct stimer_ctx * ctx)
 
             ts->checkpoint = 0;
 
-            ts->expire_interval.seconds = 0;
-            ts->expire_interval.nanoseconds = 0;
-
-            ts->elapsed.seconds = 0;
-            ts->elapsed.nanoseconds = 0;
+            timer_reset_values(ts);
             ts->is_running = false;
 
+            ts->slack = 0;
+            ts->deadline = 0;
+            ts->queue_index = -1;
+
             link_timer(ctx, ts);
         }
     }
@@ -347,6 +821,7 @@ stimer_start(struct stimer * ts)
 {
     if ((NULL != ts) && (NULL != ts->ctx)) {
         start_and_checkpoint_timer(ts);
+        schedule_timer(ts);
     }
 }
 
@@ -359,6 +834,7 @@ stimer_stop(struct stimer * ts)
             checkpoint_timer_2(ts);
             ts->is_running = false;
         }
+        queue_remove(ts);
     }
 }
 
@@ -371,7 +847,7 @@ stimer_get_elapsed_time(struct stimer * ts, struct stimer_duration * t)
             checkpoint_timer_2(ts);
         }
 
-        *t = ts->elapsed;
+        timer_get_elapsed(ts, t);
     }
 }
 
@@ -383,7 +859,8 @@ stimer_expire_from_now(struct stimer * ts, struct stimer_duration * t)
 {
     if ((NULL != ts) && (NULL != ts->ctx) && (NULL != t)) {
         start_and_checkpoint_timer(ts);
-        ts->expire_interval = *t;
+        timer_set_interval(ts, t);
+        schedule_timer(ts);
     }
 }
 
@@ -393,7 +870,8 @@ stimer_expire_from_now_s(struct stimer * ts, uint32_t s)
 {
     if ((NULL != ts) && (NULL != ts->ctx)) {
         start_and_checkpoint_timer(ts);
-        set_duration_s(&ts->expire_interval, s);
+        timer_set_interval_s(ts, s);
+        schedule_timer(ts);
     }
 }
 
@@ -403,7 +881,8 @@ stimer_expire_from_now_ms(struct stimer * ts, uint32_t ms)
 {
     if ((NULL != ts) && (NULL != ts->ctx)) {
         start_and_checkpoint_timer(ts);
-        set_duration_ms(&ts->expire_interval, ms);
+        timer_set_interval_ms(ts, ms);
+        schedule_timer(ts);
     }
 }
 
@@ -413,7 +892,8 @@ stimer_expire_from_now_us(struct stimer * ts, uint32_t us)
 {
     if ((NULL != ts) && (NULL != ts->ctx)) {
         start_and_checkpoint_timer(ts);
-        set_duration_us(&ts->expire_interval, us);
+        timer_set_interval_us(ts, us);
+        schedule_timer(ts);
     }
 }
 
@@ -423,7 +903,28 @@ stimer_expire_from_now_ns(struct stimer * ts, uint32_t ns)
 {
     if ((NULL != ts) && (NULL != ts->ctx)) {
         start_and_checkpoint_timer(ts);
-        set_duration_ns(&ts->expire_interval, ns);
+        timer_set_interval_ns(ts, ns);
+        schedule_timer(ts);
+    }
+}
+
+
+void
+stimer_set_slack_ms(struct stimer * ts, uint32_t ms)
+{
+    if ((NULL != ts) && (NULL != ts->ctx)) {
+        struct stimer_ctx * ctx = ts->ctx;
+        uint64_t counts = (uint64_t)ms * 1000000U / ctx->ns_per_count;
+
+        if (counts > (ctx->tm.max_value >> 3)) {
+            counts = ctx->tm.max_value >> 3;
+        }
+        ts->slack = (uint32_t)counts;
+
+        if (ts->queue_index >= 0) {
+            checkpoint_timer_2(ts);
+            schedule_timer(ts);
+        }
     }
 }
 
@@ -436,7 +937,7 @@ stimer_is_expired(struct stimer * ts)
         if (NULL != ts->ctx) {
             checkpoint_timer_2(ts);
         }
-        expired = is_duration_ge(&ts->elapsed, &ts->expire_interval);
+        expired = timer_is_elapsed(ts);
     }
     return expired;
 }
@@ -447,6 +948,7 @@ stimer_restart_from_now(struct stimer * ts)
 {
     if ((NULL != ts) && (NULL != ts->ctx) && (ts->is_running)) {
         start_and_checkpoint_timer(ts);
+        schedule_timer(ts);
     }
 }
 
@@ -456,6 +958,7 @@ stimer_advance(struct stimer * ts)
 {
     if ((NULL != ts) && (NULL != ts->ctx) && (ts->is_running)) {
         checkpoint_timer_2(ts);
-        timer_subtract_from_elapsed(ts, &ts->expire_interval);
+        timer_subtract_from_elapsed(ts);
+        schedule_timer(ts);
     }
 }
@@ -0,0 +1,191 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+//-----------------------------------------------------------------------------
+
+#include <fft_q15.h>
+
+/* Number of entries in a quarter of sine period. */
+#define FFT_Q15_QUARTER                (FFT_Q15_MAX_SIZE / 4)
+
+/* sin(2 * pi * i / FFT_Q15_MAX_SIZE) in Q15 for the first quarter period. */
+static const int16_t fft_q15_sin[FFT_Q15_QUARTER + 1] = {
+         0,    402,    804,   1206,   1608,   2009,   2411,   2811,
+      3212,   3612,   4011,   4410,   4808,   5205,   5602,   5998,
+      6393,   6787,   7180,   7571,   7962,   8351,   8740,   9127,
+      9512,   9896,  10279,  10660,  11039,  11417,  11793,  12167,
+     12540,  12910,  13279,  13646,  14010,  14373,  14733,  15091,
+     15447,  15800,  16151,  16500,  16846,  17190,  17531,  17869,
+     18205,  18538,  18868,  19195,  19520,  19841,  20160,  20475,
+     20788,  21097,  21403,  21706,  22006,  22302,  22595,  22884,
+     23170,  23453,  23732,  24008,  24279,  24548,  24812,  25073,
+     25330,  25583,  25833,  26078,  26320,  26557,  26791,  27020,
+     27246,  27467,  27684,  27897,  28106,  28311,  28511,  28707,
+     28899,  29086,  29269,  29448,  29622,  29792,  29957,  30118,
+     30274,  30425,  30572,  30715,  30853,  30986,  31114,  31238,
+     31357,  31471,  31581,  31686,  31786,  31881,  31972,  32058,
+     32138,  32214,  32286,  32352,  32413,  32470,  32522,  32568,
+     32610,  32647,  32679,  32706,  32729,  32746,  32758,  32766,
+     32767
+};
+
+
+/* Returns cosine and sine of 2 * pi * i / FFT_Q15_MAX_SIZE in Q15.
+ * i must be less than FFT_Q15_MAX_SIZE. */
+static inline void FFT_Q15_Twiddle(uint32_t i, int32_t* c, int32_t* s)
+{
+    const uint32_t r = i % FFT_Q15_QUARTER;
+
+    switch (i / FFT_Q15_QUARTER)
+    {
+    case 0:
+        *c = fft_q15_sin[FFT_Q15_QUARTER - r];
+        *s = fft_q15_sin[r];
+        break;
+    case 1:
+        *c = -fft_q15_sin[r];
+        *s = fft_q15_sin[FFT_Q15_QUARTER - r];
+        break;
+    case 2:
+        *c = -fft_q15_sin[FFT_Q15_QUARTER - r];
+        *s = -fft_q15_sin[r];
+        break;
+    default:
+        *c = fft_q15_sin[r];
+        *s = -fft_q15_sin[FFT_Q15_QUARTER - r];
+        break;
+    }
+}
+
+/* Reorders data into bit reversed order of indexes. */
+static void FFT_Q15_BitReverse(struct FFT_Q15_Complex* data, uint32_t size)
+{
+    uint32_t j = 0;
+
+    for (uint32_t i = 0; i < size - 1; ++i)
+    {
+        if (i < j)
+        {
+            const struct FFT_Q15_Complex tmp = data[i];
+
+            data[i] = data[j];
+            data[j] = tmp;
+        }
+
+        uint32_t bit = size >> 1;
+        while ((j & bit) != 0)
+        {
+            j ^= bit;
+            bit >>= 1;
+        }
+        j |= bit;
+    }
+}
+
+int FFT_Q15_Transform(struct FFT_Q15_Complex* data, uint32_t size)
+{
+    uint32_t h = 1;
+
+    if (size < 4 || size > FFT_Q15_MAX_SIZE || (size & (size - 1)) != 0)
+    {
+        return -1;
+    }
+
+    FFT_Q15_BitReverse(data, size);
+
+    // Odd power of two starts with single radix-2 stage, which needs no
+    // multiplications.
+    if ((size & 0x55555555U) == 0)
+    {
+        for (uint32_t i = 0; i < size; i += 2)
+        {
+            const int32_t ar = data[i].re;
+            const int32_t ai = data[i].im;
+            const int32_t br = data[i + 1].re;
+            const int32_t bi = data[i + 1].im;
+
+            data[i].re = (ar + br + 1) >> 1;
+            data[i].im = (ai + bi + 1) >> 1;
+            data[i + 1].re = (ar - br + 1) >> 1;
+            data[i + 1].im = (ai - bi + 1) >> 1;
+        }
+        h = 2;
+    }
+
+    // Each radix-4 stage merges four transforms of length h into one of
+    // length 4 * h. Input of the stage is in bit reversed order of radix-2
+    // stages, so the second and third inputs of the butterfly are swapped
+    // compared to the classic radix-4 formulation.
+    for (; h < size; h *= 4)
+    {
+        const uint32_t step = FFT_Q15_MAX_SIZE / (4 * h);
+
+        for (uint32_t k = 0; k < h; ++k)
+        {
+            int32_t w1c, w1s, w2c, w2s, w3c, w3s;
+
+            FFT_Q15_Twiddle(k * step, &w1c, &w1s);
+            FFT_Q15_Twiddle(2 * k * step, &w2c, &w2s);
+            FFT_Q15_Twiddle(3 * k * step, &w3c, &w3s);
+
+            for (uint32_t i = k; i < size; i += 4 * h)
+            {
+                struct FFT_Q15_Complex* x0 = &data[i];
+                struct FFT_Q15_Complex* x1 = &data[i + h];
+                struct FFT_Q15_Complex* x2 = &data[i + 2 * h];
+                struct FFT_Q15_Complex* x3 = &data[i + 3 * h];
+
+                // Multiply by conjugated twiddles W^2k, W^k and W^3k.
+                const int32_t c1r = (x1->re * w2c + x1->im * w2s) >> 15;
+                const int32_t c1i = (x1->im * w2c - x1->re * w2s) >> 15;
+                const int32_t c2r = (x2->re * w1c + x2->im * w1s) >> 15;
+                const int32_t c2i = (x2->im * w1c - x2->re * w1s) >> 15;
+                const int32_t c3r = (x3->re * w3c + x3->im * w3s) >> 15;
+                const int32_t c3i = (x3->im * w3c - x3->re * w3s) >> 15;
+
+                const int32_t ar = x0->re + c1r;
+                const int32_t ai = x0->im + c1i;
+                const int32_t br = x0->re - c1r;
+                const int32_t bi = x0->im - c1i;
+                const int32_t cr = c2r + c3r;
+                const int32_t ci = c2i + c3i;
+                const int32_t dr = c2r - c3r;
+                const int32_t di = c2i - c3i;
+
+                x0->re = (ar + cr + 2) >> 2;
+                x0->im = (ai + ci + 2) >> 2;
+                x2->re = (ar - cr + 2) >> 2;
+                x2->im = (ai - ci + 2) >> 2;
+
+                // b - j * d and b + j * d
+                x1->re = (br + di + 2) >> 2;
+                x1->im = (bi - dr + 2) >> 2;
+                x3->re = (br - di + 2) >> 2;
+                x3->im = (bi + dr + 2) >> 2;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int16_t FFT_Q15_Hann(uint32_t n, uint32_t size)
+{
+    int32_t c;
+    int32_t s;
+
+    FFT_Q15_Twiddle((n * (FFT_Q15_MAX_SIZE / size)) % FFT_Q15_MAX_SIZE, &c,
+            &s);
+
+    // 0.5 - 0.5 * cos(2 * pi * n / size)
+    return (int16_t) ((32767 - c) >> 1);
+}
@@ -0,0 +1,391 @@
+//-----------------------------------------------------------------------------
+// Copyright (c) 2018 Semiconductor Components Industries LLC
+// (d/b/a "ON Semiconductor").  All rights reserved.
+// This software and/or documentation is licensed by ON Semiconductor under
+// limited terms and conditions.  The terms and conditions pertaining to the
+// software and/or documentation are available at
+// http://www.onsemi.com/site/pdf/ONSEMI_T&C.pdf ("ON Semiconductor Standard
+// Terms and Conditions of Sale, Section 8 Software") and if applicable the
+// software license agreement.  Do not use this software and/or documentation
+// unless you have carefully read and you agree to the limited terms and
+// conditions.  By using this software and/or documentation, you agree to the
+// limited terms and conditions.
+//-----------------------------------------------------------------------------
+
+#include <stddef.h>
+
+#include <fusion_q.h>
+
+/* Value of 0.5 in Q30. */
+#define FUSION_Q_HALF                  (1L << 29)
+
+/* Number of CORDIC iterations used by Fusion_Q_Atan2. */
+#define FUSION_Q_CORDIC_STEPS          (16)
+
+/* atan(2^-i) in degrees Q16. */
+static const int32_t fusion_q_atan[FUSION_Q_CORDIC_STEPS] = {
+    2949120, 1740967, 919879, 466945, 234379, 117304, 58666, 29335,
+      14668,    7334,   3667,   1833,    917,    458,   229,   115
+};
+
+
+/* Multiplies two Q30 numbers. */
+static inline int32_t Fusion_Q_Mul(int32_t a, int32_t b)
+{
+    return (int32_t) (((int64_t) a * b) >> 30);
+}
+
+static uint32_t Fusion_Q_Sqrt(uint64_t value)
+{
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t) 1 << 62;
+
+    while (bit > value)
+    {
+        bit >>= 2;
+    }
+
+    while (bit != 0)
+    {
+        if (value >= result + bit)
+        {
+            value -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else
+        {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t) result;
+}
+
+/* Normalizes 3 axis sample to unit vector in Q30.
+ * Returns 0 on success or -1 if all axes are zero. */
+static int Fusion_Q_Normalize(const int16_t* in, int32_t* out)
+{
+    const uint32_t norm = Fusion_Q_Sqrt(
+            (int64_t) in[0] * in[0] + (int64_t) in[1] * in[1]
+            + (int64_t) in[2] * in[2]);
+    int64_t inv;
+
+    if (norm == 0)
+    {
+        return -1;
+    }
+
+    // Single division, norm is at most 56756 so inverse keeps 14+ bits.
+    inv = ((int64_t) 1 << 46) / norm;
+    for (int i = 0; i < 3; ++i)
+    {
+        out[i] = (int32_t) ((in[i] * inv) >> 16);
+    }
+
+    return 0;
+}
+
+/* Returns atan2(y, x) in degrees Q16 using CORDIC in vectoring mode.
+ * Inputs are Q30 values with magnitude not exceeding 2.0 */
+static int32_t Fusion_Q_Atan2(int32_t y, int32_t x)
+{
+    int32_t angle = 0;
+
+    // Headroom for CORDIC gain of 1.647.
+    x >>= 2;
+    y >>= 2;
+
+    if (x < 0)
+    {
+        angle = (y >= 0) ? (180 << 16) : -(180 << 16);
+        x = -x;
+        y = -y;
+    }
+
+    for (int i = 0; i < FUSION_Q_CORDIC_STEPS; ++i)
+    {
+        const int32_t tx = x;
+
+        if (y > 0)
+        {
+            x += y >> i;
+            y -= tx >> i;
+            angle += fusion_q_atan[i];
+        }
+        else
+        {
+            x -= y >> i;
+            y += tx >> i;
+            angle -= fusion_q_atan[i];
+        }
+    }
+
+    return angle;
+}
+
+/* Converts degrees Q16 to hundredths of a degree. */
+static inline int32_t Fusion_Q_ToCenti(int32_t angle)
+{
+    return (int32_t) (((int64_t) angle * 100 + (1 << 15)) >> 16);
+}
+
+/* Returns ((num << 30) / den) for Q30 numerator and positive denominator. */
+static inline int32_t Fusion_Q_Div(int64_t num, int64_t den)
+{
+    return (int32_t) ((num << 30) / den);
+}
+
+/* Sets orientation from unit gravity and magnetic field vectors in Q30.
+ * Returns 0 on success or -1 if the vectors are parallel. */
+static int Fusion_Q_Align(struct Fusion_Q_State* state, const int32_t* a,
+        const int32_t* m)
+{
+    int32_t r[3][3];
+    int32_t* q = state->q;
+    uint32_t norm;
+    int64_t s;
+
+    // Rows of rotation matrix are north, west and up axes in sensor frame.
+    r[2][0] = a[0];
+    r[2][1] = a[1];
+    r[2][2] = a[2];
+    r[1][0] = Fusion_Q_Mul(a[1], m[2]) - Fusion_Q_Mul(a[2], m[1]);
+    r[1][1] = Fusion_Q_Mul(a[2], m[0]) - Fusion_Q_Mul(a[0], m[2]);
+    r[1][2] = Fusion_Q_Mul(a[0], m[1]) - Fusion_Q_Mul(a[1], m[0]);
+
+    norm = Fusion_Q_Sqrt((int64_t) r[1][0] * r[1][0]
+            + (int64_t) r[1][1] * r[1][1] + (int64_t) r[1][2] * r[1][2]);
+    if (norm < (FUSION_Q_ONE >> 6))
+    {
+        return -1;
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        r[1][i] = Fusion_Q_Div(r[1][i], norm);
+    }
+
+    r[0][0] = Fusion_Q_Mul(r[1][1], a[2]) - Fusion_Q_Mul(r[1][2], a[1]);
+    r[0][1] = Fusion_Q_Mul(r[1][2], a[0]) - Fusion_Q_Mul(r[1][0], a[2]);
+    r[0][2] = Fusion_Q_Mul(r[1][0], a[1]) - Fusion_Q_Mul(r[1][1], a[0]);
+
+    // Conversion of rotation matrix to quaternion, the largest component is
+    // computed first to keep the divisor away from zero.
+    if ((int64_t) r[0][0] + r[1][1] + r[2][2] > 0)
+    {
+        s = 2 * (int64_t) Fusion_Q_Sqrt(((int64_t) FUSION_Q_ONE + r[0][0]
+                + r[1][1] + r[2][2]) << 30);
+        q[0] = (int32_t) (s / 4);
+        q[1] = Fusion_Q_Div((int64_t) r[2][1] - r[1][2], s);
+        q[2] = Fusion_Q_Div((int64_t) r[0][2] - r[2][0], s);
+        q[3] = Fusion_Q_Div((int64_t) r[1][0] - r[0][1], s);
+    }
+    else if (r[0][0] > r[1][1] && r[0][0] > r[2][2])
+    {
+        s = 2 * (int64_t) Fusion_Q_Sqrt(((int64_t) FUSION_Q_ONE + r[0][0]
+                - r[1][1] - r[2][2]) << 30);
+        q[0] = Fusion_Q_Div((int64_t) r[2][1] - r[1][2], s);
+        q[1] = (int32_t) (s / 4);
+        q[2] = Fusion_Q_Div((int64_t) r[0][1] + r[1][0], s);
+        q[3] = Fusion_Q_Div((int64_t) r[0][2] + r[2][0], s);
+    }
+    else if (r[1][1] > r[2][2])
+    {
+        s = 2 * (int64_t) Fusion_Q_Sqrt(((int64_t) FUSION_Q_ONE + r[1][1]
+                - r[0][0] - r[2][2]) << 30);
+        q[0] = Fusion_Q_Div((int64_t) r[0][2] - r[2][0], s);
+        q[1] = Fusion_Q_Div((int64_t) r[0][1] + r[1][0], s);
+        q[2] = (int32_t) (s / 4);
+        q[3] = Fusion_Q_Div((int64_t) r[1][2] + r[2][1], s);
+    }
+    else
+    {
+        s = 2 * (int64_t) Fusion_Q_Sqrt(((int64_t) FUSION_Q_ONE + r[2][2]
+                - r[0][0] - r[1][1]) << 30);
+        q[0] = Fusion_Q_Div((int64_t) r[1][0] - r[0][1], s);
+        q[1] = Fusion_Q_Div((int64_t) r[0][2] + r[2][0], s);
+        q[2] = Fusion_Q_Div((int64_t) r[1][2] + r[2][1], s);
+        q[3] = (int32_t) (s / 4);
+    }
+
+    state->is_aligned = 1;
+    return 0;
+}
+
+void Fusion_Q_Init(struct Fusion_Q_State* state, int32_t kp, int32_t ki)
+{
+    state->q[0] = FUSION_Q_ONE;
+    state->q[1] = 0;
+    state->q[2] = 0;
+    state->q[3] = 0;
+    state->integral[0] = 0;
+    state->integral[1] = 0;
+    state->integral[2] = 0;
+    state->two_kp = 2 * kp;
+    state->two_ki = 2 * ki;
+    state->is_aligned = 0;
+}
+
+void Fusion_Q_Update(struct Fusion_Q_State* state, const int32_t* gyro,
+        const int16_t* accel, const int16_t* mag, uint32_t dt)
+{
+    int32_t* q = state->q;
+    int32_t a[3], m[3];
+    int32_t e[3] = { 0, 0, 0 };
+    int32_t g[3] = { gyro[0], gyro[1], gyro[2] };
+    int32_t h[3];
+    int32_t q0, q1, q2, q3;
+    int32_t norm;
+    int32_t inv;
+    const int has_accel = (accel != NULL && Fusion_Q_Normalize(accel, a) == 0);
+    const int has_mag = (mag != NULL && Fusion_Q_Normalize(mag, m) == 0);
+
+    if (state->is_aligned == 0 && has_accel && has_mag
+        && Fusion_Q_Align(state, a, m) == 0)
+    {
+        return;
+    }
+
+    if (has_accel)
+    {
+        const int32_t q0q0 = Fusion_Q_Mul(q[0], q[0]);
+        const int32_t q0q1 = Fusion_Q_Mul(q[0], q[1]);
+        const int32_t q0q2 = Fusion_Q_Mul(q[0], q[2]);
+        const int32_t q0q3 = Fusion_Q_Mul(q[0], q[3]);
+        const int32_t q1q1 = Fusion_Q_Mul(q[1], q[1]);
+        const int32_t q1q2 = Fusion_Q_Mul(q[1], q[2]);
+        const int32_t q1q3 = Fusion_Q_Mul(q[1], q[3]);
+        const int32_t q2q2 = Fusion_Q_Mul(q[2], q[2]);
+        const int32_t q2q3 = Fusion_Q_Mul(q[2], q[3]);
+        const int32_t q3q3 = Fusion_Q_Mul(q[3], q[3]);
+
+        // Half of estimated direction of gravity.
+        const int32_t vx = q1q3 - q0q2;
+        const int32_t vy = q0q1 + q2q3;
+        const int32_t vz = q0q0 - FUSION_Q_HALF + q3q3;
+
+        e[0] = Fusion_Q_Mul(a[1], vz) - Fusion_Q_Mul(a[2], vy);
+        e[1] = Fusion_Q_Mul(a[2], vx) - Fusion_Q_Mul(a[0], vz);
+        e[2] = Fusion_Q_Mul(a[0], vy) - Fusion_Q_Mul(a[1], vx);
+
+        if (has_mag)
+        {
+            // Reference direction of magnetic field in earth frame.
+            const int32_t hx = 2 * (Fusion_Q_Mul(m[0], FUSION_Q_HALF - q2q2 - q3q3)
+                    + Fusion_Q_Mul(m[1], q1q2 - q0q3)
+                    + Fusion_Q_Mul(m[2], q1q3 + q0q2));
+            const int32_t hy = 2 * (Fusion_Q_Mul(m[0], q1q2 + q0q3)
+                    + Fusion_Q_Mul(m[1], FUSION_Q_HALF - q1q1 - q3q3)
+                    + Fusion_Q_Mul(m[2], q2q3 - q0q1));
+            const int32_t bx = (int32_t) Fusion_Q_Sqrt(
+                    (int64_t) hx * hx + (int64_t) hy * hy);
+            const int32_t bz = 2 * (Fusion_Q_Mul(m[0], q1q3 - q0q2)
+                    + Fusion_Q_Mul(m[1], q2q3 + q0q1)
+                    + Fusion_Q_Mul(m[2], FUSION_Q_HALF - q1q1 - q2q2));
+
+            // Half of estimated direction of magnetic field.
+            const int32_t wx = Fusion_Q_Mul(bx, FUSION_Q_HALF - q2q2 - q3q3)
+                    + Fusion_Q_Mul(bz, q1q3 - q0q2);
+            const int32_t wy = Fusion_Q_Mul(bx, q1q2 - q0q3)
+                    + Fusion_Q_Mul(bz, q0q1 + q2q3);
+            const int32_t wz = Fusion_Q_Mul(bx, q0q2 + q1q3)
+                    + Fusion_Q_Mul(bz, FUSION_Q_HALF - q1q1 - q2q2);
+
+            e[0] += Fusion_Q_Mul(m[1], wz) - Fusion_Q_Mul(m[2], wy);
+            e[1] += Fusion_Q_Mul(m[2], wx) - Fusion_Q_Mul(m[0], wz);
+            e[2] += Fusion_Q_Mul(m[0], wy) - Fusion_Q_Mul(m[1], wx);
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            if (state->two_ki != 0)
+            {
+                // Q16 * Q30 >> 16 yields Q30, dt is reduced to Q24 so that
+                // the product fits 64 bits.
+                const int64_t ie = ((int64_t) state->two_ki * e[i]) >> 16;
+
+                state->integral[i] += (int32_t) ((ie * (dt >> 8)) >> 24);
+                g[i] += state->integral[i] >> 14;
+            }
+
+            g[i] += Fusion_Q_Mul(state->two_kp, e[i]);
+        }
+    }
+
+    // Rotation by half of angle travelled in Q30, Q16 * Q32 >> 18 yields
+    // Q30 and one more shift halves the angle.
+    for (int i = 0; i < 3; ++i)
+    {
+        h[i] = (int32_t) (((int64_t) g[i] * dt) >> 19);
+    }
+
+    q0 = q[0];
+    q1 = q[1];
+    q2 = q[2];
+    q3 = q[3];
+    q[0] += -Fusion_Q_Mul(q1, h[0]) - Fusion_Q_Mul(q2, h[1])
+            - Fusion_Q_Mul(q3, h[2]);
+    q[1] += Fusion_Q_Mul(q0, h[0]) + Fusion_Q_Mul(q2, h[2])
+            - Fusion_Q_Mul(q3, h[1]);
+    q[2] += Fusion_Q_Mul(q0, h[1]) - Fusion_Q_Mul(q1, h[2])
+            + Fusion_Q_Mul(q3, h[0]);
+    q[3] += Fusion_Q_Mul(q0, h[2]) + Fusion_Q_Mul(q1, h[1])
+            - Fusion_Q_Mul(q2, h[0]);
+
+    // Squared norm stays close to 1.0 after a single step, so the first order
+    // approximation 1 / sqrt(n) ~ (3 - n) / 2 renormalizes without square
+    // root or division.
+    norm = (int32_t) (((int64_t) q[0] * q[0] + (int64_t) q[1] * q[1]
+            + (int64_t) q[2] * q[2] + (int64_t) q[3] * q[3]) >> 30);
+    inv = FUSION_Q_ONE + (FUSION_Q_ONE - norm) / 2;
+    for (int i = 0; i < 4; ++i)
+    {
+        q[i] = Fusion_Q_Mul(q[i], inv);
+    }
+}
+
+void Fusion_Q_GetEuler(const struct Fusion_Q_State* state, int32_t* euler)
+{
+    const int32_t* q = state->q;
+    const int32_t q0q1 = Fusion_Q_Mul(q[0], q[1]);
+    const int32_t q0q2 = Fusion_Q_Mul(q[0], q[2]);
+    const int32_t q0q3 = Fusion_Q_Mul(q[0], q[3]);
+    const int32_t q1q1 = Fusion_Q_Mul(q[1], q[1]);
+    const int32_t q1q2 = Fusion_Q_Mul(q[1], q[2]);
+    const int32_t q1q3 = Fusion_Q_Mul(q[1], q[3]);
+    const int32_t q2q2 = Fusion_Q_Mul(q[2], q[2]);
+    const int32_t q2q3 = Fusion_Q_Mul(q[2], q[3]);
+    const int32_t q3q3 = Fusion_Q_Mul(q[3], q[3]);
+    int32_t sin_roll;
+    int32_t heading;
+
+    // Filter estimates rotation from sensor to north-west-up frame while
+    // orientation angles are defined for east-north-up.
+    heading = Fusion_Q_Atan2(-2 * (FUSION_Q_HALF - q1q1 - q3q3),
+            2 * (q1q2 - q0q3));
+    if (heading < 0)
+    {
+        heading += 360 << 16;
+    }
+    euler[0] = Fusion_Q_ToCenti(heading);
+    if (euler[0] >= 36000)
+    {
+        euler[0] -= 36000;
+    }
+
+    euler[1] = Fusion_Q_ToCenti(Fusion_Q_Atan2(-2 * (q2q3 + q0q1),
+            2 * (FUSION_Q_HALF - q1q1 - q2q2)));
+
+    sin_roll = 2 * (q1q3 - q0q2);
+    if (sin_roll > FUSION_Q_ONE)
+    {
+        sin_roll = FUSION_Q_ONE;
+    }
+    else if (sin_roll < -FUSION_Q_ONE)
+    {
+        sin_roll = -FUSION_Q_ONE;
+    }
+    euler[2] = Fusion_Q_ToCenti(Fusion_Q_Atan2(sin_roll,
+            (int32_t) Fusion_Q_Sqrt((int64_t) FUSION_Q_ONE * FUSION_Q_ONE
+                    - (int64_t) sin_roll * sin_roll)));
+}
@@ -46,6 +46,25 @@
 static int CSN_SYS_RequestHandler(const struct CS_Request_Struct* request,
                                   char* response);
 
+static int CS_ParseRequest(char* request, struct CS_Request_Struct* parsed,
+                           uint32_t* node_hash);
+
+static int CS_CallNode(struct CS_Node_Struct* node,
+                       const struct CS_Request_Struct* request,
+                       char* response);
+
+static int CS_ComposeResponse(const char* token, const char* response);
+
+static int CS_ProcessBatchRequest(struct CS_Node_Struct* node,
+                                  struct CS_Request_Struct* request,
+                                  char* property_list);
+
+static int CS_SubscriptionRequest(struct CS_Node_Struct* node,
+                                  const struct CS_Request_Struct* request,
+                                  char* response);
+
+static void CS_PushSubscription(struct CS_Subscription_Struct* sub);
+
 
 //-----------------------------------------------------------------------------
 // INTERNAL VARIABLES
@@ -78,6 +97,17 @@ int CS_Init()
 	{
 		cs.node[i] = NULL;
 	}
+	CS_NameIndexInit(&cs.node_index);
+	cs.timer_ctx = NULL;
+	cs.binary_encoding = 0;
+	for (i = 0; i < CS_MAX_SUBSCRIPTION_COUNT; ++i)
+	{
+		cs.sub[i].node = NULL;
+	}
+	for (i = 0; i < CS_MAX_PENDING_COUNT; ++i)
+	{
+		cs.pending[i].node = NULL;
+	}
 	cs.conf_content = NULL;
 	cs.conf_content_len = 0;
 	cs.conf_page_cnt = 0;
@@ -113,6 +143,13 @@ int CS_RegisterNode(struct CS_Node_Struct* node)
 		return CS_ERROR;
 	}
 
+	if (CS_NameIndexAdd(&cs.node_index, node->name, cs.node_cnt) != CS_OK)
+	{
+		CS_SYS_Error("Node name '%s' is already registered.", node->name);
+		return CS_ERROR;
+	}
+
+	node->index = cs.node_cnt;
 	cs.node[cs.node_cnt] = node;
 	cs.node_cnt += 1;
 
@@ -124,8 +161,9 @@ int CS_ProcessRequest(char *request)
 {
 	ledNotif2(3, 200);
 
-	int errcode, i;
+	int errcode, i, tx_len;
 	uint32_t timestamp;
+	uint32_t node_hash;
 	struct CS_Request_Struct parsed_request;
 
 	if (request == NULL)
@@ -142,120 +180,151 @@ int CS_ProcessRequest(char *request)
 	CS_SYS_Info("Received request packet: '%s'", request);
 #endif
 
-	// Parse header information
-	parsed_request.token = strtok(request, "/");
-	if (parsed_request.token == NULL)
+	if (CS_ParseRequest(request, &parsed_request, &node_hash) != CS_OK)
 	{
-		CS_SYS_Error("Failed to parse request token.");
 		return CS_ERROR;
 	}
-	if (strlen(parsed_request.token) != 1)
+
+	// Look up the addressed node.
+	i = CS_NameIndexFind(&cs.node_index, parsed_request.node, node_hash);
+	if (i < 0)
 	{
-		CS_SYS_Error("Invalid request token length.");
+		CS_SYS_Error("No matching node found for '%s'", parsed_request.node);
+		sprintf(cs_tx_buffer, "%s/e/UNK_NODE", parsed_request.token);
+		errcode = CS_PlatformWrite(cs_tx_buffer, strlen(cs_tx_buffer));
+		if (errcode != CS_OK)
+		{
+			CS_SYS_Error("Platform send failed. (errcode=%d)", errcode);
+			return CS_ERROR;
+		}
+
 		return CS_ERROR;
 	}
-	if (parsed_request.token[0] < '0' || parsed_request.token[0] > '~')
+
+	// Subscription management requests are handled by CS for all nodes.
+	if (parsed_request.property_value != NULL &&
+	    (strncmp(parsed_request.property_value, "SUB/", 4) == 0 ||
+	     strcmp(parsed_request.property_value, "UNSUB") == 0))
 	{
-		CS_SYS_Error("Invalid request token value.");
-		return CS_ERROR;
+		errcode = CS_SubscriptionRequest(cs.node[i], &parsed_request,
+				cs_node_response);
+		if (errcode == CS_NO_RESPONSE)
+		{
+			return CS_OK;
+		}
+		CS_ComposeResponse(parsed_request.token, cs_node_response);
+		return CS_InjectResponse(cs_tx_buffer);
 	}
 
-	parsed_request.node = strtok(NULL, "/");
-	if (parsed_request.node == NULL)
+	// Comma separated list of properties in a read request.
+	if (parsed_request.property_value == NULL &&
+	    strchr(parsed_request.property, ',') != NULL)
 	{
-		CS_SYS_Error("Failed to parse request node name.");
-		return CS_ERROR;
+		errcode = CS_ProcessBatchRequest(cs.node[i], &parsed_request,
+				(char*)parsed_request.property);
+		if (errcode == CS_OK)
+		{
+			timestamp = CS_PlatformTime() - timestamp;
+			CS_SYS_Verbose("Request completed in %lu ms.", timestamp);
+		}
+		return errcode;
 	}
 
-	parsed_request.property = strtok(NULL, "/");
-	if (parsed_request.property == NULL)
+	// Matching node was found -> pass request
+	errcode = CS_CallNode(cs.node[i], &parsed_request, cs_node_response);
+	if (errcode == CS_NO_RESPONSE)
 	{
-		CS_SYS_Error("Failed to parse request node property.");
-		return CS_ERROR;
+		return CS_OK;
 	}
 
-	// NULL for read requests
-	parsed_request.property_value = strtok(NULL, "/");
-
-	// Iterate all available nodes to find a match.
-	for (i = 0; i < cs.node_cnt; ++i)
-	{
-		if (strcmp(parsed_request.node, cs.node[i]->name) == 0)
-		{
-			// Matching node was found -> pass request
-			errcode = cs.node[i]->request_handler(&parsed_request, cs_node_response);
-			if (errcode == CS_OK &&
-			    strlen(cs_node_response) <= CS_MAX_RESPONSE_LENGTH) // 2b for token + response = 20b
-			{
-				// Compose response packet from token + node response
-				sprintf(cs_tx_buffer, "%s/%s", parsed_request.token, cs_node_response);
+	// Compose response packet from token + node response
+	tx_len = CS_ComposeResponse(parsed_request.token, cs_node_response);
 #if CS_LOG_WITH_ANSI_COLORS != 0 && defined RTE_DEVICE_BDK_OUTPUT_REDIRECTION
-                CS_SYS_Info(
-                        "Composed response packet '" COLORIZE("%s", MAGENTA, BOLD) "'",
-                        cs_tx_buffer);
+	CS_SYS_Info(
+			"Composed response packet '" COLORIZE("%s", MAGENTA, BOLD) "'",
+			cs_tx_buffer);
 #else
-				CS_SYS_Info("Composed response packet '%s'", cs_tx_buffer);
+	CS_SYS_Info("Composed response packet '%s'", cs_tx_buffer);
 #endif
 
-				// Send response to platform
-				int res_len = strlen(cs_tx_buffer);
-				if (CS_PlatformWrite(cs_tx_buffer, res_len) == CS_OK)
-				{
-					timestamp = CS_PlatformTime() - timestamp;
-					CS_SYS_Verbose("Request completed in %lu ms.", timestamp);
-					return CS_OK;
-				}
-				else
-				{
-					CS_SYS_Error("Platform send failed. (errcode=%d)", errcode);
-					return CS_ERROR;
-				}
-			}
-			else if (errcode == CS_NO_RESPONSE)
-			{
-			    return CS_OK;
-			}
-			else
-			{
-				CS_SYS_Error("Node request processing error. (errcode=%d)", errcode);
-				sprintf(cs_tx_buffer, "%s/e/UNK_ERROR", parsed_request.token);
-				errcode = CS_PlatformWrite(cs_tx_buffer, strlen(cs_tx_buffer));
-				if (errcode != CS_OK)
-				{
-					CS_SYS_Error("Platform send failed. (errcode=%d)", errcode);
-					return CS_ERROR;
-				}
-				// Node failed to process request
-				return CS_ERROR;
-			}
-		}
+	// Send response to platform
+	if (CS_PlatformWrite(cs_tx_buffer, tx_len) != CS_OK)
+	{
+		CS_SYS_Error("Platform send failed.");
+		return CS_ERROR;
 	}
 
-	CS_SYS_Error("No matching node found for '%s'", parsed_request.node);
-	sprintf(cs_tx_buffer, "%s/e/UNK_NODE", parsed_request.token);
-	errcode = CS_PlatformWrite(cs_tx_buffer, strlen(cs_tx_buffer));
 	if (errcode != CS_OK)
 	{
-		CS_SYS_Error("Platform send failed. (errcode=%d)", errcode);
+		// Node failed to process request
 		return CS_ERROR;
 	}
 
-	return CS_ERROR;
+	timestamp = CS_PlatformTime() - timestamp;
+	CS_SYS_Verbose("Request completed in %lu ms.", timestamp);
+	return CS_OK;
 }
 
 int CS_PollNodes(void)
 {
+    for (int i = 0; i < CS_MAX_SUBSCRIPTION_COUNT; ++i)
+    {
+        struct CS_Subscription_Struct* sub = &cs.sub[i];
+
+        if (sub->node != NULL && stimer_is_expired(&sub->timer))
+        {
+            // Keep the period stable but do not try to catch up if some
+            // periods were missed.
+            stimer_advance(&sub->timer);
+            if (stimer_is_expired(&sub->timer))
+            {
+                stimer_restart_from_now(&sub->timer);
+            }
+
+            CS_PushSubscription(sub);
+        }
+    }
+
+    // Take all notifications at once. Nodes notified while their handlers
+    // run are polled on the next call.
+    uint32_t pending = __atomic_exchange_n(&cs.poll_pending, 0,
+            __ATOMIC_SEQ_CST);
+
     for (int i = 0; i < cs.node_cnt; ++i)
     {
-        if (cs.node[i]->poll_handler != NULL)
+        struct CS_Node_Struct* node = cs.node[i];
+
+        if (node->poll_handler == NULL)
+        {
+            continue;
+        }
+
+        if ((pending & (1U << i)) != 0
+            || (node->poll_timer != NULL && node->poll_timer->is_running
+                && stimer_is_expired(node->poll_timer)))
         {
-            cs.node[i]->poll_handler();
+            node->poll_handler();
         }
     }
 
     return CS_OK;
 }
 
+void CS_NotifyNode(const struct CS_Node_Struct* node)
+{
+    if (node != NULL && node->index >= 0 && node->index < cs.node_cnt
+        && cs.node[node->index] == node)
+    {
+        __atomic_fetch_or(&cs.poll_pending, 1U << node->index,
+                __ATOMIC_SEQ_CST);
+    }
+}
+
+bool CS_IsPollPending(void)
+{
+    return cs.poll_pending != 0;
+}
+
 int CS_InjectResponse(char* response)
 {
     int errcode;
@@ -263,7 +332,11 @@ int CS_InjectResponse(char* response)
 
     // check response length, including 2 bytes for token and 1 extra byte to
     // detect long response
-    response_len = strnlen(response, CS_MAX_RESPONSE_LENGTH + 3);
+    response_len = strnlen(response, 2);
+    if (response_len == 2)
+    {
+        response_len += CS_ResponseLength(&response[2]);
+    }
     if (response_len > CS_MAX_RESPONSE_LENGTH + 2)
     {
         CS_SYS_Error("Attempting to inject too long response packet.");
@@ -293,6 +366,23 @@ int CS_InjectResponse(char* response)
 
 int CS_SetPowerMode(enum CS_PowerMode mode)
 {
+    if (mode == CS_POWER_MODE_SLEEP)
+    {
+        cs.binary_encoding = 0;
+        for (int i = 0; i < CS_MAX_PENDING_COUNT; ++i)
+        {
+            cs.pending[i].node = NULL;
+        }
+        for (int i = 0; i < CS_MAX_SUBSCRIPTION_COUNT; ++i)
+        {
+            if (cs.sub[i].node != NULL)
+            {
+                stimer_stop(&cs.sub[i].timer);
+                cs.sub[i].node = NULL;
+            }
+        }
+    }
+
     for (int i = 0; i < cs.node_cnt; ++i)
     {
         if (cs.node[i]->power_handler != NULL)
@@ -304,6 +394,189 @@ int CS_SetPowerMode(enum CS_PowerMode mode)
     return CS_OK;
 }
 
+int CS_AsyncBegin(const struct CS_Request_Struct* request, int* handle)
+{
+    struct CS_Node_Struct* node;
+    struct CS_Pending_Struct* pending;
+    int i, j, free_index = -1;
+
+    i = CS_NameIndexFind(&cs.node_index, request->node,
+            CS_NameHash(request->node));
+    if (i < 0 || strlen(request->property) > CS_PENDING_PROPERTY_LEN)
+    {
+        return CS_ERROR;
+    }
+    node = cs.node[i];
+
+    for (i = 0; i < CS_MAX_PENDING_COUNT; ++i)
+    {
+        pending = &cs.pending[i];
+        if (pending->node == NULL)
+        {
+            if (free_index < 0)
+            {
+                free_index = i;
+            }
+            continue;
+        }
+
+        if (pending->node == node &&
+            strcmp(pending->property, request->property) == 0)
+        {
+            // Join the request in flight unless this token already waits.
+            for (j = 0; j < pending->token_cnt; ++j)
+            {
+                if (pending->token[j] == request->token[0])
+                {
+                    break;
+                }
+            }
+            if (j == pending->token_cnt)
+            {
+                if (pending->token_cnt == CS_PENDING_MAX_TOKENS)
+                {
+                    CS_SYS_Error("Too many requests waiting for '%s/%s'.",
+                            node->name, request->property);
+                    return CS_ERROR;
+                }
+                pending->token[pending->token_cnt] = request->token[0];
+                pending->token_cnt += 1;
+            }
+
+            *handle = i;
+            return CS_PENDING;
+        }
+    }
+
+    if (free_index < 0)
+    {
+        CS_SYS_Error("Too many asynchronous requests in flight.");
+        return CS_ERROR;
+    }
+
+    pending = &cs.pending[free_index];
+    pending->node = node;
+    strcpy(pending->property, request->property);
+    pending->token[0] = request->token[0];
+    pending->token_cnt = 1;
+
+    *handle = free_index;
+    return CS_OK;
+}
+
+int CS_AsyncComplete(int handle, const char* response)
+{
+    struct CS_Pending_Struct* pending;
+    char token[2] = { '\0', '\0' };
+    int errcode = CS_OK;
+
+    if (handle < 0 || handle >= CS_MAX_PENDING_COUNT ||
+        cs.pending[handle].node == NULL ||
+        CS_ResponseLength(response) > CS_MAX_RESPONSE_LENGTH)
+    {
+        CS_AsyncCancel(handle);
+        return CS_ERROR;
+    }
+
+    pending = &cs.pending[handle];
+    for (int i = 0; i < pending->token_cnt; ++i)
+    {
+        token[0] = pending->token[i];
+        CS_ComposeResponse(token, response);
+        if (CS_InjectResponse(cs_tx_buffer) != CS_OK)
+        {
+            errcode = CS_ERROR;
+        }
+    }
+
+    pending->node = NULL;
+    return errcode;
+}
+
+void CS_AsyncCancel(int handle)
+{
+    if (handle >= 0 && handle < CS_MAX_PENDING_COUNT)
+    {
+        cs.pending[handle].node = NULL;
+    }
+}
+
+int CS_IsBinaryEncoding(void)
+{
+    return cs.binary_encoding;
+}
+
+int CS_EncodeInt16(char* response, const int16_t* values, int count)
+{
+    uint8_t* p = (uint8_t*)response;
+
+    *p++ = CS_BIN_TAG(CS_BIN_INT16, count);
+    for (int i = 0; i < count; ++i)
+    {
+        *p++ = (uint8_t)values[i];
+        *p++ = (uint8_t)((uint16_t)values[i] >> 8);
+    }
+    *p = '\0';
+
+    return 1 + count * 2;
+}
+
+int CS_EncodeInt32(char* response, const int32_t* values, int count)
+{
+    uint8_t* p = (uint8_t*)response;
+
+    *p++ = CS_BIN_TAG(CS_BIN_INT32, count);
+    for (int i = 0; i < count; ++i)
+    {
+        *p++ = (uint8_t)values[i];
+        *p++ = (uint8_t)((uint32_t)values[i] >> 8);
+        *p++ = (uint8_t)((uint32_t)values[i] >> 16);
+        *p++ = (uint8_t)((uint32_t)values[i] >> 24);
+    }
+    *p = '\0';
+
+    return 1 + count * 4;
+}
+
+int CS_ResponseLength(const char* response)
+{
+    static const uint8_t value_size[8] = { 1, 2, 4, 4, 0, 0, 0, 0 };
+    const uint8_t* p = (const uint8_t*)response;
+    int len = 0;
+
+    // Stop early on anything longer than the longest valid packet.
+    while (p[len] != '\0' && len <= CS_MAX_RESPONSE_LENGTH + 2)
+    {
+        if (CS_IS_BIN_TAG(p[len]))
+        {
+            len += 1 + value_size[(p[len] >> 4) & 0x07] * ((p[len] & 0x0F) + 1);
+        }
+        else
+        {
+            while (p[len] != '\0' && p[len] != ';')
+            {
+                ++len;
+            }
+            if (p[len] == ';')
+            {
+                ++len;
+            }
+        }
+    }
+
+    return len;
+}
+
+void CS_SetTimerContext(struct stimer_ctx* ctx)
+{
+    cs.timer_ctx = ctx;
+    for (int i = 0; i < CS_MAX_SUBSCRIPTION_COUNT; ++i)
+    {
+        stimer_init(&cs.sub[i].timer, ctx);
+        cs.sub[i].node = NULL;
+    }
+}
+
 void CS_SetAppConfig(const char* content)
 {
 	if (content == NULL)
@@ -364,6 +637,394 @@ void CS_Log(enum CS_Log_Level level, const char* module, const char* fmt, ...)
 	}
 }
 
+uint32_t CS_NameHash(const char* name)
+{
+	uint32_t hash = CS_NAME_HASH_INIT;
+
+	while (*name != '\0')
+	{
+		hash = CS_NameHashUpdate(hash, *name);
+		++name;
+	}
+
+	return hash;
+}
+
+void CS_NameIndexInit(struct CS_NameIndex_Struct* index)
+{
+	memset(index, 0, sizeof(struct CS_NameIndex_Struct));
+}
+
+int CS_NameIndexAdd(struct CS_NameIndex_Struct* index, const char* name,
+		uint8_t id)
+{
+	uint32_t slot = CS_NameHash(name);
+	int i;
+
+	// Linear probing until a free slot is found.
+	for (i = 0; i < CS_NAME_INDEX_SIZE; ++i, ++slot)
+	{
+		slot &= (CS_NAME_INDEX_SIZE - 1);
+		if (index->name[slot] == NULL)
+		{
+			index->name[slot] = name;
+			index->id[slot] = id;
+			return CS_OK;
+		}
+		if (strcmp(index->name[slot], name) == 0)
+		{
+			return CS_ERROR;
+		}
+	}
+
+	return CS_ERROR;
+}
+
+int CS_NameIndexFind(const struct CS_NameIndex_Struct* index,
+		const char* name, uint32_t hash)
+{
+	uint32_t slot = hash;
+	int i;
+
+	// Probe sequence ends at first empty slot.
+	for (i = 0; i < CS_NAME_INDEX_SIZE; ++i, ++slot)
+	{
+		slot &= (CS_NAME_INDEX_SIZE - 1);
+		if (index->name[slot] == NULL)
+		{
+			return -1;
+		}
+		if (strcmp(index->name[slot], name) == 0)
+		{
+			return index->id[slot];
+		}
+	}
+
+	return -1;
+}
+
+/** \brief Splits request packet into its fields in a single pass.
+ *
+ * Separators between token, node and property are replaced by zero
+ * characters. Everything after the third separator is property value.
+ * Hashes of node and property names are computed while scanning.
+ */
+static int CS_ParseRequest(char* request, struct CS_Request_Struct* parsed,
+                           uint32_t* node_hash)
+{
+	static const char* const field_error[3] = {
+		"Failed to parse request token.",
+		"Failed to parse request node name.",
+		"Failed to parse request node property."
+	};
+	const char* field[3];
+	uint32_t hash[3];
+	char* c = request;
+	int i;
+
+	for (i = 0; i < 3; ++i)
+	{
+		field[i] = c;
+		hash[i] = CS_NAME_HASH_INIT;
+		while (*c != '/' && *c != '\0')
+		{
+			hash[i] = CS_NameHashUpdate(hash[i], *c);
+			++c;
+		}
+
+		// Empty fields and missing separators are not allowed except for
+		// missing value separator of read requests.
+		if (c == field[i] || (*c == '\0' && i < 2))
+		{
+			CS_SYS_Error("%s", field_error[i]);
+			return CS_ERROR;
+		}
+
+		if (*c == '/')
+		{
+			*c = '\0';
+			++c;
+		}
+	}
+
+	if (field[1] - field[0] != 2)
+	{
+		CS_SYS_Error("Invalid request token length.");
+		return CS_ERROR;
+	}
+	if (field[0][0] < '0' || field[0][0] > '~')
+	{
+		CS_SYS_Error("Invalid request token value.");
+		return CS_ERROR;
+	}
+
+	parsed->token = field[0];
+	parsed->node = field[1];
+	parsed->property = field[2];
+	parsed->property_hash = hash[2];
+
+	// NULL for read requests
+	parsed->property_value = (*c != '\0') ? c : NULL;
+
+	*node_hash = hash[1];
+
+	return CS_OK;
+}
+
+/** \brief Passes request to node request handler.
+ *
+ * Failed requests and too long responses are replaced with UNK_ERROR error
+ * response so that response buffer always contains a valid response unless
+ * CS_NO_RESPONSE is returned.
+ */
+static int CS_CallNode(struct CS_Node_Struct* node,
+                       const struct CS_Request_Struct* request,
+                       char* response)
+{
+	int errcode;
+
+	errcode = node->request_handler(request, response);
+	if (errcode == CS_OK &&
+	    CS_ResponseLength(response) <= CS_MAX_RESPONSE_LENGTH) // 2b for token + response = 20b
+	{
+		return CS_OK;
+	}
+	else if (errcode == CS_NO_RESPONSE)
+	{
+		return CS_NO_RESPONSE;
+	}
+
+	CS_SYS_Error("Node request processing error. (errcode=%d)", errcode);
+	strcpy(response, "e/UNK_ERROR");
+	return CS_ERROR;
+}
+
+/** \brief Composes response packet from token and node response.
+ *
+ * \returns Length of the packet in cs_tx_buffer.
+ */
+static int CS_ComposeResponse(const char* token, const char* response)
+{
+	int response_len = CS_ResponseLength(response);
+
+	cs_tx_buffer[0] = token[0];
+	cs_tx_buffer[1] = '/';
+	memcpy(&cs_tx_buffer[2], response, response_len + 1);
+
+	return response_len + 2;
+}
+
+/** \brief Processes read request for a comma separated list of properties.
+ *
+ * Each property is passed to the node separately. ASCII responses are
+ * followed by ';' and binary responses are appended directly. Responses are
+ * packed into as few response packets as possible. Every packet
+ * starts with the request token so the peer can match it to the request.
+ * Properties for which the node does not respond immediately are skipped.
+ */
+static int CS_ProcessBatchRequest(struct CS_Node_Struct* node,
+                                  struct CS_Request_Struct* request,
+                                  char* property_list)
+{
+	char* name = property_list;
+	char* next;
+	int header_len, tx_len, response_len;
+	int errcode = CS_OK;
+	int needs_separator = 0;
+
+	header_len = sprintf(cs_tx_buffer, "%s/", request->token);
+	tx_len = header_len;
+
+	while (name != NULL)
+	{
+		next = strchr(name, ',');
+		if (next != NULL)
+		{
+			*next = '\0';
+			++next;
+		}
+
+		request->property = name;
+		request->property_hash = CS_NameHash(name);
+		name = next;
+
+		if (CS_CallNode(node, request, cs_node_response) == CS_NO_RESPONSE)
+		{
+			continue;
+		}
+
+		// Flush packet if this response does not fit.
+		response_len = CS_ResponseLength(cs_node_response);
+		if (tx_len > header_len &&
+		    tx_len + needs_separator + response_len > CS_MAX_RESPONSE_LENGTH + 2)
+		{
+			CS_SYS_Info("Composed response packet '%s'", cs_tx_buffer);
+			if (CS_PlatformWrite(cs_tx_buffer, tx_len) != CS_OK)
+			{
+				errcode = CS_ERROR;
+			}
+			tx_len = header_len;
+			needs_separator = 0;
+		}
+
+		// Binary items have known length and need no separator.
+		if (needs_separator)
+		{
+			cs_tx_buffer[tx_len] = ';';
+			tx_len += 1;
+		}
+		memcpy(&cs_tx_buffer[tx_len], cs_node_response, response_len + 1);
+		tx_len += response_len;
+		needs_separator = !CS_IS_BIN_TAG(cs_node_response[0]);
+	}
+
+	if (tx_len > header_len)
+	{
+		CS_SYS_Info("Composed response packet '%s'", cs_tx_buffer);
+		if (CS_PlatformWrite(cs_tx_buffer, tx_len) != CS_OK)
+		{
+			errcode = CS_ERROR;
+		}
+	}
+
+	if (errcode != CS_OK)
+	{
+		CS_SYS_Error("Platform send failed.");
+	}
+
+	return errcode;
+}
+
+/** \brief Handles SUB/<ms> and UNSUB property values.
+ *
+ * Subscription is identified by node and property. Subscribing again to the
+ * same property only updates its token and period.
+ */
+static int CS_SubscriptionRequest(struct CS_Node_Struct* node,
+                                  const struct CS_Request_Struct* request,
+                                  char* response)
+{
+	struct CS_Subscription_Struct* sub = NULL;
+	struct CS_Subscription_Struct* free_sub = NULL;
+	const char* c;
+	uint32_t interval_ms;
+	int i;
+
+	for (i = 0; i < CS_MAX_SUBSCRIPTION_COUNT; ++i)
+	{
+		if (cs.sub[i].node == node &&
+		    strcmp(cs.sub[i].property, request->property) == 0)
+		{
+			sub = &cs.sub[i];
+		}
+		else if (cs.sub[i].node == NULL && free_sub == NULL)
+		{
+			free_sub = &cs.sub[i];
+		}
+	}
+
+	if (strcmp(request->property_value, "UNSUB") == 0)
+	{
+		if (sub == NULL)
+		{
+			strcpy(response, "e/NO_SUB");
+			return CS_OK;
+		}
+
+		stimer_stop(&sub->timer);
+		sub->node = NULL;
+		CS_SYS_Info("Unsubscribed '%s/%s'.", node->name, request->property);
+		strcpy(response, "t/UNSUB");
+		return CS_OK;
+	}
+
+	// Validate subscription period
+	c = &request->property_value[4];
+	if (*c == '\0')
+	{
+		strcpy(response, "e/INV_VALUE");
+		return CS_OK;
+	}
+	while (*c != '\0')
+	{
+		if (isdigit((int)*c) == 0)
+		{
+			strcpy(response, "e/INV_VALUE");
+			return CS_OK;
+		}
+		++c;
+	}
+	interval_ms = strtoul(&request->property_value[4], NULL, 10);
+	if (interval_ms < CS_SUB_MIN_INTERVAL_MS ||
+	    interval_ms > CS_SUB_MAX_INTERVAL_MS)
+	{
+		strcpy(response, "e/INV_VALUE");
+		return CS_OK;
+	}
+
+	if (cs.timer_ctx == NULL ||
+	    strlen(request->property) > CS_SUB_PROPERTY_LEN)
+	{
+		strcpy(response, "e/SUB_UNAVAIL");
+		return CS_OK;
+	}
+
+	if (sub == NULL)
+	{
+		if (free_sub == NULL)
+		{
+			strcpy(response, "e/SUB_FULL");
+			return CS_OK;
+		}
+		sub = free_sub;
+		strcpy(sub->property, request->property);
+		sub->node = node;
+	}
+
+	sub->token = request->token[0];
+	sub->interval_ms = interval_ms;
+	stimer_set_slack_ms(&sub->timer, interval_ms >> CS_SUB_SLACK_SHIFT);
+	stimer_expire_from_now_ms(&sub->timer, interval_ms);
+
+	CS_SYS_Info("Subscribed '%s/%s' every %lu ms.", node->name, sub->property,
+			interval_ms);
+
+	// First value is sent right away as confirmation of the subscription.
+	CS_PushSubscription(sub);
+	return CS_NO_RESPONSE;
+}
+
+/** \brief Sends current value of subscribed property to the peer device. */
+static void CS_PushSubscription(struct CS_Subscription_Struct* sub)
+{
+	struct CS_Request_Struct request;
+	char property[CS_SUB_PROPERTY_LEN + 1];
+	char token[2] = { sub->token, '\0' };
+
+	// Request parsing modifies the property string.
+	strcpy(property, sub->property);
+
+	request.token = token;
+	request.node = sub->node->name;
+	request.property = property;
+	request.property_value = NULL;
+	request.property_hash = CS_NameHash(property);
+
+	if (strchr(property, ',') != NULL)
+	{
+		CS_ProcessBatchRequest(sub->node, &request, property);
+		return;
+	}
+
+	if (CS_CallNode(sub->node, &request, cs_node_response) == CS_NO_RESPONSE)
+	{
+		return;
+	}
+
+	CS_ComposeResponse(token, cs_node_response);
+	CS_InjectResponse(cs_tx_buffer);
+}
+
 static int CSN_SYS_RequestHandler(const struct CS_Request_Struct* request, char* response)
 {
 	ledNotif2(2, 200);
@@ -399,6 +1060,29 @@ static int CSN_SYS_RequestHandler(const struct CS_Request_Struct* request, char*
 		}
 	}
 
+	// ENC property request (RW)
+	if (strcmp(request->property, "ENC") == 0)
+	{
+		if (request->property_value != NULL)
+		{
+			if (strcmp(request->property_value, "0") == 0 ||
+			    strcmp(request->property_value, "1") == 0)
+			{
+				cs.binary_encoding = request->property_value[0] - '0';
+				CS_SYS_Info("Response encoding set to %s.",
+						cs.binary_encoding ? "binary" : "ASCII");
+			}
+			else
+			{
+				strcpy(response, "e/INV_VALUE");
+				return CS_OK;
+			}
+		}
+
+		sprintf(response, "i/%d", cs.binary_encoding);
+		return CS_OK;
+	}
+
 	// Check request type. Only R requests below.
 	if (request->property_value != NULL)
 	{
@@ -21,6 +21,7 @@
 #include "BLE_ICS.h"
 #include "aes.h"
 #include "app_trace.h"
+#include "HAL_RTC.h"
 
 
 #define AES_SALT  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x54, 0x56, \
@@ -77,7 +78,8 @@ int CS_PlatformWrite(const char* tx_data, int tx_data_len)
 
 uint32_t CS_PlatformTime()
 {
-	return HAL_Time();
+	/* RTC keeps running in deep sleep. */
+	return (uint32_t)HAL_RTC_TICKS_TO_MS(HAL_RTC_GetTime64());
 }
 
 void CS_PlatformLogPrintf(const char* fmt, ...)
@@ -0,0 +1,464 @@
+/**
+ * Host test of sample rate properties and event capture of the AO node.
+ *
+ * Sends CS requests to the AO node the way the BLE transport does and checks
+ * the responses together with the calls the node makes to the BHI160 driver:
+ *
+ * - FO, FG, FA, FM and FAR writes outside 1..200 Hz and writes pushing the sum
+ *   of rates over RTE_APP_ICS_AO_MAX_TOTAL_RATE are rejected and leave the
+ *   rate unchanged.
+ * - Rate of an enabled sensor is applied in place, rate of a disabled sensor
+ *   is used when the sensor is enabled.
+ * - FU/1 is rejected while software fusion would exceed the rate limit.
+ * - Impact and free fall captures notify the host with the window length and
+ *   trigger index, free fall shorter than RTE_APP_ICS_AO_FREE_FALL_TIME does
+ *   not trigger.
+ * - Arming of the capture is rejected over the rate limit and sleep power
+ *   mode disarms it and releases the accelerometer.
+ *
+ * Capture samples are fed to the accelerometer callback installed by the node
+ * at CSN_LP_AO_CAPTURE_RATE. CSN_LP_AO.c is included directly to reach its
+ * static state. Build and run from the Firmware directory:
+ *
+ *   gcc -O2 -std=gnu99 -D_RTE_ -Itools/bench/stubs -Iinclude -Iinclude/bdk \
+ *       -IRTE -o ao_test tools/bench/ao_test.c src/ics/CS.c \
+ *       src/device/stimer.c src/fusion_q.c
+ *   ./ao_test
+ */
+
+#include <stdio.h>
+
+#include "../../src/CSN_LP_AO.c"
+
+/** Accelerometer dynamic range in g. */
+#define BENCH_ACCEL_RANGE              (4)
+
+/** Raw accelerometer value of 1 g. */
+#define BENCH_1G                       (32768 / BENCH_ACCEL_RANGE)
+
+/** Size of buffers for request and response packets. */
+#define BENCH_PACKET_SIZE              (64)
+
+/** BHI160 timestamp increment between capture samples, 32 kHz ticks. */
+#define BENCH_TS_STEP                  (32000 / CSN_LP_AO_CAPTURE_RATE)
+
+#define BENCH_CHECK(cond)                                               \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__,     \
+                    #cond);                                             \
+            return 1;                                                   \
+        }                                                               \
+    } while (0)
+
+/** Last packet sent by CS, responses and notifications alike. */
+static char bench_tx[BENCH_PACKET_SIZE];
+static int bench_tx_len;
+
+static struct stimer_ctx bench_timer_ctx;
+static uint64_t bench_now = HAL_RTC_XTAL_FREQ * 10;
+static uint32_t bench_timestamp;
+
+static int bench_normal_mode_cnt;
+
+/** Rate of enabled BHI160 sensors, 0 if disabled, indexed by [wakeup][id]. */
+static uint16_t bench_rate[2][32];
+static int bench_enable_cnt;
+
+static void (*bench_capture_cb)(bhy_data_generic_t*, bhy_virtual_sensor_t);
+
+static struct BHI160_NDOF_FifoStats bench_fifo_stats;
+
+int CS_PlatformInit(struct CS_Handle_Struct* handle)
+{
+    return CS_OK;
+}
+
+int CS_PlatformWrite(const char* tx_data_buf, int tx_data_buf_len)
+{
+    memcpy(bench_tx, tx_data_buf, tx_data_buf_len);
+    bench_tx[tx_data_buf_len] = '\0';
+    bench_tx_len = tx_data_buf_len;
+
+    return CS_OK;
+}
+
+uint32_t CS_PlatformTime(void)
+{
+    return 0;
+}
+
+void CS_PlatformLogPrintf(const char* fmt, ...)
+{
+}
+
+void CS_PlatformLogVprintf(const char* fmt, va_list args)
+{
+}
+
+void CS_PlatformLogLock(void)
+{
+}
+
+void CS_PlatformLogUnlock(void)
+{
+}
+
+void ledNotif2(uint8_t cnt, uint8_t period)
+{
+}
+
+uint64_t HAL_RTC_GetTime64(void)
+{
+    return bench_now;
+}
+
+static uint32_t Bench_GetTime(void* hint)
+{
+    return bench_now;
+}
+
+void EventCallback_Init(EventCallback_Type* handle, uint16_t id,
+        EventCallback_Prototype callback, void* arg)
+{
+}
+
+void EventCallback_Register(EventCallback_Type* handle)
+{
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_install_sensor_callback(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status,
+        void (*sensor_callback)(bhy_data_generic_t*, bhy_virtual_sensor_t))
+{
+    if (sensor_type == BHI160_NDOF_S_ACCELEROMETER
+        && wakeup_status == VS_NON_WAKEUP)
+    {
+        bench_capture_cb = sensor_callback;
+    }
+
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_enable_virtual_sensor(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status, uint16_t sample_rate,
+        uint16_t max_report_latency_ms, uint8_t flush_sensor,
+        uint16_t change_sensitivity, uint16_t dynamic_range)
+{
+    bench_rate[wakeup_status == VS_WAKEUP][sensor_type] = sample_rate;
+    bench_enable_cnt += 1;
+
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_disable_virtual_sensor(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status)
+{
+    bench_rate[wakeup_status == VS_WAKEUP][sensor_type] = 0;
+
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_set_fifo_water_mark(
+        bhy_fifo_buffer_type_t fifo_buffer_type, uint16_t fifo_water_mark)
+{
+    return BHY_SUCCESS;
+}
+
+uint32_t BHI160_NDOF_GetTimestamp(void)
+{
+    return bench_timestamp;
+}
+
+uint32_t BHI160_NDOF_GetWakeupTimestamp(void)
+{
+    return bench_timestamp;
+}
+
+int32_t BHI160_NDOF_Initialize(void)
+{
+    return BHY_SUCCESS;
+}
+
+int32_t BHI160_NDOF_AcquireNormalMode(void)
+{
+    bench_normal_mode_cnt += 1;
+    return BHY_SUCCESS;
+}
+
+int32_t BHI160_NDOF_ReleaseNormalMode(void)
+{
+    bench_normal_mode_cnt -= 1;
+    return BHY_SUCCESS;
+}
+
+uint16_t BHI160_NDOF_GetAccelDynamicRange(void)
+{
+    return BENCH_ACCEL_RANGE;
+}
+
+uint16_t BHI160_NDOF_GetGyroDynamicRange(void)
+{
+    return 2000;
+}
+
+uint16_t BHI160_NDOF_GetMagDynamicRange(void)
+{
+    return 1000;
+}
+
+const struct BHI160_NDOF_FifoStats* BHI160_NDOF_GetFifoStats(void)
+{
+    return &bench_fifo_stats;
+}
+
+int32_t BHI160_NDOF_SetFifoWatermark(uint16_t watermark)
+{
+    return BHY_SUCCESS;
+}
+
+/** Processes request and returns the response packet. */
+static const char* Bench_Request(const char* request)
+{
+    char buf[BENCH_PACKET_SIZE];
+
+    strcpy(buf, request);
+    bench_tx[0] = '\0';
+    CS_ProcessRequest(buf);
+
+    return bench_tx;
+}
+
+/** Returns int32 value of binary packet "t/<type><values>". */
+static int32_t Bench_Value(int i)
+{
+    int32_t v;
+
+    memcpy(&v, &bench_tx[3 + 4 * i], sizeof(v));
+    return v;
+}
+
+/** Feeds given number of equal samples to the capture accelerometer. */
+static void Bench_Accel(int cnt, int16_t x, int16_t y, int16_t z)
+{
+    bhy_data_generic_t data = { 0 };
+
+    for (int i = 0; i < cnt; ++i)
+    {
+        bench_timestamp += BENCH_TS_STEP;
+        data.data_vector.x = x;
+        data.data_vector.y = y;
+        data.data_vector.z = z;
+        bench_capture_cb(&data, VS_NON_WAKEUP);
+    }
+}
+
+static int Bench_RateTest(void)
+{
+    const uint16_t rate = CSN_LP_AO_SAMPLE_RATE;
+
+    BENCH_CHECK(strcmp(Bench_Request("1/AO/FO"), "1/i/5") == 0);
+
+    // Range and format of the rate.
+    BENCH_CHECK(strcmp(Bench_Request("2/AO/FO/0"), "2/e/INV_VALUE") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("2/AO/FG/201"), "2/e/INV_VALUE") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("2/AO/FA/1x"), "2/e/INV_VALUE") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("2/AO/FM/-5"), "2/e/INV_VALUE") == 0);
+    BENCH_CHECK(ao_rate[CSN_AO_SENSOR_ORIENTATION] == rate);
+    BENCH_CHECK(ao_rate[CSN_AO_SENSOR_GRAVITY] == rate);
+    BENCH_CHECK(ao_rate[CSN_AO_SENSOR_LIN_ACCEL] == rate);
+    BENCH_CHECK(ao_rate[CSN_AO_SENSOR_MAGNETIC_FIELD] == rate);
+    BENCH_CHECK(strcmp(Bench_Request("3/AO/FG/200"), "3/i/200") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("3/AO/FG/1"), "3/i/1") == 0);
+
+    // Sum of rates counts disabled sensors too, 3 * 5 + 200 + 36 = 251 Hz.
+    BENCH_CHECK(ao_enabled_sensors == 0);
+    BENCH_CHECK(strcmp(Bench_Request("3/AO/FG/5"), "3/i/5") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("4/AO/FAR/200"), "4/i/200") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("4/AO/FM/36"), "4/e/INV_VALUE") == 0);
+    BENCH_CHECK(ao_rate[CSN_AO_SENSOR_MAGNETIC_FIELD] == rate);
+    BENCH_CHECK(strcmp(Bench_Request("4/AO/FM/35"), "4/i/35") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("4/AO/FAR/201"), "4/e/INV_VALUE") == 0);
+    BENCH_CHECK(ao_rate[CSN_AO_SENSOR_RATE_OF_ROTATION] == 200);
+    BENCH_CHECK(strcmp(Bench_Request("4/AO/FAR/5"), "4/i/5") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("4/AO/FM/5"), "4/i/5") == 0);
+
+    // Disabled sensor gets its rate when it is enabled by a read.
+    BENCH_CHECK(strcmp(Bench_Request("5/AO/FG/20"), "5/i/20") == 0);
+    BENCH_CHECK(bench_enable_cnt == 0);
+    Bench_Request("5/AO/G");
+    BENCH_CHECK(bench_rate[1][BHI160_NDOF_S_GRAVITY] == 20);
+    BENCH_CHECK(bench_normal_mode_cnt == 1);
+
+    // Enabled sensor is reconfigured in place.
+    BENCH_CHECK(strcmp(Bench_Request("6/AO/FG/50"), "6/i/50") == 0);
+    BENCH_CHECK(bench_rate[1][BHI160_NDOF_S_GRAVITY] == 50);
+    BENCH_CHECK(strcmp(Bench_Request("6/AO/FG/50x"), "6/e/INV_VALUE") == 0);
+    BENCH_CHECK(bench_rate[1][BHI160_NDOF_S_GRAVITY] == 50);
+    BENCH_CHECK(bench_rate[1][BHI160_NDOF_S_ORIENTATION] == 0);
+    BENCH_CHECK(strcmp(Bench_Request("6/AO/FG/5"), "6/i/5") == 0);
+
+    return 0;
+}
+
+static int Bench_FusionTest(void)
+{
+    // Software fusion samples accelerometer at the rate of gyroscope in place
+    // of the orientation sensor, 180 + 5 * 3 + 180 = 375 Hz.
+    BENCH_CHECK(strcmp(Bench_Request("7/AO/FU/0"), "7/i/0") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("7/AO/FAR/180"), "7/i/180") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("8/AO/FU/1"), "8/e/INV_VALUE") == 0);
+    BENCH_CHECK(ao_fusion == CSN_AO_FUSION_BHI160);
+
+    // 100 + 5 * 3 + 100 = 215 Hz
+    BENCH_CHECK(strcmp(Bench_Request("9/AO/FAR/100"), "9/i/100") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("9/AO/FU/1"), "9/i/1") == 0);
+    BENCH_CHECK(ao_fusion == CSN_AO_FUSION_SOFTWARE);
+
+    // Gyroscope rate is now counted twice.
+    BENCH_CHECK(strcmp(Bench_Request("a/AO/FAR/120"), "a/e/INV_VALUE") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("a/AO/FAR/5"), "a/i/5") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("a/AO/FU/0"), "a/i/0") == 0);
+
+    return 0;
+}
+
+static int Bench_CaptureTest(void)
+{
+    const uint32_t pre = CSN_LP_AO_CAPTURE_PRE_TRIGGER;
+    const uint32_t post = CSN_AO_CAPTURE_POST_TRIGGER;
+    const int normal_mode_cnt = bench_normal_mode_cnt;
+    uint32_t start;
+
+    // Capture is available only with binary encoding.
+    BENCH_CHECK(strcmp(Bench_Request("b/AO/EV/1"), "b/e/ENC") == 0);
+    Bench_Request("c/SYS/ENC/1");
+    BENCH_CHECK(bench_capture_cb != NULL);
+
+    // Impact after 200 quiet samples. Window holds the pre-trigger samples
+    // before the impact and the post-trigger samples from the impact on.
+    Bench_Request("d/AO/EV/1");
+    BENCH_CHECK(Bench_Value(0) == CSN_AO_CAPTURE_ARMED);
+    BENCH_CHECK(bench_rate[0][BHI160_NDOF_S_ACCELEROMETER]
+            == CSN_LP_AO_CAPTURE_RATE);
+    BENCH_CHECK(bench_normal_mode_cnt == normal_mode_cnt + 1);
+
+    for (int i = 0; i < 200; ++i)
+    {
+        Bench_Accel(1, i, 0, BENCH_1G);
+    }
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_ARMED);
+    Bench_Accel(1, 0, 0, 4 * BENCH_1G);
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_TRIGGERED);
+    BENCH_CHECK(ao_capture.event == CSN_AO_EVENT_IMPACT);
+    BENCH_CHECK(ao_capture.trigger_seq == 200);
+    Bench_Accel(post - 2, 0, 0, BENCH_1G);
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_TRIGGERED);
+    Bench_Accel(1, 0, 0, BENCH_1G);
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_DONE);
+
+    // Window is frozen.
+    Bench_Accel(10, 0, 0, 4 * BENCH_1G);
+    BENCH_CHECK(ao_capture.seq == 200 + post);
+
+    start = CSN_AO_CaptureStart();
+    BENCH_CHECK(start == 200 - pre);
+    BENCH_CHECK(ao_capture.sample[start & CSN_AO_CAPTURE_MASK].v[0]
+            == (int16_t) (200 - pre));
+    BENCH_CHECK(ao_capture.sample[(200 - 1) & CSN_AO_CAPTURE_MASK].v[0]
+            == 200 - 1);
+
+    CS_PollNodes();
+    BENCH_CHECK(bench_tx_len == 2 + 1 + 4 * 4);
+    BENCH_CHECK(bench_tx[0] == 'd');
+    BENCH_CHECK(Bench_Value(0) == CSN_AO_EVENT_IMPACT);
+    BENCH_CHECK(Bench_Value(1) == CSN_LP_AO_CAPTURE_SIZE);
+    BENCH_CHECK(Bench_Value(2) == pre);
+    BENCH_CHECK(ao_capture.is_sampling == false);
+    BENCH_CHECK(bench_rate[0][BHI160_NDOF_S_ACCELEROMETER] == 0);
+    BENCH_CHECK(bench_normal_mode_cnt == normal_mode_cnt);
+
+    // Free fall shorter than CSN_LP_AO_FREE_FALL_TIME does not trigger.
+    Bench_Request("e/AO/EV/1");
+    BENCH_CHECK(Bench_Value(0) == CSN_AO_CAPTURE_ARMED);
+    Bench_Accel(5, 0, 0, BENCH_1G);
+    Bench_Accel(CSN_AO_FREE_FALL_CNT - 1, 0, 0, 100);
+    Bench_Accel(1, 0, 0, BENCH_1G);
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_ARMED);
+    BENCH_CHECK(ao_capture.free_fall_cnt == 0);
+
+    // Trigger sample of a free fall is its first sample under the threshold,
+    // which comes earlier than the pre-trigger samples.
+    Bench_Accel(CSN_AO_FREE_FALL_CNT, 0, 0, 100);
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_TRIGGERED);
+    BENCH_CHECK(ao_capture.event == CSN_AO_EVENT_FREE_FALL);
+    BENCH_CHECK(ao_capture.trigger_seq == 5 + CSN_AO_FREE_FALL_CNT);
+    Bench_Accel(post, 0, 0, BENCH_1G);
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_DONE);
+    BENCH_CHECK(CSN_AO_CaptureStart() == 0);
+
+    CS_PollNodes();
+    BENCH_CHECK(bench_tx[0] == 'e');
+    BENCH_CHECK(Bench_Value(0) == CSN_AO_EVENT_FREE_FALL);
+    BENCH_CHECK(Bench_Value(1) == 5 + CSN_AO_FREE_FALL_CNT + post);
+    BENCH_CHECK(Bench_Value(2) == 5 + CSN_AO_FREE_FALL_CNT);
+
+    // Capture rate counts toward the rate limit, 200 + 4 * 5 + 100 = 320 Hz.
+    Bench_Request("f/AO/FAR/200");
+    BENCH_CHECK(Bench_Value(0) == 200);
+    BENCH_CHECK(strcmp(Bench_Request("f/AO/EV/1"), "f/e/INV_VALUE") == 0);
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_DONE);
+    BENCH_CHECK(ao_capture.is_sampling == false);
+    BENCH_CHECK(bench_rate[0][BHI160_NDOF_S_ACCELEROMETER] == 0);
+
+    // Rate of sampling capture is counted by rate writes.
+    Bench_Request("g/AO/FAR/5");
+    BENCH_CHECK(Bench_Value(0) == 5);
+    Bench_Request("g/AO/EV/1");
+    BENCH_CHECK(Bench_Value(0) == CSN_AO_CAPTURE_ARMED);
+    BENCH_CHECK(strcmp(Bench_Request("g/SYS/ENC/0"), "g/i/0") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("g/AO/FAR/131"), "g/e/INV_VALUE") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("g/AO/FAR/130"), "g/i/130") == 0);
+    BENCH_CHECK(strcmp(Bench_Request("g/AO/FAR/5"), "g/i/5") == 0);
+
+    // Write of 0 stops the capture.
+    Bench_Request("h/SYS/ENC/1");
+    Bench_Request("h/AO/EV/0");
+    BENCH_CHECK(Bench_Value(0) == CSN_AO_CAPTURE_IDLE);
+    BENCH_CHECK(ao_capture.is_sampling == false);
+    BENCH_CHECK(bench_rate[0][BHI160_NDOF_S_ACCELEROMETER] == 0);
+    BENCH_CHECK(bench_normal_mode_cnt == normal_mode_cnt);
+
+    // Sleep disarms the capture and releases the accelerometer.
+    Bench_Request("i/AO/EV/1");
+    BENCH_CHECK(Bench_Value(0) == CSN_AO_CAPTURE_ARMED);
+    Bench_Accel(10, 0, 0, BENCH_1G);
+    CS_SetPowerMode(CS_POWER_MODE_SLEEP);
+    BENCH_CHECK(ao_capture.state == CSN_AO_CAPTURE_IDLE);
+    BENCH_CHECK(ao_capture.is_sampling == false);
+    BENCH_CHECK(bench_rate[0][BHI160_NDOF_S_ACCELEROMETER] == 0);
+    // Sleep switches CS back to text encoding.
+    BENCH_CHECK(strcmp(Bench_Request("j/AO/EV"), "j/i/0") == 0);
+
+    return 0;
+}
+
+int main(void)
+{
+    stimer_init_context(&bench_timer_ctx, NULL, Bench_GetTime, 0xFFFFFFFF,
+            30518);
+    CS_Init();
+    CS_RegisterNode(CSN_LP_AO_Create(&bench_timer_ctx));
+
+    if (Bench_RateTest() != 0 || Bench_FusionTest() != 0
+        || Bench_CaptureTest() != 0)
+    {
+        return 1;
+    }
+
+    printf("all checks passed\n");
+
+    return 0;
+}
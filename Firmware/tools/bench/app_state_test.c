@@ -0,0 +1,323 @@
+/**
+ * Host test of the application state machine and motion wake-up.
+ *
+ * Runs App_StateMachine of app.c the way Main_Loop does and checks the state
+ * transitions INIT -> ADVERTISING -> SLEEP when the advertising timeout
+ * expires. With RTE_APP_MOTION_WAKE_ENABLED set, app_motion.c arms the BHI160
+ * significant motion sensor on entering SLEEP and the test fires the sensor
+ * callback to check SLEEP -> START_ADVERTISING -> ADVERTISING, disarming of
+ * the sensor and a failed arm attempt. Without it the device has to stay in
+ * SLEEP and the sensor must not be touched.
+ *
+ * BHI160 driver, BLE and LED functions are replaced by mocks that record the
+ * calls. app.c is included directly to reach its static state machine. Build
+ * and run from the Firmware directory, motion wake-up is disabled by default
+ * in RTE_app_config.h:
+ *
+ *   gcc -O2 -std=gnu99 -D_RTE_ -DAPP_TRACE_DISABLED -DSTIMER_COUNT_MODE=1 \
+ *       -DRTE_APP_MOTION_WAKE_ENABLED=1 -Itools/bench/stubs -Iinclude \
+ *       -Iinclude/bdk -IRTE -o app_state_test tools/bench/app_state_test.c \
+ *       src/device/stimer.c
+ *   ./app_state_test
+ */
+
+#include <stdio.h>
+
+#define main app_main
+#include "../../src/app.c"
+#undef main
+#include "../../src/app_motion.c"
+
+/** Duration of one timer count in ns. */
+#define BENCH_NS_PER_COUNT             (1000000)
+
+#define BENCH_CHECK(cond)                                               \
+    do                                                                  \
+    {                                                                   \
+        if (!(cond))                                                    \
+        {                                                               \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__,     \
+                    #cond);                                             \
+            return 1;                                                   \
+        }                                                               \
+    } while (0)
+
+struct stimer_ctx app_timer_ctx;
+struct sleep_mode_env_tag sleep_mode_env;
+DWT_Type* DWT;
+CoreDebug_Type* CoreDebug;
+
+static uint32_t bench_now_ms;
+
+static bool bench_advertising;
+static int bench_normal_mode_cnt;
+static bool bench_motion_enabled;
+static int bench_callback_install_cnt;
+static int32_t bench_init_result = BHY_SUCCESS;
+static void (*bench_motion_cb)(bhy_data_generic_t*, bhy_virtual_sensor_t);
+
+static uint32_t Bench_GetTime(void* hint)
+{
+    (void) hint;
+
+    return bench_now_ms;
+}
+
+void BDK_BLE_AdvertisingStart(void)
+{
+    bench_advertising = true;
+}
+
+void BDK_BLE_AdvertisingStop(void)
+{
+    bench_advertising = false;
+}
+
+void ledNotif(uint8_t cnt)
+{
+}
+
+void ledNotif2(uint8_t cnt, uint8_t period)
+{
+}
+
+int32_t BHI160_NDOF_Initialize(void)
+{
+    return bench_init_result;
+}
+
+int32_t BHI160_NDOF_AcquireNormalMode(void)
+{
+    bench_normal_mode_cnt += 1;
+    return BHY_SUCCESS;
+}
+
+int32_t BHI160_NDOF_ReleaseNormalMode(void)
+{
+    bench_normal_mode_cnt -= 1;
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_install_sensor_callback(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status,
+        void (*sensor_callback)(bhy_data_generic_t*, bhy_virtual_sensor_t))
+{
+    if (sensor_type == VS_TYPE_SIGNIFICANT_MOTION
+        && wakeup_status == VS_WAKEUP)
+    {
+        bench_motion_cb = sensor_callback;
+        bench_callback_install_cnt += 1;
+    }
+
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_enable_virtual_sensor(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status, uint16_t sample_rate,
+        uint16_t max_report_latency_ms, uint8_t flush_sensor,
+        uint16_t change_sensitivity, uint16_t dynamic_range)
+{
+    if (sensor_type == VS_TYPE_SIGNIFICANT_MOTION
+        && wakeup_status == VS_WAKEUP && sample_rate > 0)
+    {
+        bench_motion_enabled = true;
+    }
+
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_disable_virtual_sensor(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status)
+{
+    if (sensor_type == VS_TYPE_SIGNIFICANT_MOTION
+        && wakeup_status == VS_WAKEUP)
+    {
+        bench_motion_enabled = false;
+    }
+
+    return BHY_SUCCESS;
+}
+
+/* Functions used by Main_Loop and main, which are not run by the test. */
+void Device_Initialize(void)
+{
+}
+
+int CS_PollNodes(void)
+{
+    return 0;
+}
+
+bool CS_IsPollPending(void)
+{
+    return false;
+}
+
+void LedNotif_Poll(void)
+{
+}
+
+void BDK_TaskRunQueued(void)
+{
+}
+
+bool BDK_TaskIsQueueEmpty(void)
+{
+    return true;
+}
+
+void Kernel_Schedule(void)
+{
+}
+
+void Sys_Watchdog_Refresh(void)
+{
+}
+
+int32_t Timer_SetWakeupAtNextEvent(void)
+{
+    return 0;
+}
+
+void HAL_I2C_DeInit(void)
+{
+}
+
+void trace_init(void)
+{
+}
+
+void trace_deinit(void)
+{
+}
+
+void __enable_irq(void)
+{
+}
+
+void __disable_irq(void)
+{
+}
+
+bool BLE_Power_Mode_Enter(struct sleep_mode_env_tag* env, int power_mode)
+{
+    return false;
+}
+
+/** Runs one iteration of the application part of Main_Loop. */
+static void Bench_Step(void)
+{
+    uint32_t events = __atomic_exchange_n(&app_events, 0, __ATOMIC_SEQ_CST);
+
+    if ((events & (APP_EVENT_STATE | APP_EVENT_MOTION)) != 0
+        || (app_state_timer.is_running
+            && stimer_is_expired(&app_state_timer)))
+    {
+        App_StateMachine(events);
+    }
+}
+
+/** Advances time by given number of ms and runs main loop iteration. */
+static void Bench_Wait(uint32_t ms)
+{
+    bench_now_ms += ms;
+    Bench_Step();
+}
+
+/** Fires significant motion sensor as BHI160 FIFO parsing would. */
+static void Bench_Motion(void)
+{
+    bhy_data_generic_t data = { 0 };
+
+    if (bench_motion_cb != NULL && bench_motion_enabled)
+    {
+        bench_motion_cb(&data, VS_WAKEUP);
+    }
+}
+
+int main(void)
+{
+    const uint32_t timeout_ms = RTE_APP_ADV_DISABLE_TIMEOUT * 1000;
+
+    stimer_init_context(&app_timer_ctx, NULL, Bench_GetTime, 0xFFFFFFFF,
+            BENCH_NS_PER_COUNT);
+
+    // INIT -> ADVERTISING
+    Bench_Step();
+    BENCH_CHECK(app_state == APP_STATE_ADVERTISING);
+    BENCH_CHECK(bench_advertising);
+    BENCH_CHECK(App_MotionWakeIsArmed() == false);
+
+    // Motion while advertising is ignored.
+    App_SetEvent(APP_EVENT_MOTION);
+    Bench_Wait(timeout_ms / 2);
+    BENCH_CHECK(app_state == APP_STATE_ADVERTISING);
+    BENCH_CHECK(bench_advertising);
+
+    // ADVERTISING -> SLEEP after advertising timeout.
+    Bench_Wait(timeout_ms / 2);
+    BENCH_CHECK(app_state == APP_STATE_SLEEP);
+    BENCH_CHECK(bench_advertising == false);
+    BENCH_CHECK(app_state_timer.is_running == false);
+
+#if RTE_APP_MOTION_WAKE_ENABLED == 1
+    BENCH_CHECK(App_MotionWakeIsArmed());
+    BENCH_CHECK(bench_motion_enabled);
+    BENCH_CHECK(bench_normal_mode_cnt == 1);
+
+    // Device stays asleep until it is moved.
+    Bench_Wait(10 * timeout_ms);
+    BENCH_CHECK(app_state == APP_STATE_SLEEP);
+    BENCH_CHECK(App_MotionWakeIsArmed());
+
+    // SLEEP -> START_ADVERTISING -> ADVERTISING on motion.
+    Bench_Motion();
+    Bench_Step();
+    BENCH_CHECK(app_state == APP_STATE_START_ADVERTISING);
+    BENCH_CHECK(App_MotionWakeIsArmed() == false);
+    BENCH_CHECK(bench_motion_enabled == false);
+    BENCH_CHECK(bench_normal_mode_cnt == 0);
+    Bench_Step();
+    BENCH_CHECK(app_state == APP_STATE_ADVERTISING);
+    BENCH_CHECK(bench_advertising);
+
+    // Motion of a disarmed sensor does not raise an event.
+    bench_motion_enabled = true;
+    Bench_Motion();
+    bench_motion_enabled = false;
+    BENCH_CHECK(app_events == 0);
+
+    // Sensor is armed again on next timeout, callback is installed once.
+    Bench_Wait(timeout_ms);
+    BENCH_CHECK(app_state == APP_STATE_SLEEP);
+    BENCH_CHECK(App_MotionWakeIsArmed());
+    BENCH_CHECK(bench_callback_install_cnt == 1);
+
+    Bench_Motion();
+    Bench_Step();
+    Bench_Step();
+    BENCH_CHECK(app_state == APP_STATE_ADVERTISING);
+
+    // Device still goes to SLEEP when BHI160 is not available.
+    bench_init_result = BHY_ERROR;
+    Bench_Wait(timeout_ms);
+    BENCH_CHECK(app_state == APP_STATE_SLEEP);
+    BENCH_CHECK(App_MotionWakeIsArmed() == false);
+    BENCH_CHECK(bench_motion_enabled == false);
+    BENCH_CHECK(bench_normal_mode_cnt == 0);
+#else
+    // Without motion wake-up the device stays asleep.
+    Bench_Motion();
+    App_SetEvent(APP_EVENT_STATE);
+    Bench_Wait(10 * timeout_ms);
+    BENCH_CHECK(app_state == APP_STATE_SLEEP);
+    BENCH_CHECK(bench_advertising == false);
+    BENCH_CHECK(bench_callback_install_cnt == 0);
+    BENCH_CHECK(bench_normal_mode_cnt == 0);
+#endif
+
+    printf("motion wake-up %s: all checks passed\n",
+            RTE_APP_MOTION_WAKE_ENABLED ? "enabled" : "disabled");
+
+    return 0;
+}
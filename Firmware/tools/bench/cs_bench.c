@@ -0,0 +1,224 @@
+/**
+ * Host benchmark of CS request parsing and dispatch.
+ *
+ * Compares the single pass parser with hashed node and property lookup used by
+ * CS_ProcessRequest and the node request handlers with the previous approach,
+ * which split the request using strtok and compared the names against every
+ * registered node and every property of the node. Read requests for all AO
+ * properties are measured and both paths are checked to resolve the same node
+ * and property before they are timed.
+ *
+ * CS.c is included directly to reach its static request parser. Build and run
+ * from the Firmware directory:
+ *
+ *   gcc -O2 -std=gnu99 -Iinclude -Iinclude/bdk -IRTE \
+ *       -o cs_bench tools/bench/cs_bench.c src/device/stimer.c
+ *   ./cs_bench
+ */
+
+#include <stdarg.h>
+#include <time.h>
+
+#include "app_led.h"
+#include "../../src/ics/CS.c"
+
+#define BENCH_LOOPS                    (200000)
+
+/** Nodes registered by the firmware. AO is registered last. */
+static const char* const bench_node_name[] = {
+        "EV", "VB", "AL", "AO"
+};
+
+#define BENCH_NODE_CNT \
+        (sizeof(bench_node_name) / sizeof(bench_node_name[0]))
+
+/** Property names of AO node in the order of its property table. */
+static const char* const bench_prop_name[] = {
+        "C", "O", "G", "A", "M", "AR", "H", "P", "R", "GX", "GY", "GZ", "AX",
+        "AY", "AZ", "MX", "MY", "MZ", "ARX", "ARY", "ARZ", "ST", "FO", "FG",
+        "FA", "FM", "FAR", "FU", "EV"
+};
+
+#define BENCH_PROP_CNT \
+        (sizeof(bench_prop_name) / sizeof(bench_prop_name[0]))
+
+static struct CS_Node_Struct bench_node[BENCH_NODE_CNT];
+static struct CS_NameIndex_Struct bench_prop_index;
+static char bench_request[BENCH_PROP_CNT][CS_MAX_RESPONSE_LENGTH];
+
+void ledNotif2(uint8_t cnt, uint8_t period)
+{
+}
+
+int CS_PlatformInit(struct CS_Handle_Struct* handle)
+{
+    return CS_OK;
+}
+
+int CS_PlatformWrite(const char* data, int len)
+{
+    return CS_OK;
+}
+
+uint32_t CS_PlatformTime(void)
+{
+    return 0;
+}
+
+void CS_PlatformLogPrintf(const char* fmt, ...)
+{
+}
+
+void CS_PlatformLogVprintf(const char* fmt, va_list args)
+{
+}
+
+void CS_PlatformLogLock(void)
+{
+}
+
+void CS_PlatformLogUnlock(void)
+{
+}
+
+static int Bench_RequestHandler(const struct CS_Request_Struct* request,
+        char* response)
+{
+    return CS_NO_RESPONSE;
+}
+
+/** Request parsing and dispatch as done before the hashed lookup. */
+static int Bench_StrtokDispatch(char* request, int* prop)
+{
+    struct CS_Request_Struct parsed;
+    int i;
+
+    parsed.token = strtok(request, "/");
+    if (parsed.token == NULL || strlen(parsed.token) != 1
+        || parsed.token[0] < '0' || parsed.token[0] > '~')
+    {
+        return -1;
+    }
+    parsed.node = strtok(NULL, "/");
+    if (parsed.node == NULL)
+    {
+        return -1;
+    }
+    parsed.property = strtok(NULL, "/");
+    if (parsed.property == NULL)
+    {
+        return -1;
+    }
+    parsed.property_value = strtok(NULL, "/");
+
+    for (i = 0; i < cs.node_cnt; ++i)
+    {
+        if (strcmp(parsed.node, cs.node[i]->name) == 0)
+        {
+            break;
+        }
+    }
+    if (i == cs.node_cnt)
+    {
+        return -1;
+    }
+
+    for (*prop = 0; *prop < (int)BENCH_PROP_CNT; ++*prop)
+    {
+        if (strcmp(parsed.property, bench_prop_name[*prop]) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/** Request parsing and dispatch as done by CS_ProcessRequest and nodes. */
+static int Bench_HashDispatch(char* request, int* prop)
+{
+    struct CS_Request_Struct parsed;
+    uint32_t node_hash;
+    int i;
+
+    if (CS_ParseRequest(request, &parsed, &node_hash) != CS_OK)
+    {
+        return -1;
+    }
+
+    i = CS_NameIndexFind(&cs.node_index, parsed.node, node_hash);
+    if (i < 0)
+    {
+        return -1;
+    }
+
+    *prop = CS_NameIndexFind(&bench_prop_index, parsed.property,
+            parsed.property_hash);
+
+    return (*prop < 0) ? -1 : i;
+}
+
+static double Bench_Run(int (*dispatch)(char*, int*))
+{
+    char buffer[CS_MAX_RESPONSE_LENGTH];
+    int prop;
+    clock_t start = clock();
+
+    for (int i = 0; i < BENCH_LOOPS; ++i)
+    {
+        for (unsigned int j = 0; j < BENCH_PROP_CNT; ++j)
+        {
+            strcpy(buffer, bench_request[j]);
+            dispatch(buffer, &prop);
+        }
+    }
+
+    return (double)BENCH_LOOPS * BENCH_PROP_CNT * CLOCKS_PER_SEC
+            / (clock() - start);
+}
+
+int main(void)
+{
+    char buffer[CS_MAX_RESPONSE_LENGTH];
+    int strtok_node, strtok_prop, hash_node, hash_prop;
+
+    CS_Init();
+    for (unsigned int i = 0; i < BENCH_NODE_CNT; ++i)
+    {
+        bench_node[i].name = bench_node_name[i];
+        bench_node[i].request_handler = Bench_RequestHandler;
+        CS_RegisterNode(&bench_node[i]);
+    }
+
+    CS_NameIndexInit(&bench_prop_index);
+    for (unsigned int i = 0; i < BENCH_PROP_CNT; ++i)
+    {
+        if (CS_NameIndexAdd(&bench_prop_index, bench_prop_name[i], i) != CS_OK)
+        {
+            printf("Failed to index property '%s'.\n", bench_prop_name[i]);
+            return 1;
+        }
+        sprintf(bench_request[i], "1/AO/%s", bench_prop_name[i]);
+    }
+
+    for (unsigned int i = 0; i < BENCH_PROP_CNT; ++i)
+    {
+        strcpy(buffer, bench_request[i]);
+        strtok_node = Bench_StrtokDispatch(buffer, &strtok_prop);
+        strcpy(buffer, bench_request[i]);
+        hash_node = Bench_HashDispatch(buffer, &hash_prop);
+
+        if (strtok_node < 0 || strtok_node != hash_node
+            || strtok_prop != (int)i || hash_prop != (int)i)
+        {
+            printf("Dispatch of '%s' differs.\n", bench_request[i]);
+            return 1;
+        }
+    }
+
+    printf("nodes: %d, AO properties: %d\n", cs.node_cnt, (int)BENCH_PROP_CNT);
+    printf("hash:   %10.0f requests/s\n", Bench_Run(Bench_HashDispatch));
+    printf("strtok: %10.0f requests/s\n", Bench_Run(Bench_StrtokDispatch));
+
+    return 0;
+}
@@ -0,0 +1,152 @@
+/**
+ * Host benchmark of the Q15 FFT used by VB node.
+ *
+ * Checks FFT_Q15_Transform against a double precision DFT of the same input
+ * divided by the transform size for all supported sizes, then reports the cost
+ * of 256 and 512 point transforms in CPU cycles on x86 and in ns elsewhere.
+ *
+ * Build and run from the Firmware directory:
+ *
+ *   gcc -O2 -std=gnu99 -Iinclude -o fft_bench tools/bench/fft_bench.c \
+ *       src/fft_q15.c -lm
+ *   ./fft_bench
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "fft_q15.h"
+
+#define BENCH_LOOPS                    (20000)
+
+/** Largest allowed difference from the reference DFT in Q15 LSB. */
+#define BENCH_MAX_ERROR                (3.0)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_CYCLE_UNIT               "cycles"
+#else
+#define BENCH_CYCLE_UNIT               "ns"
+#endif
+
+static struct FFT_Q15_Complex bench_input[FFT_Q15_MAX_SIZE];
+static struct FFT_Q15_Complex bench_output[FFT_Q15_MAX_SIZE];
+
+static uint64_t Bench_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+#endif
+}
+
+/** Fills input with a Hann windowed two tone signal plus noise, like the
+ * acceleration frames analyzed by VB node, or with full scale complex noise. */
+static void Bench_FillInput(uint32_t size, int complex_noise)
+{
+    for (uint32_t n = 0; n < size; ++n)
+    {
+        if (complex_noise)
+        {
+            // Keeps magnitude of each value below 32767.
+            bench_input[n].re = rand() % 46341 - 23170;
+            bench_input[n].im = rand() % 46341 - 23170;
+        }
+        else
+        {
+            double x = 20000.0 * sin(2.0 * M_PI * 3 * n / size)
+                    + 8000.0 * sin(2.0 * M_PI * (size / 5) * n / size)
+                    + rand() % 4001 - 2000;
+            bench_input[n].re = (int16_t)(x * FFT_Q15_Hann(n, size) / 32768);
+            bench_input[n].im = 0;
+        }
+    }
+}
+
+/** Returns largest difference of real or imaginary part from reference DFT
+ * scaled by 1 / size. */
+static double Bench_Error(uint32_t size)
+{
+    double max_error = 0;
+
+    memcpy(bench_output, bench_input, size * sizeof(bench_input[0]));
+    if (FFT_Q15_Transform(bench_output, size) != 0)
+    {
+        return INFINITY;
+    }
+
+    for (uint32_t k = 0; k < size; ++k)
+    {
+        double re = 0;
+        double im = 0;
+
+        for (uint32_t n = 0; n < size; ++n)
+        {
+            double phi = -2.0 * M_PI * (double)((k * n) % size) / size;
+            re += bench_input[n].re * cos(phi) - bench_input[n].im * sin(phi);
+            im += bench_input[n].re * sin(phi) + bench_input[n].im * cos(phi);
+        }
+
+        max_error = fmax(max_error, fabs(re / size - bench_output[k].re));
+        max_error = fmax(max_error, fabs(im / size - bench_output[k].im));
+    }
+
+    return max_error;
+}
+
+static double Bench_Run(uint32_t size)
+{
+    uint64_t start;
+    uint64_t total = 0;
+
+    Bench_FillInput(size, 0);
+    for (int i = 0; i < BENCH_LOOPS; ++i)
+    {
+        memcpy(bench_output, bench_input, size * sizeof(bench_input[0]));
+        start = Bench_Cycles();
+        FFT_Q15_Transform(bench_output, size);
+        total += Bench_Cycles() - start;
+    }
+
+    return (double)total / BENCH_LOOPS;
+}
+
+int main(void)
+{
+    int failed = 0;
+
+    srand(1);
+    for (uint32_t size = 4; size <= FFT_Q15_MAX_SIZE; size *= 2)
+    {
+        double error = 0;
+
+        for (int complex_noise = 0; complex_noise < 2; ++complex_noise)
+        {
+            Bench_FillInput(size, complex_noise);
+            error = fmax(error, Bench_Error(size));
+        }
+
+        printf("size %3u: max error %.2f LSB%s\n", size, error,
+                (error > BENCH_MAX_ERROR) ? " FAILED" : "");
+        failed |= (error > BENCH_MAX_ERROR);
+    }
+
+    if (failed)
+    {
+        return 1;
+    }
+
+    printf("256 point: %8.0f " BENCH_CYCLE_UNIT "/transform\n", Bench_Run(256));
+    printf("512 point: %8.0f " BENCH_CYCLE_UNIT "/transform\n", Bench_Run(512));
+
+    return 0;
+}
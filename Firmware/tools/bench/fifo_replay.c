@@ -0,0 +1,467 @@
+/**
+ * Host replay benchmark of BHI160 FIFO parsing.
+ *
+ * Feeds a FIFO dump through the interrupt, drain and parse path of
+ * BHI160_NDOF.c and reports the number of FIFO bytes handled per second.
+ * The dump is replayed in packet aligned transfers of 50 to 450 bytes, the
+ * amount BHI160 reports after each interrupt, which makes transfers wrap the
+ * 300 byte ring buffer and split packets between reads.
+ *
+ * bhy_read_fifo and bhy_parse_next_fifo_packet are replaced by mocks that
+ * serve the dump and split it into packets using the BHY1 packet lengths.
+ * Every parsed packet is hashed in order and compared with the packets of the
+ * dump, so a lost, duplicated or reordered packet fails the replay. The
+ * reported rate covers the ring buffer handling and the packet walk but no
+ * I2C transfers.
+ *
+ * Without an argument a dump of wake-up accelerometer, gyroscope,
+ * magnetometer and orientation samples with timestamps and meta events is
+ * generated. A raw FIFO dump captured from the device can be given instead.
+ *
+ * BHI160_NDOF.c is included directly to reach its static FIFO routines. Build
+ * and run from the Firmware directory, PinNames.h leaves the BHI160 interrupt
+ * pin unconnected:
+ *
+ *   gcc -O2 -std=gnu99 -D_RTE_ -Wno-shift-count-negative \
+ *       -Itools/bench/stubs -Iinclude -Iinclude/bdk -IRTE \
+ *       -o fifo_replay tools/bench/fifo_replay.c
+ *   ./fifo_replay [dump file]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../../src/bsp/BHI160_NDOF.c"
+
+#define BENCH_DUMP_SIZE                (64 * 1024)
+#define BENCH_LOOPS                    (200)
+
+#define BENCH_MIN_TRANSFER             (50)
+#define BENCH_MAX_TRANSFER             (450)
+
+/** Packet ids of the BHY1 FIFO that are not virtual sensors. */
+#define BENCH_ID_PADDING               (0x00)
+#define BENCH_ID_DEBUG                 (0xF5)
+#define BENCH_ID_TIMESTAMP_LSW_WAKEUP  (0xF6)
+#define BENCH_ID_TIMESTAMP_MSW_WAKEUP  (0xF7)
+#define BENCH_ID_META_EVENT_WAKEUP     (0xF8)
+#define BENCH_ID_TIMESTAMP_LSW         (0xFC)
+#define BENCH_ID_TIMESTAMP_MSW         (0xFD)
+#define BENCH_ID_META_EVENT            (0xFE)
+
+static uint8_t* bench_dump;
+static uint32_t bench_dump_len;
+
+/** Offsets of packet aligned transfer boundaries in the dump. */
+static uint32_t* bench_transfer;
+static uint32_t bench_transfer_cnt;
+
+/** Read position in the dump and end of the current transfer. */
+static uint32_t bench_rd;
+static uint32_t bench_transfer_end;
+
+static uint64_t bench_hash;
+static uint32_t bench_packet_cnt;
+
+static BDK_TaskCallback bench_task;
+
+const uint8_t bhy1_fw[1];
+DIO_Type* DIO;
+
+/** Returns length of a BHY1 FIFO packet with given id or 0 if unknown. */
+static uint16_t Bench_PacketLength(uint8_t id)
+{
+    switch (id)
+    {
+    case BENCH_ID_PADDING:
+        return 1;
+    case BENCH_ID_TIMESTAMP_LSW_WAKEUP:
+    case BENCH_ID_TIMESTAMP_MSW_WAKEUP:
+    case BENCH_ID_TIMESTAMP_LSW:
+    case BENCH_ID_TIMESTAMP_MSW:
+        return 3;
+    case BENCH_ID_META_EVENT_WAKEUP:
+    case BENCH_ID_META_EVENT:
+        return 4;
+    case BENCH_ID_DEBUG:
+        return 14;
+    }
+
+    switch (id & ~VS_WAKEUP)
+    {
+    case VS_TYPE_ACCELEROMETER:
+    case VS_TYPE_GEOMAGNETIC_FIELD:
+    case VS_TYPE_ORIENTATION:
+    case VS_TYPE_GYROSCOPE:
+    case VS_TYPE_GRAVITY:
+    case VS_TYPE_LINEAR_ACCELERATION:
+        return 8;
+    case VS_TYPE_SIGNIFICANT_MOTION:
+        return 2;
+    case 11: // Rotation vector
+    case 15: // Game rotation vector
+    case 20: // Geomagnetic rotation vector
+        return 11;
+    case 16: // Uncalibrated magnetometer
+    case 18: // Uncalibrated gyroscope
+        return 14;
+    }
+
+    return 0;
+}
+
+static uint64_t Bench_Hash(uint64_t hash, const uint8_t* data, uint16_t len)
+{
+    for (uint16_t i = 0; i < len; ++i)
+    {
+        hash = (hash ^ data[i]) * 0x100000001B3ULL;
+    }
+
+    return hash;
+}
+
+static void Bench_Put(uint32_t* len, uint8_t id, uint32_t seq)
+{
+    uint16_t packet_len = Bench_PacketLength(id);
+
+    bench_dump[*len] = id;
+    for (uint16_t i = 1; i < packet_len; ++i)
+    {
+        bench_dump[*len + i] = (uint8_t)(seq >> (8 * ((i - 1) % 4)));
+    }
+    *len += packet_len;
+}
+
+/** Generates a dump of 100 Hz wake-up sensor samples. Sample values hold a
+ * sequence number so that neighboring packets differ. */
+static void Bench_GenerateDump(void)
+{
+    uint32_t seq = 0;
+
+    bench_dump = malloc(BENCH_DUMP_SIZE);
+    bench_dump_len = 0;
+    while (bench_dump_len + 4 * 8 + 2 * 3 + 4 <= BENCH_DUMP_SIZE)
+    {
+        Bench_Put(&bench_dump_len, BENCH_ID_TIMESTAMP_LSW_WAKEUP, seq);
+        Bench_Put(&bench_dump_len, VS_ID_ACCELEROMETER_WAKEUP, seq);
+        Bench_Put(&bench_dump_len, VS_ID_GYROSCOPE_WAKEUP, seq);
+        Bench_Put(&bench_dump_len, VS_ID_MAGNETOMETER_WAKEUP, seq);
+        Bench_Put(&bench_dump_len, VS_ID_ORIENTATION_WAKEUP, seq);
+        if (seq % 100 == 0)
+        {
+            Bench_Put(&bench_dump_len, BENCH_ID_TIMESTAMP_MSW_WAKEUP, seq);
+        }
+        if (seq % 1000 == 0)
+        {
+            Bench_Put(&bench_dump_len, BENCH_ID_META_EVENT_WAKEUP, seq);
+        }
+        seq += 1;
+    }
+}
+
+static int Bench_LoadDump(const char* path)
+{
+    FILE* f = fopen(path, "rb");
+    long size;
+
+    if (f == NULL || fseek(f, 0, SEEK_END) != 0 || (size = ftell(f)) <= 0)
+    {
+        return -1;
+    }
+    rewind(f);
+
+    bench_dump = malloc(size);
+    bench_dump_len = fread(bench_dump, 1, size, f);
+    fclose(f);
+
+    return (bench_dump_len == (uint32_t)size) ? 0 : -1;
+}
+
+/** Splits the dump into packet aligned transfers and computes the hash of its
+ * packets. Returns number of packets or -1 if an unknown packet is found. */
+static int Bench_SplitDump(uint64_t* hash)
+{
+    uint32_t pos = 0;
+    uint32_t start = 0;
+    uint32_t size = BENCH_MIN_TRANSFER;
+    int packet_cnt = 0;
+
+    bench_transfer = malloc((bench_dump_len + 1) * sizeof(uint32_t));
+    bench_transfer_cnt = 0;
+    *hash = 0xCBF29CE484222325ULL;
+
+    srand(1);
+    while (pos < bench_dump_len)
+    {
+        uint16_t len = Bench_PacketLength(bench_dump[pos]);
+
+        if (len == 0 || pos + len > bench_dump_len)
+        {
+            printf("Unknown packet 0x%02X at offset %u.\n", bench_dump[pos],
+                    pos);
+            return -1;
+        }
+
+        if (pos + len - start > size)
+        {
+            bench_transfer[bench_transfer_cnt++] = pos;
+            start = pos;
+            size = BENCH_MIN_TRANSFER
+                    + rand() % (BENCH_MAX_TRANSFER - BENCH_MIN_TRANSFER + 1);
+        }
+
+        *hash = Bench_Hash(*hash, bench_dump + pos, len);
+        pos += len;
+        packet_cnt += 1;
+    }
+    bench_transfer[bench_transfer_cnt++] = bench_dump_len;
+
+    return packet_cnt;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_read_fifo(uint8_t* buffer, uint16_t buffer_size,
+        uint16_t* bytes_read, uint16_t* bytes_left)
+{
+    uint32_t len = bench_transfer_end - bench_rd;
+
+    if (len > buffer_size)
+    {
+        len = buffer_size;
+    }
+
+    memcpy(buffer, bench_dump + bench_rd, len);
+    bench_rd += len;
+    *bytes_read = len;
+    *bytes_left = bench_transfer_end - bench_rd;
+
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_parse_next_fifo_packet(uint8_t** fifo_buffer,
+        uint16_t* fifo_buffer_length, bhy_data_generic_t* fifo_data_output,
+        bhy_data_type_t* fifo_data_type)
+{
+    uint8_t* packet = *fifo_buffer;
+    uint16_t len = Bench_PacketLength(packet[0]);
+
+    if (*fifo_buffer_length == 0)
+    {
+        return BHY_OUT_OF_RANGE;
+    }
+    if (len == 0)
+    {
+        return BHY_ERROR;
+    }
+    if (len > *fifo_buffer_length)
+    {
+        return BHY_OUT_OF_RANGE;
+    }
+
+    if (len == 8)
+    {
+        *fifo_data_type = BHY_DATA_TYPE_VECTOR;
+        fifo_data_output->data_vector.x = (int16_t)(packet[1] | packet[2] << 8);
+        fifo_data_output->data_vector.y = (int16_t)(packet[3] | packet[4] << 8);
+        fifo_data_output->data_vector.z = (int16_t)(packet[5] | packet[6] << 8);
+        fifo_data_output->data_vector.status = packet[7];
+    }
+    else
+    {
+        *fifo_data_type = BHY_DATA_TYPE_PADDING;
+    }
+
+    bench_hash = Bench_Hash(bench_hash, packet, len);
+    bench_packet_cnt += 1;
+
+    *fifo_buffer += len;
+    *fifo_buffer_length -= len;
+
+    return BHY_SUCCESS;
+}
+
+void BDK_TaskSchedule(BDK_TaskCallback cb, void* arg)
+{
+    bench_task = cb;
+}
+
+void EventCallback_Call(uint16_t event_id)
+{
+}
+
+void HAL_Failed(const char* file, int line, const char* expr)
+{
+    abort();
+}
+
+void NVIC_EnableIRQ(IRQn_Type irq)
+{
+}
+
+void NVIC_DisableIRQ(IRQn_Type irq)
+{
+}
+
+void NVIC_ClearPendingIRQ(IRQn_Type irq)
+{
+}
+
+void Sys_DIO_Config(uint32_t pad, uint32_t cfg)
+{
+}
+
+void Sys_DIO_IntConfig(uint32_t index, uint32_t cfg, uint32_t dbnc_clk,
+        uint32_t dbnc_cnt)
+{
+}
+
+void bhy_print_debug_packet(bhy_data_debug_t* packet,
+        void (*debug_print_ptr)(const uint8_t*))
+{
+}
+
+void bhy_printf(const uint8_t* string)
+{
+}
+
+void bhy_update_system_timestamp(bhy_data_scalar_u16_t* new_timestamp,
+        uint32_t* system_timestamp)
+{
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_driver_init(const uint8_t* bhy_fw_data)
+{
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_mapping_matrix_set(uint8_t index,
+        int8_t* mapping_matrix)
+{
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_install_sensor_callback(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status,
+        void (*sensor_callback)(bhy_data_generic_t*, bhy_virtual_sensor_t))
+{
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_install_timestamp_callback(
+        bhy_virtual_sensor_t wakeup_status,
+        void (*timestamp_callback)(bhy_data_scalar_u16_t*))
+{
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_install_meta_event_callback(
+        bhy_meta_event_type_t meta_event_id,
+        void (*meta_event_callback)(bhy_data_meta_event_t*,
+                bhy_meta_event_type_t))
+{
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_enable_virtual_sensor(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status, uint16_t sample_rate,
+        uint16_t max_report_latency_ms, uint8_t flush_sensor,
+        uint16_t change_sensitivity, uint16_t dynamic_range)
+{
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_get_physical_sensor_status(
+        struct accel_physical_status_t* accel_status,
+        struct gyro_physical_status_t* gyro_status,
+        struct mag_physical_status_t* mag_status)
+{
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_set_host_interface_control(uint8_t param,
+        uint8_t value)
+{
+    return BHY_SUCCESS;
+}
+
+BHY_RETURN_FUNCTION_TYPE bhy_set_fifo_water_mark(
+        bhy_fifo_buffer_type_t buffer_type, uint16_t water_mark)
+{
+    return BHY_SUCCESS;
+}
+
+/** Replays whole dump, one interrupt per transfer. */
+static void Bench_Replay(void)
+{
+    bench_rd = 0;
+    bench_hash = 0xCBF29CE484222325ULL;
+    bench_packet_cnt = 0;
+
+    for (uint32_t i = 0; i < bench_transfer_cnt; ++i)
+    {
+        bench_transfer_end = bench_transfer[i];
+
+        BHI160_NDOF_ISR();
+        while (bench_task != NULL)
+        {
+            BDK_TaskCallback cb = bench_task;
+
+            bench_task = NULL;
+            cb(NULL);
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const struct BHI160_NDOF_FifoStats* stats = BHI160_NDOF_GetFifoStats();
+    uint64_t dump_hash;
+    int packet_cnt;
+    clock_t start;
+
+    if (argc > 1)
+    {
+        if (Bench_LoadDump(argv[1]) != 0)
+        {
+            printf("Failed to read dump '%s'.\n", argv[1]);
+            return 1;
+        }
+    }
+    else
+    {
+        Bench_GenerateDump();
+    }
+
+    packet_cnt = Bench_SplitDump(&dump_hash);
+    if (packet_cnt < 0)
+    {
+        return 1;
+    }
+
+    Bench_Replay();
+    if (bench_rd != bench_dump_len || bench_hash != dump_hash
+        || bench_packet_cnt != (uint32_t)packet_cnt || bhi160_fifo_len != 0)
+    {
+        printf("Replay parsed %u of %d packets, %u of %u bytes read, "
+                "%u bytes left in buffer, order %s.\n",
+                bench_packet_cnt, packet_cnt, bench_rd, bench_dump_len,
+                bhi160_fifo_len,
+                (bench_hash == dump_hash) ? "kept" : "broken");
+        return 1;
+    }
+
+    printf("dump: %u bytes, %d packets, %u transfers\n", bench_dump_len,
+            packet_cnt, bench_transfer_cnt);
+    printf("drains: %u, bytes: %u\n", stats->drain_cnt, stats->byte_cnt);
+
+    start = clock();
+    for (int i = 0; i < BENCH_LOOPS; ++i)
+    {
+        Bench_Replay();
+    }
+    printf("replay: %10.0f bytes/s\n",
+            (double)BENCH_LOOPS * bench_dump_len * CLOCKS_PER_SEC
+            / (clock() - start));
+
+    return 0;
+}
@@ -0,0 +1,448 @@
+/**
+ * Host benchmark of the Q30 orientation filter used by AO node.
+ *
+ * Generates a synthetic trace of a device rotating with varying angular rate
+ * around all axes, starting from rest in a tilted orientation. Accelerometer,
+ * magnetometer and gyroscope samples are quantized like BHI160 raw data with
+ * noise and gyroscope bias added. The trace is fed to Fusion_Q_Update and to a
+ * double precision implementation of the same filter, and the resulting Euler
+ * angles are compared with the ground truth after the first 10 s.
+ *
+ * Alignment from the first sample is checked over random orientations and the
+ * speed of Fusion_Q_Update and Fusion_Q_GetEuler is measured on the trace.
+ *
+ * Build and run from the Firmware directory:
+ *
+ *   gcc -O2 -std=gnu99 -Iinclude -o fusion_bench tools/bench/fusion_bench.c \
+ *       src/fusion_q.c -lm
+ *   ./fusion_bench [update rate in Hz]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "fusion_q.h"
+
+/** Length of the synthetic trace in seconds. */
+#define BENCH_DURATION                 (120)
+
+/** Largest supported update rate in Hz. */
+#define BENCH_MAX_RATE                 (400)
+
+#define BENCH_MAX_SAMPLES              (BENCH_DURATION * BENCH_MAX_RATE)
+
+/** Time after which the estimate is compared with ground truth in s. */
+#define BENCH_SETTLE_TIME              (10.0)
+
+/** Proportional gain used by AO node. */
+#define BENCH_KP                       (0.5)
+
+/** Gyroscope dynamic range in dps and its raw to rad/s Q16 factor in Q24
+ * as used by AO node. */
+#define BENCH_GYRO_RANGE               (2000)
+#define BENCH_SCALE_GYRO_RAD           (585635)
+
+/** Raw accelerometer value of 1 g and raw magnetometer field magnitude. */
+#define BENCH_ACCEL_1G                 (8192)
+#define BENCH_MAG_FIELD                (800)
+
+/** Number of orientations used to check alignment. */
+#define BENCH_ALIGN_CNT                (100000)
+
+/** Samples of the synthetic trace in the format passed by AO node. */
+struct Bench_Sample_Struct
+{
+    int32_t gyro[3];
+    int16_t accel[3];
+    int16_t mag[3];
+
+    /** Values of the quantized samples in SI units for the reference. */
+    double gyro_rad[3];
+    double accel_f[3];
+    double mag_f[3];
+
+    /** Ground truth orientation. */
+    double truth[4];
+};
+
+static struct Bench_Sample_Struct bench_trace[BENCH_MAX_SAMPLES];
+
+/** Earth frame vectors: x points north, z up. Field inclination is 60 deg. */
+static const double bench_up[3] = { 0, 0, 1 };
+static const double bench_field[3] = { 0.4975710, 0, -0.8674232 };
+
+/** Standard normal random number. */
+static double Bench_Gauss(void)
+{
+    double u = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double v = (rand() + 1.0) / (RAND_MAX + 2.0);
+
+    return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+static void Bench_QuatMultiply(const double* a, const double* b, double* out)
+{
+    out[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    out[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    out[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    out[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+static void Bench_QuatNormalize(double* q)
+{
+    double n = sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        q[i] /= n;
+    }
+}
+
+/** Rotates earth frame vector into sensor frame of orientation q. */
+static void Bench_ToSensor(const double* q, const double* v, double* out)
+{
+    double w = q[0], x = q[1], y = q[2], z = q[3];
+    double r[3][3] = {
+        { 1 - 2 * (y * y + z * z), 2 * (x * y - w * z), 2 * (x * z + w * y) },
+        { 2 * (x * y + w * z), 1 - 2 * (x * x + z * z), 2 * (y * z - w * x) },
+        { 2 * (x * z - w * y), 2 * (y * z + w * x), 1 - 2 * (x * x + y * y) }
+    };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        out[i] = r[0][i] * v[0] + r[1][i] * v[1] + r[2][i] * v[2];
+    }
+}
+
+/** Euler angles in degrees in the convention of Fusion_Q_GetEuler. */
+static void Bench_Euler(const double* q, double* euler)
+{
+    double w = q[0], x = q[1], y = q[2], z = q[3];
+
+    euler[0] = atan2(-(1 - 2 * (x * x + z * z)), 2 * (x * y - w * z))
+            * 180 / M_PI;
+    if (euler[0] < 0)
+    {
+        euler[0] += 360;
+    }
+    euler[1] = atan2(-2 * (y * z + w * x), 1 - 2 * (x * x + y * y))
+            * 180 / M_PI;
+    euler[2] = asin(2 * (x * z - w * y)) * 180 / M_PI;
+}
+
+static double Bench_AngleDiff(double a, double b)
+{
+    return fabs(fmod(a - b + 540.0, 360.0) - 180.0);
+}
+
+/** Double precision Mahony filter update with the same structure and gains
+ * as Fusion_Q_Update without integral feedback. */
+static void Bench_ReferenceUpdate(double* q, const double* gyro,
+        const double* accel, const double* mag, double dt)
+{
+    double q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    double an = sqrt(accel[0] * accel[0] + accel[1] * accel[1]
+            + accel[2] * accel[2]);
+    double mn = sqrt(mag[0] * mag[0] + mag[1] * mag[1] + mag[2] * mag[2]);
+    double ax = accel[0] / an, ay = accel[1] / an, az = accel[2] / an;
+    double mx = mag[0] / mn, my = mag[1] / mn, mz = mag[2] / mn;
+    double q0q0 = q0 * q0, q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+    double q1q1 = q1 * q1, q1q2 = q1 * q2, q1q3 = q1 * q3;
+    double q2q2 = q2 * q2, q2q3 = q2 * q3, q3q3 = q3 * q3;
+    double g[3];
+
+    // Reference direction of magnetic field in earth frame.
+    double hx = 2 * (mx * (0.5 - q2q2 - q3q3) + my * (q1q2 - q0q3)
+            + mz * (q1q3 + q0q2));
+    double hy = 2 * (mx * (q1q2 + q0q3) + my * (0.5 - q1q1 - q3q3)
+            + mz * (q2q3 - q0q1));
+    double bx = sqrt(hx * hx + hy * hy);
+    double bz = 2 * (mx * (q1q3 - q0q2) + my * (q2q3 + q0q1)
+            + mz * (0.5 - q1q1 - q2q2));
+
+    // Estimated direction of gravity and magnetic field.
+    double vx = q1q3 - q0q2, vy = q0q1 + q2q3, vz = q0q0 - 0.5 + q3q3;
+    double wx = bx * (0.5 - q2q2 - q3q3) + bz * (q1q3 - q0q2);
+    double wy = bx * (q1q2 - q0q3) + bz * (q0q1 + q2q3);
+    double wz = bx * (q0q2 + q1q3) + bz * (0.5 - q1q1 - q2q2);
+
+    double e[3] = {
+        (ay * vz - az * vy) + (my * wz - mz * wy),
+        (az * vx - ax * vz) + (mz * wx - mx * wz),
+        (ax * vy - ay * vx) + (mx * wy - my * wx)
+    };
+
+    for (int i = 0; i < 3; ++i)
+    {
+        g[i] = (gyro[i] + 2 * BENCH_KP * e[i]) * 0.5 * dt;
+    }
+
+    q[0] = q0 - q1 * g[0] - q2 * g[1] - q3 * g[2];
+    q[1] = q1 + q0 * g[0] + q2 * g[2] - q3 * g[1];
+    q[2] = q2 + q0 * g[1] - q1 * g[2] + q3 * g[0];
+    q[3] = q3 + q0 * g[2] + q1 * g[1] - q2 * g[0];
+    Bench_QuatNormalize(q);
+}
+
+/** Quantizes earth frame gravity and magnetic field seen in orientation q. */
+static void Bench_SampleVectors(const double* q, struct Bench_Sample_Struct* s,
+        double accel_noise, double mag_noise)
+{
+    double a[3], m[3];
+
+    Bench_ToSensor(q, bench_up, a);
+    Bench_ToSensor(q, bench_field, m);
+    for (int i = 0; i < 3; ++i)
+    {
+        s->accel[i] = (int16_t)lrint(a[i] * BENCH_ACCEL_1G
+                + Bench_Gauss() * accel_noise);
+        s->mag[i] = (int16_t)lrint(m[i] * BENCH_MAG_FIELD
+                + Bench_Gauss() * mag_noise);
+        s->accel_f[i] = s->accel[i];
+        s->mag_f[i] = s->mag[i];
+    }
+}
+
+/** Fills trace with samples and returns their count. */
+static int Bench_GenerateTrace(double rate)
+{
+    const double bias[3] = { 0.002, -0.003, 0.001 };
+    const int sample_cnt = (int)(BENCH_DURATION * rate);
+    const double dt = 1.0 / rate;
+    double q[4] = { cos(0.4), sin(0.4) * 0.6, sin(0.4) * 0.8, 0 };
+
+    for (int k = 0; k < sample_cnt; ++k)
+    {
+        struct Bench_Sample_Struct* s = &bench_trace[k];
+        double t = k * dt;
+        double w[3] = {
+            1.2 * sin(0.7 * t), 0.9 * cos(0.5 * t), 1.5 * sin(0.3 * t + 1)
+        };
+
+        if (t < 5)
+        {
+            w[0] = w[1] = w[2] = 0;
+        }
+
+        // Integrate ground truth in 10 sub-steps.
+        for (int i = 0; i < 10; ++i)
+        {
+            double h = dt / 20;
+            double dq[4] = { 1, w[0] * h, w[1] * h, w[2] * h };
+            double next[4];
+
+            Bench_QuatMultiply(q, dq, next);
+            Bench_QuatNormalize(next);
+            for (int j = 0; j < 4; ++j)
+            {
+                q[j] = next[j];
+            }
+        }
+
+        Bench_SampleVectors(q, s, 30, 8);
+        for (int i = 0; i < 4; ++i)
+        {
+            s->truth[i] = q[i];
+        }
+
+        // Raw gyroscope value converted like CSN_AO_FusionUpdate does.
+        for (int i = 0; i < 3; ++i)
+        {
+            double rate_dps = (w[i] + bias[i] + Bench_Gauss() * 0.005)
+                    * 180 / M_PI;
+            int16_t raw = (int16_t)lrint(rate_dps * 32768 / BENCH_GYRO_RANGE);
+
+            s->gyro[i] = (int32_t)(((int64_t)raw * BENCH_GYRO_RANGE
+                    * BENCH_SCALE_GYRO_RAD) >> 24);
+            s->gyro_rad[i] = raw * (double)BENCH_GYRO_RANGE / 32768
+                    * M_PI / 180;
+        }
+    }
+
+    return sample_cnt;
+}
+
+/** Runs fixed point and reference filter over the trace and prints errors. */
+static void Bench_Accuracy(int sample_cnt, double rate)
+{
+    const uint32_t dt_q32 = (uint32_t)llrint(4294967296.0 / rate);
+    struct Fusion_Q_State state;
+    double ref[4];
+    double fixed_sum[3] = { 0 }, fixed_max[3] = { 0 };
+    double ref_sum[3] = { 0 }, ref_max[3] = { 0 };
+    double diff_max[3] = { 0 };
+    int compared_cnt = 0;
+
+    Fusion_Q_Init(&state, (int32_t)(BENCH_KP * 65536), 0);
+
+    for (int k = 0; k < sample_cnt; ++k)
+    {
+        const struct Bench_Sample_Struct* s = &bench_trace[k];
+        int32_t euler_q[3];
+        double fixed[3], truth[3], euler_ref[3];
+
+        Fusion_Q_Update(&state, s->gyro, s->accel, s->mag, dt_q32);
+
+        // Reference starts from the same aligned estimate.
+        if (k == 0)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                ref[i] = state.q[i] / (double)FUSION_Q_ONE;
+            }
+            continue;
+        }
+        Bench_ReferenceUpdate(ref, s->gyro_rad, s->accel_f, s->mag_f,
+                1.0 / rate);
+
+        Bench_Euler(s->truth, truth);
+
+        // Heading and pitch are not defined close to roll of +-90 deg.
+        if (k * (1.0 / rate) < BENCH_SETTLE_TIME || fabs(truth[2]) > 80)
+        {
+            continue;
+        }
+
+        Fusion_Q_GetEuler(&state, euler_q);
+        Bench_Euler(ref, euler_ref);
+        for (int i = 0; i < 3; ++i)
+        {
+            double d;
+
+            fixed[i] = euler_q[i] / 100.0;
+
+            d = Bench_AngleDiff(fixed[i], truth[i]);
+            fixed_sum[i] += d;
+            fixed_max[i] = fmax(fixed_max[i], d);
+
+            d = Bench_AngleDiff(euler_ref[i], truth[i]);
+            ref_sum[i] += d;
+            ref_max[i] = fmax(ref_max[i], d);
+
+            diff_max[i] = fmax(diff_max[i],
+                    Bench_AngleDiff(fixed[i], euler_ref[i]));
+        }
+        compared_cnt += 1;
+    }
+
+    printf("rate %.0f Hz, %d of %d samples compared\n", rate, compared_cnt,
+            sample_cnt);
+    printf("fixed vs truth:  mean H %.3f P %.3f R %.3f, "
+            "max %.3f %.3f %.3f deg\n",
+            fixed_sum[0] / compared_cnt, fixed_sum[1] / compared_cnt,
+            fixed_sum[2] / compared_cnt,
+            fixed_max[0], fixed_max[1], fixed_max[2]);
+    printf("double vs truth: mean H %.3f P %.3f R %.3f, "
+            "max %.3f %.3f %.3f deg\n",
+            ref_sum[0] / compared_cnt, ref_sum[1] / compared_cnt,
+            ref_sum[2] / compared_cnt, ref_max[0], ref_max[1], ref_max[2]);
+    printf("fixed vs double: max H %.4f P %.4f R %.4f deg\n",
+            diff_max[0], diff_max[1], diff_max[2]);
+}
+
+/** Checks the estimate set from the first sample in random orientations. */
+static void Bench_Alignment(void)
+{
+    const int32_t gyro[3] = { 0, 0, 0 };
+    double max_error[3] = { 0 };
+    int checked_cnt = 0;
+
+    for (int k = 0; k < BENCH_ALIGN_CNT; ++k)
+    {
+        struct Bench_Sample_Struct s;
+        struct Fusion_Q_State state;
+        double q[4], truth[3];
+        int32_t euler_q[3];
+
+        for (int i = 0; i < 4; ++i)
+        {
+            q[i] = Bench_Gauss();
+        }
+        Bench_QuatNormalize(q);
+        Bench_Euler(q, truth);
+        if (fabs(truth[2]) > 85)
+        {
+            continue;
+        }
+
+        Bench_SampleVectors(q, &s, 0, 0);
+        Fusion_Q_Init(&state, (int32_t)(BENCH_KP * 65536), 0);
+        Fusion_Q_Update(&state, gyro, s.accel, s.mag, 0);
+        Fusion_Q_GetEuler(&state, euler_q);
+
+        for (int i = 0; i < 3; ++i)
+        {
+            max_error[i] = fmax(max_error[i],
+                    Bench_AngleDiff(euler_q[i] / 100.0, truth[i]));
+        }
+        checked_cnt += 1;
+    }
+
+    printf("alignment over %d orientations: max H %.3f P %.3f R %.3f deg\n",
+            checked_cnt, max_error[0], max_error[1], max_error[2]);
+}
+
+static double Bench_Seconds(void)
+{
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static void Bench_Speed(int sample_cnt, double rate)
+{
+    const uint32_t dt_q32 = (uint32_t)llrint(4294967296.0 / rate);
+    const int repeat_cnt = 200;
+    struct Fusion_Q_State state;
+    volatile int32_t sink = 0;
+    int32_t euler_q[3];
+    double start, elapsed;
+
+    Fusion_Q_Init(&state, (int32_t)(BENCH_KP * 65536), 0);
+
+    start = Bench_Seconds();
+    for (int r = 0; r < repeat_cnt; ++r)
+    {
+        for (int k = 0; k < sample_cnt; ++k)
+        {
+            Fusion_Q_Update(&state, bench_trace[k].gyro, bench_trace[k].accel,
+                    bench_trace[k].mag, dt_q32);
+        }
+    }
+    elapsed = Bench_Seconds() - start;
+    printf("Fusion_Q_Update:   %.2f M updates/s (%.0f ns/update)\n",
+            (double)repeat_cnt * sample_cnt / elapsed / 1e6,
+            elapsed / ((double)repeat_cnt * sample_cnt) * 1e9);
+
+    start = Bench_Seconds();
+    for (int r = 0; r < 1000000; ++r)
+    {
+        Fusion_Q_GetEuler(&state, euler_q);
+        sink += euler_q[0];
+    }
+    elapsed = Bench_Seconds() - start;
+    printf("Fusion_Q_GetEuler: %.0f ns/call\n", elapsed * 1e3);
+}
+
+int main(int argc, char** argv)
+{
+    double rate = (argc > 1) ? atof(argv[1]) : 100;
+    int sample_cnt;
+
+    if (rate < 1 || rate > BENCH_MAX_RATE)
+    {
+        printf("Update rate has to be between 1 and %d Hz.\n", BENCH_MAX_RATE);
+        return 1;
+    }
+
+    srand(1);
+    sample_cnt = Bench_GenerateTrace(rate);
+    Bench_Accuracy(sample_cnt, rate);
+    Bench_Alignment();
+    Bench_Speed(sample_cnt, rate);
+
+    return 0;
+}
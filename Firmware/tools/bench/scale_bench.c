@@ -0,0 +1,220 @@
+/**
+ * Host benchmark of the fixed point AO sensor value conversion.
+ *
+ * Compares CSN_AO_Convert with the Q24 scale factors computed by
+ * CSN_AO_UpdateScales against the float conversion previously done by the AO
+ * property handlers, e.g. x / 32768.0f * dyn_range * 9.80665f * 100.0f for
+ * acceleration in 0.01 m/s^2.
+ *
+ * Accuracy is checked exhaustively for all int16 raw values of every virtual
+ * sensor and the supported dynamic ranges of the physical sensors. The fixed
+ * point result has to stay within 1 LSB (0.01 unit) of the rounded float
+ * result.
+ *
+ * Cost of converting one 3 axis acceleration sample is reported in CPU cycles
+ * on x86 and in ns elsewhere. The host has a hardware FPU, while the float path
+ * runs in software on the Cortex-M3, so the host numbers understate the gain.
+ *
+ * CSN_LP_AO.c is included directly to reach its static conversion. Unused
+ * functions are removed by the linker, build and run from the Firmware
+ * directory:
+ *
+ *   gcc -O2 -std=gnu99 -D_RTE_ -ffunction-sections -fdata-sections \
+ *       -Wl,--gc-sections -Itools/bench/stubs -Iinclude -Iinclude/bdk -IRTE \
+ *       -o scale_bench tools/bench/scale_bench.c -lm
+ *   ./scale_bench
+ */
+
+#include <math.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "../../src/CSN_LP_AO.c"
+
+#define BENCH_SAMPLES                  (4096)
+#define BENCH_LOOPS                    (1000)
+
+/** Largest allowed difference from the float conversion in 0.01 unit. */
+#define BENCH_MAX_ERROR                (1)
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_CYCLE_UNIT               "cycles"
+#else
+#define BENCH_CYCLE_UNIT               "ns"
+#endif
+
+/** Dynamic ranges of physical sensors. */
+static const uint16_t bench_accel_range[] = { 2, 4, 8, 16 };
+static const uint16_t bench_gyro_range[] = { 125, 250, 500, 1000, 2000 };
+static const uint16_t bench_mag_range[] = { 1000, 1300, 2500 };
+
+#define BENCH_CNT(a)                   (sizeof(a) / sizeof((a)[0]))
+
+static uint16_t bench_accel = 4;
+static uint16_t bench_gyro = 2000;
+static uint16_t bench_mag = 1000;
+
+static int16_t bench_raw[BENCH_SAMPLES][3];
+static int32_t bench_out[BENCH_SAMPLES][3];
+
+uint16_t BHI160_NDOF_GetAccelDynamicRange(void)
+{
+    return bench_accel;
+}
+
+uint16_t BHI160_NDOF_GetGyroDynamicRange(void)
+{
+    return bench_gyro;
+}
+
+uint16_t BHI160_NDOF_GetMagDynamicRange(void)
+{
+    return bench_mag;
+}
+
+static uint64_t Bench_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+#endif
+}
+
+/** Conversion to 0.01 unit as done by the AO property handlers before. */
+static float Bench_FloatConvert(int16_t raw, int sensor)
+{
+    switch (sensor)
+    {
+    case CSN_AO_SENSOR_ORIENTATION:
+        return raw / 32768.0f * 360.0f * 100.0f;
+    case CSN_AO_SENSOR_GRAVITY:
+    case CSN_AO_SENSOR_LIN_ACCEL:
+        return raw / 32768.0f * bench_accel * 9.80665f * 100.0f;
+    case CSN_AO_SENSOR_MAGNETIC_FIELD:
+        return raw / 32768.0f * bench_mag * 100.0f;
+    default:
+        return raw / 32768.0f * bench_gyro * 100.0f;
+    }
+}
+
+/** Returns largest difference over all raw values of one sensor. */
+static int32_t Bench_Error(int sensor)
+{
+    int32_t max_error = 0;
+
+    CSN_AO_UpdateScales(NULL);
+    for (int32_t raw = INT16_MIN; raw <= INT16_MAX; ++raw)
+    {
+        int32_t fixed = CSN_AO_Convert(raw, ao_scale[sensor]);
+        int32_t ref = (int32_t) lroundf(Bench_FloatConvert(raw, sensor));
+        int32_t error = abs(fixed - ref);
+
+        if (error > max_error)
+        {
+            max_error = error;
+        }
+    }
+
+    return max_error;
+}
+
+static double Bench_RunFixed(void)
+{
+    uint64_t start = Bench_Cycles();
+
+    for (int i = 0; i < BENCH_LOOPS; ++i)
+    {
+        for (int n = 0; n < BENCH_SAMPLES; ++n)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                bench_out[n][j] = CSN_AO_Convert(bench_raw[n][j],
+                        ao_scale[CSN_AO_SENSOR_LIN_ACCEL]);
+            }
+        }
+        __asm__ volatile("" : : "r" (bench_out) : "memory");
+    }
+
+    return (double)(Bench_Cycles() - start) / BENCH_LOOPS / BENCH_SAMPLES;
+}
+
+static double Bench_RunFloat(void)
+{
+    volatile uint16_t dyn_range = bench_accel;
+    uint64_t start = Bench_Cycles();
+
+    for (int i = 0; i < BENCH_LOOPS; ++i)
+    {
+        for (int n = 0; n < BENCH_SAMPLES; ++n)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                bench_out[n][j] = (int32_t) (bench_raw[n][j] / 32768.0f
+                        * dyn_range * 9.80665f * 100.0f);
+            }
+        }
+        __asm__ volatile("" : : "r" (bench_out) : "memory");
+    }
+
+    return (double)(Bench_Cycles() - start) / BENCH_LOOPS / BENCH_SAMPLES;
+}
+
+int main(void)
+{
+    static const char* const name[CSN_AO_SENSOR_CNT] = {
+            "orientation", "gravity", "linear acceleration",
+            "magnetic field", "rate of rotation"
+    };
+    int failed = 0;
+
+    for (int sensor = 0; sensor < CSN_AO_SENSOR_CNT; ++sensor)
+    {
+        int32_t error = 0;
+
+        for (unsigned int a = 0; a < BENCH_CNT(bench_accel_range); ++a)
+        {
+            for (unsigned int g = 0; g < BENCH_CNT(bench_gyro_range); ++g)
+            {
+                for (unsigned int m = 0; m < BENCH_CNT(bench_mag_range); ++m)
+                {
+                    bench_accel = bench_accel_range[a];
+                    bench_gyro = bench_gyro_range[g];
+                    bench_mag = bench_mag_range[m];
+
+                    int32_t e = Bench_Error(sensor);
+                    error = (e > error) ? e : error;
+                }
+            }
+        }
+
+        printf("%-20s max error %d LSB%s\n", name[sensor], error,
+                (error > BENCH_MAX_ERROR) ? " FAILED" : "");
+        failed |= (error > BENCH_MAX_ERROR);
+    }
+
+    if (failed)
+    {
+        return 1;
+    }
+
+    srand(1);
+    for (int n = 0; n < BENCH_SAMPLES; ++n)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            bench_raw[n][j] = (int16_t) (rand() % 65536 - 32768);
+        }
+    }
+    bench_accel = 4;
+    CSN_AO_UpdateScales(NULL);
+
+    printf("fixed: %6.1f " BENCH_CYCLE_UNIT "/sample\n", Bench_RunFixed());
+    printf("float: %6.1f " BENCH_CYCLE_UNIT "/sample\n", Bench_RunFloat());
+
+    return 0;
+}
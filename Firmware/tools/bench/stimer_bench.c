@@ -0,0 +1,314 @@
+/**
+ * Host benchmark of the next timer expiry lookup.
+ *
+ * Compares stimer_get_next_expiry, which peeks at the deadline ordered heap of
+ * running timers, with the linked list scan previously done by
+ * Timer_SetWakeupAtNextEvent on every main loop iteration. Both lookups are
+ * checked to return the same result before they are timed.
+ *
+ * Cost of a stimer_is_expired call and of servicing one timer expiry, which is
+ * the wake-up computation of Timer_SetWakeupAtNextEvent followed by
+ * stimer_advance of the expired timer, is reported in CPU cycles on x86 and
+ * in ns elsewhere. Build the benchmark in both modes to compare them.
+ *
+ * Build and run from the Firmware directory. The firmware is built with
+ * STIMER_COUNT_MODE=1, use 0 to measure the duration mode of the library:
+ *
+ *   gcc -O2 -std=gnu99 -Iinclude/bdk -DSTIMER_MAX_QUEUED=512 \
+ *       -DSTIMER_COUNT_MODE=1 \
+ *       -o stimer_bench tools/bench/stimer_bench.c src/device/stimer.c
+ *   ./stimer_bench [timer count]
+ *
+ * STIMER_MAX_QUEUED has to be at least the timer count, otherwise timers
+ * that do not fit into the heap are found by a linear scan as well.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "stimer.h"
+
+#define BENCH_MAX_TIMERS               (512)
+#define BENCH_LOOPS                    (100000)
+
+/** Duration of one get_time_fn count in ns (32768 Hz RTC). */
+#define BENCH_NS_PER_COUNT             (30517)
+
+static struct stimer_ctx bench_ctx;
+static struct stimer bench_timer[BENCH_MAX_TIMERS];
+static uint32_t bench_now = 0xFFFF0000U;
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_CYCLE_UNIT               "cycles"
+#else
+#define BENCH_CYCLE_UNIT               "ns"
+#endif
+
+static uint64_t Bench_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000000000ULL + t.tv_nsec;
+#endif
+}
+
+static uint32_t Bench_GetTime(void* hint)
+{
+    (void) hint;
+
+    return bench_now;
+}
+
+#if STIMER_COUNT_MODE
+/** Linked list scan as done by Timer_SetWakeupAtNextEvent before timers
+ * were kept in a heap. Returns the number of counts to the nearest expiry. */
+static bool Bench_ListNextExpiry(struct stimer_ctx* ctx, uint32_t* counts)
+{
+    uint64_t next = UINT64_MAX;
+    bool found = false;
+
+    stimer_execute_context(ctx);
+
+    for (struct stimer* ts = ctx->root; ts != NULL; ts = ts->next)
+    {
+        if (ts->is_running == false || ts->expire_counts == 0)
+        {
+            continue;
+        }
+
+        found = true;
+        if (ts->elapsed_counts >= ts->expire_counts)
+        {
+            *counts = 0;
+            return true;
+        }
+
+        if (ts->expire_counts - ts->elapsed_counts < next)
+        {
+            next = ts->expire_counts - ts->elapsed_counts;
+        }
+    }
+
+    if (found)
+    {
+        *counts = (uint32_t)next;
+    }
+
+    return found;
+}
+#else
+static bool Bench_DurationGe(const struct stimer_duration* lhs,
+        const struct stimer_duration* rhs)
+{
+    return (lhs->seconds > rhs->seconds)
+            || (lhs->seconds == rhs->seconds
+                && lhs->nanoseconds >= rhs->nanoseconds);
+}
+
+/** Linked list scan as done by Timer_SetWakeupAtNextEvent before timers
+ * were kept in a heap. Returns the number of counts to the nearest expiry. */
+static bool Bench_ListNextExpiry(struct stimer_ctx* ctx, uint32_t* counts)
+{
+    struct stimer_duration next = {UINT32_MAX, UINT32_MAX};
+    struct stimer_duration diff;
+    bool found = false;
+
+    stimer_execute_context(ctx);
+
+    for (struct stimer* ts = ctx->root; ts != NULL; ts = ts->next)
+    {
+        if (ts->is_running == false || (ts->expire_interval.seconds == 0
+                && ts->expire_interval.nanoseconds == 0))
+        {
+            continue;
+        }
+
+        found = true;
+        if (Bench_DurationGe(&ts->elapsed, &ts->expire_interval))
+        {
+            *counts = 0;
+            return true;
+        }
+
+        diff.seconds = ts->expire_interval.seconds - ts->elapsed.seconds;
+        if (ts->expire_interval.nanoseconds >= ts->elapsed.nanoseconds)
+        {
+            diff.nanoseconds = ts->expire_interval.nanoseconds
+                    - ts->elapsed.nanoseconds;
+        }
+        else
+        {
+            diff.seconds -= 1;
+            diff.nanoseconds = 1000000000U + ts->expire_interval.nanoseconds
+                    - ts->elapsed.nanoseconds;
+        }
+
+        if (Bench_DurationGe(&diff, &next) == false)
+        {
+            next = diff;
+        }
+    }
+
+    if (found)
+    {
+        uint64_t ns = next.seconds * 1000000000ULL + next.nanoseconds;
+        *counts = (uint32_t)((ns + ctx->ns_per_count - 1) / ctx->ns_per_count);
+    }
+
+    return found;
+}
+#endif /* STIMER_COUNT_MODE */
+
+static double Bench_Run(bool (*next_expiry)(struct stimer_ctx*, uint32_t*))
+{
+    uint32_t counts;
+    clock_t start = clock();
+
+    for (int i = 0; i < BENCH_LOOPS; ++i)
+    {
+        // Time advances a little between main loop iterations.
+        bench_now += 1;
+        next_expiry(&bench_ctx, &counts);
+    }
+
+    return (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / BENCH_LOOPS;
+}
+
+/** Cost of one stimer_is_expired call on running timers. */
+static double Bench_IsExpired(int timer_cnt)
+{
+    volatile bool expired;
+    uint64_t start = Bench_Cycles();
+
+    for (int i = 0; i < BENCH_LOOPS; ++i)
+    {
+        bench_now += 1;
+        expired = stimer_is_expired(&bench_timer[i % timer_cnt]);
+    }
+    (void) expired;
+
+    return (double)(Bench_Cycles() - start) / BENCH_LOOPS;
+}
+
+/** Cost of servicing one timer expiry as done by the main loop. Wake-up time
+ * is computed before sleeping, again after waking up at that time when it is
+ * reported as due, and the expired periodic timer is then advanced. */
+static double Bench_WakeUp(int timer_cnt)
+{
+    uint32_t counts;
+    int event_cnt = 0;
+    uint64_t start = Bench_Cycles();
+
+    while (event_cnt < BENCH_LOOPS
+           && stimer_get_next_expiry(&bench_ctx, &counts))
+    {
+        if (counts > 0)
+        {
+            bench_now += counts;
+            continue;
+        }
+
+        // Expired timer is at the root of the heap unless it did not fit.
+        if (bench_ctx.queue_len > 0 && stimer_is_expired(bench_ctx.queue[0]))
+        {
+            stimer_advance(bench_ctx.queue[0]);
+        }
+        else
+        {
+            for (int i = 0; i < timer_cnt; ++i)
+            {
+                if (stimer_is_expired(&bench_timer[i]))
+                {
+                    stimer_advance(&bench_timer[i]);
+                    break;
+                }
+            }
+        }
+        event_cnt += 1;
+    }
+
+    return (double)(Bench_Cycles() - start) / event_cnt;
+}
+
+int main(int argc, char** argv)
+{
+    int timer_cnt = (argc > 1) ? atoi(argv[1]) : 300;
+    uint32_t heap_counts, list_counts;
+    int mismatch_cnt = 0;
+
+    if (timer_cnt < 1 || timer_cnt > BENCH_MAX_TIMERS)
+    {
+        printf("Timer count has to be between 1 and %d.\n", BENCH_MAX_TIMERS);
+        return 1;
+    }
+
+    stimer_init_context(&bench_ctx, NULL, Bench_GetTime, 0xFFFFFFFF,
+            BENCH_NS_PER_COUNT);
+    for (int i = 0; i < timer_cnt; ++i)
+    {
+        stimer_init(&bench_timer[i], &bench_ctx);
+        stimer_expire_from_now_ms(&bench_timer[i], 1000 + (i * 7919) % 60000);
+    }
+
+    // Both lookups have to agree while timers are restarted and time passes.
+    srand(1);
+    for (int i = 0; i < 10000; ++i)
+    {
+        struct stimer* ts = &bench_timer[rand() % timer_cnt];
+
+        switch (rand() % 4)
+        {
+        case 0:
+            stimer_expire_from_now_ms(ts, rand() % 60000 + 1);
+            break;
+        case 1:
+            stimer_stop(ts);
+            break;
+        case 2:
+            stimer_start(ts);
+            break;
+        default:
+            bench_now += rand() % 2000;
+            break;
+        }
+
+        bool heap_found = stimer_get_next_expiry(&bench_ctx, &heap_counts);
+        bool list_found = Bench_ListNextExpiry(&bench_ctx, &list_counts);
+        if (heap_found != list_found
+            || (heap_found && heap_counts != list_counts))
+        {
+            mismatch_cnt += 1;
+        }
+    }
+
+    if (mismatch_cnt != 0)
+    {
+        printf("Lookups disagree in %d cases.\n", mismatch_cnt);
+        return 1;
+    }
+
+    for (int i = 0; i < timer_cnt; ++i)
+    {
+        stimer_expire_from_now_ms(&bench_timer[i], 1000 + (i * 7919) % 60000);
+    }
+
+    printf("mode: %s\n", STIMER_COUNT_MODE ? "count" : "duration");
+    printf("timers: %d (heap %u, overflow %d)\n", timer_cnt,
+            bench_ctx.queue_len, bench_ctx.queue_overflow);
+    printf("heap: %8.1f ns/loop\n", Bench_Run(stimer_get_next_expiry));
+    printf("list: %8.1f ns/loop\n", Bench_Run(Bench_ListNextExpiry));
+    printf("stimer_is_expired: %8.1f " BENCH_CYCLE_UNIT "/call\n",
+            Bench_IsExpired(timer_cnt));
+    printf("wake-up:           %8.1f " BENCH_CYCLE_UNIT "/expiry\n",
+            Bench_WakeUp(timer_cnt));
+
+    return 0;
+}
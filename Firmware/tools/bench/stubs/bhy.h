@@ -0,0 +1,20 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the BHY1 driver base header of the BHI160 SDK.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_BHY_H_
+#define BENCH_STUB_BHY_H_
+
+#include <stdint.h>
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef int16_t s16;
+
+typedef int8_t BHY_RETURN_FUNCTION_TYPE;
+
+#define BHY_SUCCESS                    ((int8_t)0)
+#define BHY_ERROR                      ((int8_t)-1)
+#define BHY_OUT_OF_RANGE               ((int8_t)-2)
+
+#endif /* BENCH_STUB_BHY_H_ */
@@ -0,0 +1,12 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the BHI160 RAM patch of the BHI160 SDK.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_BHY1_FIRMWARE_H_
+#define BENCH_STUB_BHY1_FIRMWARE_H_
+
+#include <stdint.h>
+
+extern const uint8_t bhy1_fw[];
+
+#endif /* BENCH_STUB_BHY1_FIRMWARE_H_ */
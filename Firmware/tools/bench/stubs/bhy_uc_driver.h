@@ -0,0 +1,176 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the BHY1 micro controller driver header of the BHI160
+// SDK. Sensor ids and packet types use the values of the real driver.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_BHY_UC_DRIVER_H_
+#define BENCH_STUB_BHY_UC_DRIVER_H_
+
+#include <stdint.h>
+
+#include "bhy.h"
+
+typedef enum
+{
+    VS_NON_WAKEUP = 0,
+    VS_WAKEUP = 32
+} bhy_virtual_sensor_t;
+
+#define VS_FLUSH_NONE                  (0)
+
+#define VS_TYPE_ACCELEROMETER          (1)
+#define VS_TYPE_GEOMAGNETIC_FIELD      (2)
+#define VS_TYPE_ORIENTATION            (3)
+#define VS_TYPE_GYROSCOPE              (4)
+#define VS_TYPE_GRAVITY                (9)
+#define VS_TYPE_LINEAR_ACCELERATION    (10)
+#define VS_TYPE_SIGNIFICANT_MOTION     (17)
+
+enum
+{
+    VS_ID_ACCELEROMETER = VS_TYPE_ACCELEROMETER,
+    VS_ID_MAGNETOMETER = VS_TYPE_GEOMAGNETIC_FIELD,
+    VS_ID_ORIENTATION = VS_TYPE_ORIENTATION,
+    VS_ID_GYROSCOPE = VS_TYPE_GYROSCOPE,
+    VS_ID_GRAVITY = VS_TYPE_GRAVITY,
+    VS_ID_LINEAR_ACCELERATION = VS_TYPE_LINEAR_ACCELERATION,
+    VS_ID_SIGNIFICANT_MOTION = VS_TYPE_SIGNIFICANT_MOTION,
+    VS_ID_ACCELEROMETER_WAKEUP = VS_TYPE_ACCELEROMETER + VS_WAKEUP,
+    VS_ID_MAGNETOMETER_WAKEUP = VS_TYPE_GEOMAGNETIC_FIELD + VS_WAKEUP,
+    VS_ID_ORIENTATION_WAKEUP = VS_TYPE_ORIENTATION + VS_WAKEUP,
+    VS_ID_GYROSCOPE_WAKEUP = VS_TYPE_GYROSCOPE + VS_WAKEUP,
+    VS_ID_GRAVITY_WAKEUP = VS_TYPE_GRAVITY + VS_WAKEUP,
+    VS_ID_LINEAR_ACCELERATION_WAKEUP = VS_TYPE_LINEAR_ACCELERATION + VS_WAKEUP,
+    VS_ID_SIGNIFICANT_MOTION_WAKEUP = VS_TYPE_SIGNIFICANT_MOTION + VS_WAKEUP
+};
+
+typedef struct
+{
+    int16_t x;
+    int16_t y;
+    int16_t z;
+    uint8_t status;
+} bhy_data_vector_t;
+
+typedef struct
+{
+    uint16_t data;
+} bhy_data_scalar_u16_t;
+
+typedef struct
+{
+    uint8_t data;
+} bhy_data_scalar_u8_t;
+
+typedef struct
+{
+    uint8_t event_number;
+    uint8_t sensor_type;
+    uint8_t event_specific;
+} bhy_data_meta_event_t;
+
+typedef struct
+{
+    uint8_t sys_id;
+    uint8_t flag;
+    uint8_t data[13];
+} bhy_data_debug_t;
+
+typedef union
+{
+    bhy_data_vector_t data_vector;
+    bhy_data_scalar_u16_t data_scalar_u16;
+    bhy_data_scalar_u8_t data_scalar_u8;
+    bhy_data_meta_event_t data_meta_event;
+    bhy_data_debug_t data_debug;
+} bhy_data_generic_t;
+
+typedef enum
+{
+    BHY_DATA_TYPE_PADDING = 0,
+    BHY_DATA_TYPE_SCALAR_U8,
+    BHY_DATA_TYPE_SCALAR_U16,
+    BHY_DATA_TYPE_VECTOR,
+    BHY_DATA_TYPE_META_EVENT,
+    BHY_DATA_TYPE_DEBUG
+} bhy_data_type_t;
+
+typedef enum
+{
+    BHY_META_EVENT_TYPE_DYNAMIC_RANGE_CHANGED = 7
+} bhy_meta_event_type_t;
+
+typedef enum
+{
+    BHY_FIFO_WATER_MARK_WAKEUP = 0,
+    BHY_FIFO_WATER_MARK_NON_WAKEUP
+} bhy_fifo_buffer_type_t;
+
+struct accel_physical_status_t
+{
+    uint16_t accel_sample_rate;
+    uint16_t accel_dynamic_range;
+    uint8_t accel_flag;
+};
+
+struct gyro_physical_status_t
+{
+    uint16_t gyro_sample_rate;
+    uint16_t gyro_dynamic_range;
+    uint8_t gyro_flag;
+};
+
+struct mag_physical_status_t
+{
+    uint16_t mag_sample_rate;
+    uint16_t mag_dynamic_range;
+    uint8_t mag_flag;
+};
+
+#define PHYSICAL_SENSOR_INDEX_ACC      (0)
+#define PHYSICAL_SENSOR_INDEX_MAG      (1)
+#define PHYSICAL_SENSOR_INDEX_GYRO     (2)
+
+#define BHY_HOST_ALGO_STANDBY_REQUEST  (1)
+#define BHY_HOST_AP_SUSPEND            (2)
+
+extern BHY_RETURN_FUNCTION_TYPE bhy_driver_init(const uint8_t* bhy_fw_data);
+extern BHY_RETURN_FUNCTION_TYPE bhy_mapping_matrix_set(uint8_t index,
+        int8_t* mapping_matrix);
+extern BHY_RETURN_FUNCTION_TYPE bhy_install_sensor_callback(
+        uint8_t sensor_type, bhy_virtual_sensor_t wakeup_status,
+        void (*sensor_callback)(bhy_data_generic_t*, bhy_virtual_sensor_t));
+extern BHY_RETURN_FUNCTION_TYPE bhy_install_timestamp_callback(
+        bhy_virtual_sensor_t wakeup_status,
+        void (*timestamp_callback)(bhy_data_scalar_u16_t*));
+extern BHY_RETURN_FUNCTION_TYPE bhy_install_meta_event_callback(
+        bhy_meta_event_type_t meta_event_id,
+        void (*meta_event_callback)(bhy_data_meta_event_t*,
+                bhy_meta_event_type_t));
+extern BHY_RETURN_FUNCTION_TYPE bhy_enable_virtual_sensor(uint8_t sensor_type,
+        bhy_virtual_sensor_t wakeup_status, uint16_t sample_rate,
+        uint16_t max_report_latency_ms, uint8_t flush_sensor,
+        uint16_t change_sensitivity, uint16_t dynamic_range);
+extern BHY_RETURN_FUNCTION_TYPE bhy_disable_virtual_sensor(
+        uint8_t sensor_type, bhy_virtual_sensor_t wakeup_status);
+extern BHY_RETURN_FUNCTION_TYPE bhy_read_fifo(uint8_t* buffer,
+        uint16_t buffer_size, uint16_t* bytes_read, uint16_t* bytes_left);
+extern BHY_RETURN_FUNCTION_TYPE bhy_parse_next_fifo_packet(
+        uint8_t** fifo_buffer, uint16_t* fifo_buffer_length,
+        bhy_data_generic_t* fifo_data_output,
+        bhy_data_type_t* fifo_data_type);
+extern void bhy_print_debug_packet(bhy_data_debug_t* packet,
+        void (*debug_print_ptr)(const uint8_t*));
+extern void bhy_printf(const uint8_t* string);
+extern void bhy_update_system_timestamp(bhy_data_scalar_u16_t* new_timestamp,
+        uint32_t* system_timestamp);
+extern BHY_RETURN_FUNCTION_TYPE bhy_get_physical_sensor_status(
+        struct accel_physical_status_t* accel_status,
+        struct gyro_physical_status_t* gyro_status,
+        struct mag_physical_status_t* mag_status);
+extern BHY_RETURN_FUNCTION_TYPE bhy_set_host_interface_control(uint8_t param,
+        uint8_t value);
+extern BHY_RETURN_FUNCTION_TYPE bhy_set_fifo_water_mark(
+        bhy_fifo_buffer_type_t buffer_type, uint16_t water_mark);
+
+#endif /* BENCH_STUB_BHY_UC_DRIVER_H_ */
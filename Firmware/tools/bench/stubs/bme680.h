@@ -0,0 +1,22 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the BME680 driver header.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_BME680_H_
+#define BENCH_STUB_BME680_H_
+
+#include <stdint.h>
+
+#define BME680_OK                      (0)
+
+struct bme680_dev
+{
+    uint8_t chip_id;
+};
+
+struct bme680_field_data
+{
+    uint8_t status;
+};
+
+#endif /* BENCH_STUB_BME680_H_ */
@@ -0,0 +1,48 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the BSEC library interface header.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_BSEC_INTERFACE_H_
+#define BENCH_STUB_BSEC_INTERFACE_H_
+
+#include <stdint.h>
+
+typedef int bsec_library_return_t;
+
+typedef struct
+{
+    float sample_rate;
+    uint8_t sensor_id;
+} bsec_sensor_configuration_t;
+
+typedef struct
+{
+    uint8_t process_data;
+} bsec_bme_settings_t;
+
+typedef struct
+{
+    float signal;
+    uint8_t sensor_id;
+} bsec_input_t;
+
+typedef struct
+{
+    float signal;
+    uint8_t sensor_id;
+} bsec_output_t;
+
+#define BSEC_OK                        (0)
+#define BSEC_MAX_PHYSICAL_SENSOR       (8)
+#define BSEC_NUMBER_OUTPUTS            (14)
+#define BSEC_MAX_STATE_BLOB_SIZE       (139)
+#define BSEC_MAX_PROPERTY_BLOB_SIZE    (454)
+#define BSEC_SAMPLE_RATE_LP            (0.33333f)
+#define BSEC_SAMPLE_RATE_ULP           (0.0033333f)
+
+#define BSEC_OUTPUT_IAQ                (1)
+#define BSEC_OUTPUT_RAW_PRESSURE       (7)
+#define BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE (14)
+#define BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY (15)
+
+#endif /* BENCH_STUB_BSEC_INTERFACE_H_ */
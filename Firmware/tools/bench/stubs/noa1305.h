@@ -0,0 +1,35 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the NOA1305 driver header.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_NOA1305_H_
+#define BENCH_STUB_NOA1305_H_
+
+#include <stdint.h>
+
+struct noa1305_t
+{
+    uint8_t id;
+    uint32_t integration_constatnt;
+    int32_t (*read_func)(uint8_t addr, uint8_t reg, uint8_t* data);
+    int32_t (*write_func)(uint8_t addr, uint8_t reg, uint8_t data);
+    void (*delay_func)(uint32_t ms);
+};
+
+#define NOA1305_OK                     (0)
+#define NOA1305_COMM_OK                (0)
+#define NOA1305_COMM_ERROR             (1)
+#define NOA1305_I2C_ADDR               (0x39)
+#define NOA1305_INT_INACTIVE           (0)
+#define NOA1305_POWER_DOWN             (0)
+#define NOA1305_POWER_ON               (1)
+#define NOA1305_INTEG_TIME_200MS       (2)
+
+extern int32_t noa1305_init(struct noa1305_t* dev);
+extern int32_t noa1305_set_int_select(int select, struct noa1305_t* dev);
+extern int32_t noa1305_set_integration_time(int time, struct noa1305_t* dev);
+extern int32_t noa1305_set_power_mode(int mode, struct noa1305_t* dev);
+extern int32_t noa1305_convert_als_data_lux(uint32_t* lux,
+        struct noa1305_t* dev);
+
+#endif /* BENCH_STUB_NOA1305_H_ */
@@ -0,0 +1,185 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the RSL10 device header of the RSL10 SDK.
+//
+// Declares only the registers, constants and functions referenced by the
+// firmware sources that are built by the host benchmarks in tools/bench.
+// Register blocks are plain structures that the benchmarks can inspect.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_RSL10_H_
+#define BENCH_STUB_RSL10_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define __STATIC_INLINE                static inline
+
+// Interrupts
+typedef int IRQn_Type;
+
+enum
+{
+    RTC_ALARM_IRQn = 1,
+    RTC_CLOCK_IRQn,
+    DIO0_IRQn,
+    DIO1_IRQn,
+    DIO2_IRQn,
+    DIO3_IRQn
+};
+
+extern void NVIC_EnableIRQ(IRQn_Type irq);
+extern void NVIC_DisableIRQ(IRQn_Type irq);
+extern void NVIC_SetPendingIRQ(IRQn_Type irq);
+extern void NVIC_ClearPendingIRQ(IRQn_Type irq);
+extern uint32_t NVIC_GetPendingIRQ(IRQn_Type irq);
+
+extern void __enable_irq(void);
+extern void __disable_irq(void);
+extern uint32_t __get_PRIMASK(void);
+extern void __set_PRIMASK(uint32_t primask);
+extern void __set_FAULTMASK(uint32_t faultmask);
+extern void __DMB(void);
+extern void __WFI(void);
+
+// System control block
+typedef struct
+{
+    volatile uint32_t ICSR;
+    volatile uint32_t SCR;
+} SCB_Type;
+
+extern SCB_Type* SCB;
+
+#define SCB_ICSR_VECTACTIVE_Msk        (0xFF)
+#define SCB_SCR_SLEEPDEEP_Msk          (1 << 2)
+
+// Cycle counter
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+extern DWT_Type* DWT;
+extern CoreDebug_Type* CoreDebug;
+
+#define DWT_CTRL_CYCCNTENA_Msk         (1 << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk     (1 << 24)
+
+// Analog control and RTC
+typedef struct
+{
+    volatile uint32_t RTC_COUNT;
+    volatile uint32_t RTC_CFG;
+    volatile uint32_t RTC_CTRL;
+    volatile uint32_t XTAL32K_CTRL;
+} ACS_Type;
+
+typedef struct
+{
+    volatile uint32_t RESET_ALIAS;
+} ACS_RTC_CTRL_Type;
+
+typedef struct
+{
+    volatile uint8_t WAKEUP_SRC_BYTE;
+} ACS_WAKEUP_STATE_Type;
+
+extern ACS_Type* ACS;
+extern ACS_RTC_CTRL_Type* ACS_RTC_CTRL;
+extern ACS_WAKEUP_STATE_Type* ACS_WAKEUP_STATE;
+
+#define RTC_RESET_BITBAND              (1)
+#define RTC_RESET                      (1 << 0)
+#define RTC_ALARM_ZERO                 (1 << 1)
+#define RTC_CLK_SRC_XTAL32K            (1 << 2)
+#define RTC_ENABLE                     (1 << 3)
+
+#define WAKEUP_DUE_TO_RTC_ALARM_BYTE   (1)
+#define WAKEUP_DUE_TO_BB_TIMER_BYTE    (2)
+#define WAKEUP_DUE_TO_DIO0_BYTE        (3)
+#define WAKEUP_DUE_TO_DIO1_BYTE        (4)
+#define WAKEUP_DUE_TO_DIO2_BYTE        (5)
+#define WAKEUP_DUE_TO_DIO3_BYTE        (6)
+
+#define WAKEUP_DIO0_DISABLE            (0)
+#define WAKEUP_DIO1_DISABLE            (0)
+#define WAKEUP_DIO3_DISABLE            (0)
+#define WAKEUP_DIO0_ENABLE             (1 << 0)
+#define WAKEUP_DIO1_ENABLE             (1 << 1)
+#define WAKEUP_DIO2_ENABLE             (1 << 2)
+#define WAKEUP_DIO3_ENABLE             (1 << 3)
+#define WAKEUP_DIO0_RISING             (1 << 4)
+#define WAKEUP_DIO1_RISING             (1 << 5)
+#define WAKEUP_DIO2_RISING             (1 << 6)
+#define WAKEUP_DIO3_RISING             (1 << 7)
+#define WAKEUP_WAKEUP_PAD_RISING       (1 << 8)
+
+// Digital IO
+typedef struct
+{
+    volatile uint32_t ALIAS[16];
+} DIO_DATA_Type;
+
+typedef struct
+{
+    volatile uint32_t DATA;
+    volatile uint32_t CFG[16];
+    volatile uint32_t JTAG_SW_PAD_CFG;
+    volatile uint32_t PAD_CFG;
+} DIO_Type;
+
+extern DIO_DATA_Type* DIO_DATA;
+extern DIO_Type* DIO;
+
+extern void Sys_DIO_Config(uint32_t pad, uint32_t cfg);
+extern void Sys_DIO_IntConfig(uint32_t index, uint32_t cfg, uint32_t dbnc_clk,
+        uint32_t dbnc_count);
+
+#define DIO_MODE_GPIO_IN_0             (1 << 0)
+#define DIO_MODE_DISABLE               (1 << 1)
+#define DIO_WEAK_PULL_UP               (1 << 2)
+#define DIO_NO_PULL                    (1 << 3)
+#define DIO_DEBOUNCE_DISABLE           (0)
+#define DIO_DEBOUNCE_ENABLE            (1 << 4)
+#define DIO_EVENT_RISING_EDGE          (1 << 5)
+#define DIO_EVENT_FALLING_EDGE         (1 << 6)
+#define DIO_EVENT_TRANSITION           (1 << 7)
+#define DIO_DEBOUNCE_SLOWCLK_DIV32     (1)
+#define DIO_DEBOUNCE_SLOWCLK_DIV1024   (2)
+
+// System
+#define SYS_WAIT_FOR_INTERRUPT         do { } while (0)
+
+extern void Sys_Watchdog_Refresh(void);
+extern void Kernel_Schedule(void);
+
+// Sleep mode
+struct sleep_mode_env_tag
+{
+    uint32_t wakeup_ctrl;
+    uint32_t mem_power_cfg;
+};
+
+struct sleep_mode_init_env_tag
+{
+    uint32_t rtc_ctrl;
+    uint32_t wakeup_cfg;
+    uint32_t app_addr;
+    uint32_t wakeup_addr;
+    uint32_t mem_power_cfg_wakeup;
+    uint32_t DMA_channel_RF;
+};
+
+#define POWER_MODE_SLEEP               (1)
+
+extern bool BLE_Power_Mode_Enter(struct sleep_mode_env_tag* env,
+        int power_mode);
+
+#endif /* BENCH_STUB_RSL10_H_ */
@@ -0,0 +1,10 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the BLE stack header of the RSL10 SDK.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_RSL10_BLE_H_
+#define BENCH_STUB_RSL10_BLE_H_
+
+#include <stdint.h>
+
+#endif /* BENCH_STUB_RSL10_BLE_H_ */
@@ -0,0 +1,8 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for rsl10_hw_cid101.h of the RSL10 SDK.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_RSL10_HW_CID101_H_
+#define BENCH_STUB_RSL10_HW_CID101_H_
+
+#endif /* BENCH_STUB_RSL10_HW_CID101_H_ */
@@ -0,0 +1,55 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for the kernel header of the RSL10 SDK.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_RSL10_KE_H_
+#define BENCH_STUB_RSL10_KE_H_
+
+#include <stdint.h>
+
+typedef uint16_t ke_msg_id_t;
+typedef uint16_t ke_task_id_t;
+typedef uint8_t ke_state_t;
+
+typedef int (*ke_msg_func_t)(ke_msg_id_t const msgid, void const* param,
+        ke_task_id_t const dest_id, ke_task_id_t const src_id);
+
+struct ke_msg_handler
+{
+    ke_msg_id_t id;
+    ke_msg_func_t func;
+};
+
+struct ke_state_handler
+{
+    const struct ke_msg_handler* msg_table;
+    uint16_t msg_cnt;
+};
+
+struct ke_task_desc
+{
+    const struct ke_state_handler* state_handler;
+    const struct ke_state_handler* default_handler;
+    ke_state_t* state;
+    uint16_t state_max;
+    uint16_t idx_max;
+};
+
+#define TASK_FIRST_MSG(task)           ((ke_msg_id_t)((task) << 10))
+#define TASK_ID_APP                    (5)
+#define TASK_APP                       (5)
+#define KE_MSG_DEFAULT_HANDLER         (0xFFFF)
+#define KE_MSG_CONSUMED                (0)
+#define KE_TASK_OK                     (0)
+
+#define KE_MSG_ALLOC_DYN(id, dest, src, type, len) \
+        ((struct type*)ke_msg_alloc((id), (dest), (src), \
+                sizeof(struct type) + (len)))
+
+extern void* ke_msg_alloc(ke_msg_id_t id, ke_task_id_t dest_id,
+        ke_task_id_t src_id, uint16_t param_len);
+extern void ke_msg_send(void const* param);
+extern uint8_t ke_task_create(uint8_t task_type,
+        const struct ke_task_desc* p_task_desc);
+
+#endif /* BENCH_STUB_RSL10_KE_H_ */
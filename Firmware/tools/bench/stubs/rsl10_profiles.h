@@ -0,0 +1,8 @@
+//-----------------------------------------------------------------------------
+// Host stand-in for rsl10_profiles.h of the RSL10 SDK.
+//-----------------------------------------------------------------------------
+
+#ifndef BENCH_STUB_RSL10_PROFILES_H_
+#define BENCH_STUB_RSL10_PROFILES_H_
+
+#endif /* BENCH_STUB_RSL10_PROFILES_H_ */
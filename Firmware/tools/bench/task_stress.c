@@ -0,0 +1,300 @@
+/**
+ * Host stress test of the deferred callback queue of BDK_Task.c.
+ *
+ * Four producer threads schedule numbered callbacks with BDK_TaskSchedule
+ * while one consumer thread runs them with BDK_TaskRunQueued, the way
+ * interrupts and the main loop use the queue. Callbacks that do not fit into
+ * the queue are sent as kernel messages, which the consumer executes after
+ * each BDK_TaskRunQueued call like Kernel_Schedule does.
+ *
+ * Checks that every callback runs exactly once, that callbacks of each
+ * producer passing through the queue run in the order they were scheduled
+ * and that the overflow and high-water counters match what the consumer saw.
+ * Producers schedule callbacks in bursts and yield in between, so that the
+ * queue is used most of the time and fills up now and then.
+ *
+ * BDK_Task.c is included directly to reach its kernel message handler. Build
+ * and run from the Firmware directory:
+ *
+ *   gcc -O2 -std=gnu99 -pthread -D_RTE_ -Itools/bench/stubs -Iinclude \
+ *       -Iinclude/bdk -IRTE -o task_stress tools/bench/task_stress.c
+ *   ./task_stress
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../../src/device/BDK_Task.c"
+
+#define BENCH_PRODUCERS                (4)
+#define BENCH_CALLBACKS                (1 << 20)
+
+/** Producers yield after bursts of 1 to BENCH_MAX_BURST callbacks, so that
+ * bursts of several producers can exceed the queue size. */
+#define BENCH_MAX_BURST                (6)
+
+/** Kernel message sent by BDK_TaskSchedule when the queue is full. */
+struct BenchMsg
+{
+    struct BenchMsg* next;
+    struct BDK_TimerCmd cmd;
+};
+
+static struct BenchMsg* bench_msg_head;
+static struct BenchMsg* bench_msg_tail;
+static pthread_mutex_t bench_msg_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/** Number of runs of each callback. */
+static uint8_t bench_run_cnt[BENCH_PRODUCERS][BENCH_CALLBACKS];
+
+/** Next sequence number expected from the queue for each producer. */
+static uint32_t bench_next_seq[BENCH_PRODUCERS];
+
+static uint32_t bench_queue_run_cnt;
+static uint32_t bench_msg_run_cnt;
+static uint32_t bench_order_errors;
+static bool bench_from_msg;
+
+static volatile int bench_producers_done;
+
+void* ke_msg_alloc(ke_msg_id_t id, ke_task_id_t dest_id, ke_task_id_t src_id,
+        uint16_t param_len)
+{
+    struct BenchMsg* msg = malloc(sizeof(struct BenchMsg));
+
+    msg->next = NULL;
+    return &msg->cmd;
+}
+
+void ke_msg_send(void const* param)
+{
+    struct BenchMsg* msg = (struct BenchMsg*)((char*)param
+            - offsetof(struct BenchMsg, cmd));
+
+    pthread_mutex_lock(&bench_msg_lock);
+    if (bench_msg_tail != NULL)
+    {
+        bench_msg_tail->next = msg;
+    }
+    else
+    {
+        bench_msg_head = msg;
+    }
+    bench_msg_tail = msg;
+    pthread_mutex_unlock(&bench_msg_lock);
+}
+
+uint8_t ke_task_create(uint8_t task_type,
+        const struct ke_task_desc* p_task_desc)
+{
+    return KE_TASK_OK;
+}
+
+void HAL_Failed(const char* file, int line, const char* expr)
+{
+    printf("%s:%d: %s\n", file, line, expr);
+    abort();
+}
+
+/** Executes pending kernel messages like Kernel_Schedule. */
+static void Bench_KernelSchedule(void)
+{
+    struct BenchMsg* msg;
+
+    pthread_mutex_lock(&bench_msg_lock);
+    msg = bench_msg_head;
+    bench_msg_head = NULL;
+    bench_msg_tail = NULL;
+    pthread_mutex_unlock(&bench_msg_lock);
+
+    bench_from_msg = true;
+    while (msg != NULL)
+    {
+        struct BenchMsg* next = msg->next;
+
+        BDK_TimerMsgHandler(BDK_SCHEDULE_MSG, &msg->cmd, TASK_APP, TASK_APP);
+        free(msg);
+        msg = next;
+    }
+    bench_from_msg = false;
+}
+
+/** Argument holds producer index in the top byte and sequence number. */
+static void Bench_Callback(void* arg)
+{
+    uint32_t producer = (uintptr_t)arg >> 24;
+    uint32_t seq = (uintptr_t)arg & 0xFFFFFF;
+
+    bench_run_cnt[producer][seq] += 1;
+
+    if (bench_from_msg)
+    {
+        bench_msg_run_cnt += 1;
+        return;
+    }
+
+    bench_queue_run_cnt += 1;
+    if (seq < bench_next_seq[producer])
+    {
+        bench_order_errors += 1;
+    }
+    bench_next_seq[producer] = seq + 1;
+}
+
+static void* Bench_Producer(void* arg)
+{
+    uintptr_t producer = (uintptr_t)arg;
+    unsigned int seed = producer + 1;
+    int burst = 0;
+
+    for (uintptr_t seq = 0; seq < BENCH_CALLBACKS; ++seq)
+    {
+        BDK_TaskSchedule(Bench_Callback, (void*)(producer << 24 | seq));
+
+        if (burst-- == 0)
+        {
+            burst = rand_r(&seed) % BENCH_MAX_BURST;
+            sched_yield();
+        }
+    }
+
+    __atomic_fetch_add(&bench_producers_done, 1, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+static void Bench_Consumer(void)
+{
+    while (1)
+    {
+        bool done = __atomic_load_n(&bench_producers_done, __ATOMIC_ACQUIRE)
+                == BENCH_PRODUCERS;
+
+        BDK_TaskRunQueued();
+        Bench_KernelSchedule();
+
+        if (done && BDK_TaskIsQueueEmpty())
+        {
+            break;
+        }
+
+        sched_yield();
+    }
+}
+
+/** Fills the queue without a consumer. Callbacks beyond the queue size have
+ * to overflow and the high-water mark has to reach the queue size. */
+static int Bench_FillTest(void)
+{
+    const struct BDK_TaskQueueStats* stats = BDK_TaskGetQueueStats();
+
+    for (uintptr_t seq = 0; seq < RTE_APP_TASK_QUEUE_SIZE + 3; ++seq)
+    {
+        BDK_TaskSchedule(Bench_Callback, (void*)seq);
+    }
+
+    if (stats->queued_cnt != RTE_APP_TASK_QUEUE_SIZE
+        || stats->overflow_cnt != 3
+        || stats->high_water != RTE_APP_TASK_QUEUE_SIZE)
+    {
+        printf("Full queue: queued %u, overflow %u, high-water %u.\n",
+                stats->queued_cnt, stats->overflow_cnt, stats->high_water);
+        return 1;
+    }
+
+    Bench_Consumer();
+    for (uint32_t seq = 0; seq < RTE_APP_TASK_QUEUE_SIZE + 3; ++seq)
+    {
+        if (bench_run_cnt[0][seq] != 1)
+        {
+            printf("Full queue: callback %u ran %u times.\n", seq,
+                    bench_run_cnt[0][seq]);
+            return 1;
+        }
+    }
+    if (bench_order_errors != 0)
+    {
+        printf("Full queue: callbacks out of order.\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    const struct BDK_TaskQueueStats* stats = BDK_TaskGetQueueStats();
+    pthread_t thread[BENCH_PRODUCERS];
+    struct timespec start, end;
+    uint32_t missing = 0;
+    uint32_t duplicate = 0;
+    double seconds;
+
+    BDK_TaskInit();
+    BDK_TaskStart();
+
+    bench_producers_done = BENCH_PRODUCERS;
+    if (Bench_FillTest() != 0)
+    {
+        return 1;
+    }
+
+    // Stress run starts from a clean state.
+    task_res.run_state = BDK_TASK_STATE_RESET;
+    BDK_TaskInit();
+    BDK_TaskStart();
+    memset(bench_run_cnt, 0, sizeof(bench_run_cnt));
+    memset(bench_next_seq, 0, sizeof(bench_next_seq));
+    bench_queue_run_cnt = 0;
+    bench_msg_run_cnt = 0;
+    bench_producers_done = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uintptr_t i = 0; i < BENCH_PRODUCERS; ++i)
+    {
+        pthread_create(&thread[i], NULL, Bench_Producer, (void*)i);
+    }
+    Bench_Consumer();
+    for (int i = 0; i < BENCH_PRODUCERS; ++i)
+    {
+        pthread_join(thread[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds = (end.tv_sec - start.tv_sec)
+            + (end.tv_nsec - start.tv_nsec) * 1e-9;
+
+    for (int i = 0; i < BENCH_PRODUCERS; ++i)
+    {
+        for (uint32_t seq = 0; seq < BENCH_CALLBACKS; ++seq)
+        {
+            missing += (bench_run_cnt[i][seq] == 0);
+            duplicate += (bench_run_cnt[i][seq] > 1);
+        }
+    }
+
+    printf("callbacks: %u (queue %u, kernel %u)\n",
+            BENCH_PRODUCERS * BENCH_CALLBACKS, bench_queue_run_cnt,
+            bench_msg_run_cnt);
+    printf("stats: queued %u, overflow %u, high-water %u of %u\n",
+            stats->queued_cnt, stats->overflow_cnt, stats->high_water,
+            RTE_APP_TASK_QUEUE_SIZE);
+    printf("rate: %10.0f callbacks/s\n",
+            BENCH_PRODUCERS * BENCH_CALLBACKS / seconds);
+
+    if (missing != 0 || duplicate != 0 || bench_order_errors != 0
+        || stats->queued_cnt != bench_queue_run_cnt
+        || stats->overflow_cnt != bench_msg_run_cnt
+        || stats->high_water > RTE_APP_TASK_QUEUE_SIZE
+        || (stats->overflow_cnt != 0
+            && stats->high_water != RTE_APP_TASK_QUEUE_SIZE))
+    {
+        printf("FAILED: missing %u, duplicate %u, out of order %u\n", missing,
+                duplicate, bench_order_errors);
+        return 1;
+    }
+
+    return 0;
+}